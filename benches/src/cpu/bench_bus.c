@@ -0,0 +1,154 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+// Sweeps word reads and writes over every region of the memory map and
+// reports millions of accesses per second for each one. MMIO and expansion
+// regions are backed by a device that does nothing. Accesses go through the
+// inlined helpers used by the CPU core.
+//
+// Usage: bench_bus [rounds]
+
+#include "cpu/bus_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/error_codes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum {
+	_SWEEP_SIZE = 64 * 1024, // Bytes covered per round
+	_DEFAULT_ROUNDS = 200,
+};
+
+// Keeps the access loops from being optimized out
+static volatile u64 _sink;
+
+typedef struct RBT_Region {
+	const char *name;
+	u32 addr;
+	u32 size; // Sweeps wrap around inside the region
+	bool writable;
+} RBT_Region;
+
+static u64 _now_ns(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ((u64)ts.tv_sec * 1'000'000'000u) + (u64)ts.tv_nsec;
+}
+
+static RBT_ErrorCode _null_read_word(void *device, u32 addr, u16 *word) {
+	(void)device;
+	*word = addr & 0xffff;
+	return RBT_ERR_SUCCESS;
+}
+
+static RBT_ErrorCode _null_write_word(void *device, u32 addr, u16 word) {
+	(void)device;
+	(void)addr;
+	(void)word;
+	return RBT_ERR_SUCCESS;
+}
+
+static f64 _mega_per_sec(u64 accesses, u64 ns) {
+	return ns ? ((f64)accesses * 1'000.0) / (f64)ns : 0.0;
+}
+
+static void _bench_region(RBT_MemoryBus *bus, const RBT_Region *region, u32 rounds) {
+	u64 checksum = 0;
+	u64 accesses = (u64)rounds * (_SWEEP_SIZE / 2);
+
+	u64 start = _now_ns();
+	for (u32 r = 0; r < rounds; r += 1) {
+		for (u32 i = 0; i < _SWEEP_SIZE; i += 2) {
+			u16 word = 0;
+			checksum += _bus_read_word(bus, region->addr + (i % region->size), &word);
+			checksum += word;
+		}
+	}
+	u64 read_ns = _now_ns() - start;
+
+	printf("  %-8s read  %8.1f M/s", region->name, _mega_per_sec(accesses, read_ns));
+
+	if (region->writable) {
+		start = _now_ns();
+		for (u32 r = 0; r < rounds; r += 1) {
+			for (u32 i = 0; i < _SWEEP_SIZE; i += 2) {
+				u32 addr = region->addr + (i % region->size);
+				checksum += _bus_write_word(bus, addr, i & 0xffff);
+			}
+		}
+		u64 write_ns = _now_ns() - start;
+
+		printf("   write %8.1f M/s", _mega_per_sec(accesses, write_ns));
+	}
+
+	printf("\n");
+	_sink += checksum;
+}
+
+int main(int argc, char **argv) {
+	u32 rounds = (argc > 1) ? (u32)strtoul(argv[1], nullptr, 10) : _DEFAULT_ROUNDS;
+	if (rounds == 0)
+		rounds = 1;
+
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_1MB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	RBT_MemoryBus *bus = rbt_create_bus(&cfg);
+	if (!bus) {
+		rbt_err_flush();
+		return 1;
+	}
+
+	// /BERR accesses would otherwise measure the error stack
+	rbt_set_err_min_severity(RBT_SEVERITY_FATAL);
+
+	RBT_IODevice vdp = {
+		.addr = _BUS_MMIO_VDP_ADDR,
+		.size = _BUS_MMIO_SIZE,
+		.read_word = _null_read_word,
+		.write_word = _null_write_word,
+	};
+	RBT_IODevice ext = {
+		.addr = _BUS_EXT0_ADDR,
+		.size = _BUS_EXT_SIZE,
+		.read_word = _null_read_word,
+		.write_word = _null_write_word,
+	};
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_VDP, &vdp);
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_EXT0, &ext);
+
+	const RBT_Region regions[] = {
+		{ "ram", _BUS_RAM_ADDR + 0x1'0000, _SWEEP_SIZE, true },
+		{ "ram-mir", 0x30'0000, _SWEEP_SIZE, true }, // Unpopulated slot 3
+		{ "rom", _BUS_ROM_ADDR, _SWEEP_SIZE, false },
+		{ "mmio", _BUS_MMIO_VDP_ADDR, _BUS_MMIO_SIZE, true },
+		{ "ext", _BUS_EXT0_ADDR, _BUS_EXT_SIZE, true },
+		{ "dtack", _BUS_RESERVED_DTACK_ADDR, _SWEEP_SIZE, true },
+		{ "berr", _BUS_RESERVED_BERR_ADDR, _SWEEP_SIZE, true },
+	};
+
+	printf("bus: %u word accesses x %u rounds per region\n", _SWEEP_SIZE / 2, rounds);
+	for (usize i = 0; i < sizeof(regions) / sizeof(regions[0]); i += 1) {
+		_bench_region(bus, &regions[i], rounds);
+	}
+
+	rbt_destroy_bus(bus);
+	return 0;
+}
@@ -0,0 +1,146 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+// Decodes all 65536 opcode words with the table driven decoder and with the
+// reference decoder, checks both agree and reports the time per decode.
+//
+// Usage: bench_decode [rounds]
+
+#include "cpu/decode.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+	_OPCODE_COUNT = 0x1'0000,
+	_SLOT_SIZE = 16, // Opcode + extension words, fits any 68000 instruction
+	_DEFAULT_ROUNDS = 20,
+};
+
+typedef RBT_ErrorCode (*RBT_DecodeFn)(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr);
+
+static u64 _now_ns(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ((u64)ts.tv_sec * 1'000'000'000u) + (u64)ts.tv_nsec;
+}
+
+// Every opcode gets its own slot in RAM followed by the same extension words
+static bool _load_opcodes(RBT_MemoryBus *bus) {
+	static const u16 ext[] = { 0x0004, 0x1234, 0x0010, 0x8002, 0x00fe, 0x7ffc, 0x0000 };
+
+	for (u32 opcode = 0; opcode < _OPCODE_COUNT; opcode += 1) {
+		u32 addr = opcode * _SLOT_SIZE;
+		if (rbt_bus_write_word(bus, addr, opcode))
+			return false;
+
+		for (u32 i = 0; i < sizeof(ext) / sizeof(ext[0]); i += 1) {
+			if (rbt_bus_write_word(bus, addr + 2 + (i * 2), ext[i]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static u64 _run(RBT_MemoryBus *bus, RBT_DecodeFn decode, u32 rounds, u64 *checksum) {
+	RBT_Instruction instr;
+
+	u64 start = _now_ns();
+	for (u32 r = 0; r < rounds; r += 1) {
+		for (u32 opcode = 0; opcode < _OPCODE_COUNT; opcode += 1) {
+			RBT_ErrorCode err = decode(bus, opcode * _SLOT_SIZE, &instr);
+			*checksum += err ? err : instr.len;
+		}
+	}
+	return _now_ns() - start;
+}
+
+static u32 _count_mismatches(RBT_MemoryBus *bus) {
+	u32 mismatches = 0;
+
+	for (u32 opcode = 0; opcode < _OPCODE_COUNT; opcode += 1) {
+		RBT_Instruction expected, actual;
+		u32 pc = opcode * _SLOT_SIZE;
+		RBT_ErrorCode ref = _decode_instruction_reference(bus, pc, &expected);
+		RBT_ErrorCode err = _decode_instruction(bus, pc, &actual);
+
+		bool same = ref == err;
+		if (same && ref == RBT_ERR_SUCCESS)
+			same = memcmp(&expected, &actual, sizeof(RBT_Instruction)) == 0;
+
+		if (!same) {
+			if (mismatches < 16)
+				printf("  mismatch at opcode 0x%04x\n", opcode);
+			mismatches += 1;
+		}
+	}
+
+	return mismatches;
+}
+
+int main(int argc, char **argv) {
+	u32 rounds = (argc > 1) ? (u32)strtoul(argv[1], nullptr, 10) : _DEFAULT_ROUNDS;
+	if (rounds == 0)
+		rounds = 1;
+
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_1MB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	RBT_MemoryBus *bus = rbt_create_bus(&cfg);
+	if (!bus) {
+		rbt_err_flush();
+		return 1;
+	}
+
+	// Illegal encodings would otherwise measure the error stack
+	rbt_set_err_min_severity(RBT_SEVERITY_FATAL);
+
+	if (!_load_opcodes(bus)) {
+		fprintf(stderr, "failed to load opcodes\n");
+		rbt_destroy_bus(bus);
+		return 1;
+	}
+
+	u32 mismatches = _count_mismatches(bus);
+
+	u64 ref_checksum = 0;
+	u64 table_checksum = 0;
+	u64 ref_ns = _run(bus, _decode_instruction_reference, rounds, &ref_checksum);
+	u64 table_ns = _run(bus, _decode_instruction, rounds, &table_checksum);
+
+	f64 decodes = (f64)rounds * _OPCODE_COUNT;
+	f64 ref_per_op = (f64)ref_ns / decodes;
+	f64 table_per_op = (f64)table_ns / decodes;
+
+	printf("decode: %u opcodes x %u rounds\n", _OPCODE_COUNT, rounds);
+	printf("  reference: %8.2f ns/decode\n", ref_per_op);
+	printf(
+		"  table:     %8.2f ns/decode (%.2fx)\n", table_per_op,
+		table_per_op > 0.0 ? ref_per_op / table_per_op : 0.0
+	);
+	printf("  mismatches: %u\n", mismatches);
+
+	rbt_destroy_bus(bus);
+	return (mismatches == 0 && ref_checksum == table_checksum) ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+// Runs blocks of register-only instructions through rbt_cpu_run() over and
+// over and reports the time per executed instruction. The blocks fit in the
+// decode cache, so this mostly measures the execution loop itself. The ALU
+// block only has instructions that update the condition codes. Each block is
+// run once instruction by instruction and once as recorded basic blocks.
+//
+// Usage: bench_run [rounds]
+
+#include "cpu/cpu_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum {
+	_CODE_ADDR = 0x1000,
+	_BLOCK_WORDS = 960,
+	_DEFAULT_ROUNDS = 20'000,
+};
+
+// clang-format off
+static const u16 _mixed[] = {
+	0x7001, // MOVEQ   #1, D0
+	0x7203, // MOVEQ   #3, D1
+	0xd280, // ADD.l   D0, D1
+	0x2401, // MOVE.l  D1, D2
+	0x4842, // SWAP    D2
+	0xc141, // EXG     D0, D1
+	0x5284, // ADDQ.l  #1, D4
+	0x4883, // EXT.w   D3
+	0xd380, // ADDX.l  D0, D1
+	0x4485, // NEG.l   D5
+	0xc2c0, // MULU.w  D0, D1
+	0x4e71, // NOP
+};
+
+static const u16 _alu[] = {
+	0xd280, // ADD.l   D0, D1
+	0x5282, // ADDQ.l  #1, D2
+	0x4483, // NEG.l   D3
+	0x2801, // MOVE.l  D1, D4
+	0xd441, // ADD.w   D1, D2
+	0x4845, // SWAP    D5
+	0x5e06, // ADDQ.b  #7, D6
+	0x48c4, // EXT.l   D4
+	0x0683, 0x0000, 0x0101, // ADDI.l  #$101, D3
+	0x4487, // NEG.l   D7
+	0x7e05, // MOVEQ   #5, D7
+};
+// clang-format on
+
+typedef struct RBT_Block {
+	const char *name;
+	const u16 *words;
+	usize word_count;
+} RBT_Block;
+
+static u64 _now_ns(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ((u64)ts.tv_sec * 1'000'000'000u) + (u64)ts.tv_nsec;
+}
+
+// Writes `block` repeatedly at _CODE_ADDR until it's _BLOCK_WORDS long
+static void _load_block(RBT_MemoryBus *bus, const RBT_Block *block) {
+	for (u32 i = 0; i < _BLOCK_WORDS; i += 1) {
+		u16 word = block->words[i % block->word_count];
+		(void)rbt_bus_write_word(bus, _CODE_ADDR + (i * 2), word);
+	}
+}
+
+static bool _bench_block(
+	RBT_Cpu *cpu, RBT_MemoryBus *bus, const RBT_Block *block, u32 rounds
+) {
+	_load_block(bus, block);
+
+	// Warm the decode cache up and learn how many cycles the block takes
+	u32 block_cycles = 0;
+	u64 block_instrs = 0;
+	cpu->state.pc = _CODE_ADDR;
+	while (cpu->state.pc < _CODE_ADDR + (_BLOCK_WORDS * 2)) {
+		u16 cycles = 0;
+		if (rbt_cpu_step(cpu, &cycles)) {
+			rbt_err_flush();
+			fprintf(stderr, "%s: failed at pc 0x%06x\n", block->name, cpu->state.pc);
+			return false;
+		}
+		block_cycles += cycles;
+		block_instrs += 1;
+	}
+
+	u64 instrs = 0;
+	u64 start = _now_ns();
+	for (u32 r = 0; r < rounds; r += 1) {
+		cpu->state.pc = _CODE_ADDR;
+
+		u32 used = 0;
+		if (rbt_cpu_run(cpu, block_cycles, &used) || used != block_cycles) {
+			rbt_err_flush();
+			fprintf(
+				stderr, "%s: run stopped early at pc 0x%06x\n", block->name, cpu->state.pc
+			);
+			return false;
+		}
+		instrs += block_instrs;
+	}
+	u64 elapsed = _now_ns() - start;
+
+	f64 per_instr = (f64)elapsed / (f64)instrs;
+	printf(
+		"  %-6s %-6s %8.2f ns/instruction (%.1f MIPS)\n", block->name,
+		cpu->cfg.translate_blocks ? "blocks" : "steps", per_instr, 1'000.0 / per_instr
+	);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	u32 rounds = (argc > 1) ? (u32)strtoul(argv[1], nullptr, 10) : _DEFAULT_ROUNDS;
+	if (rounds == 0)
+		rounds = 1;
+
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	RBT_MemoryBus *bus = rbt_create_bus(&cfg);
+	RBT_Cpu *cpu = rbt_create_cpu(nullptr);
+	if (!bus || !cpu) {
+		rbt_err_flush();
+		rbt_destroy_cpu(cpu);
+		rbt_destroy_bus(bus);
+		return 1;
+	}
+	rbt_cpu_attach_bus(cpu, bus);
+
+	cpu->state.sr = RBT_SR_SUPERVISOR;
+	cpu->state.ssp = 0x8000;
+	cpu->state.gpr.sp = cpu->state.ssp;
+
+	const RBT_Block blocks[] = {
+		{ "mixed", _mixed, sizeof(_mixed) / sizeof(_mixed[0]) },
+		{ "alu", _alu, sizeof(_alu) / sizeof(_alu[0]) },
+	};
+
+	printf("run: %u words x %u rounds\n", _BLOCK_WORDS, rounds);
+
+	bool ok = true;
+	for (usize i = 0; ok && i < sizeof(blocks) / sizeof(blocks[0]); i += 1) {
+		cpu->cfg.translate_blocks = false;
+		ok = _bench_block(cpu, bus, &blocks[i], rounds);
+		cpu->cfg.translate_blocks = true;
+		ok = ok && _bench_block(cpu, bus, &blocks[i], rounds);
+	}
+
+	rbt_destroy_cpu(cpu);
+	rbt_destroy_bus(bus);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+// Single-steps a NOP/MOVEQ/ADD loop through rbt_cpu_step() and reports the
+// instructions per second. The plain run is served from the decode cache; the
+// hooked run installs an empty debug hook, which decodes every instruction
+// again before it executes.
+//
+// Usage: bench_step [steps]
+
+#include "cpu/cpu_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum {
+	_CODE_ADDR = 0x1000,
+	_DEFAULT_STEPS = 50'000'000,
+};
+
+// clang-format off
+static const u16 _loop[] = {
+	0x4e71, // NOP
+	0x7001, // MOVEQ   #1, D0
+	0xd280, // ADD.l   D0, D1
+	0x60f8, // BRA.s   _CODE_ADDR
+};
+// clang-format on
+
+static u64 _now_ns(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ((u64)ts.tv_sec * 1'000'000'000u) + (u64)ts.tv_nsec;
+}
+
+static RBT_ErrorCode _empty_hook(void *userdata, const RBT_Instruction *instr) {
+	(void)userdata;
+	(void)instr;
+	return RBT_ERR_SUCCESS;
+}
+
+static bool _bench_steps(RBT_Cpu *cpu, const char *name, u64 steps) {
+	cpu->state.pc = _CODE_ADDR;
+
+	u64 cycles = 0;
+	u64 start = _now_ns();
+	for (u64 i = 0; i < steps; i += 1) {
+		u16 step_cycles = 0;
+		if (rbt_cpu_step(cpu, &step_cycles)) {
+			rbt_err_flush();
+			fprintf(stderr, "%s: failed at pc 0x%06x\n", name, cpu->state.pc);
+			return false;
+		}
+		cycles += step_cycles;
+	}
+	u64 elapsed = _now_ns() - start;
+
+	f64 seconds = (f64)elapsed / 1e9;
+	printf(
+		"  %-6s %8.2f ns/step, %.2fM instructions/s (%.2f cycles/step)\n", name,
+		(f64)elapsed / (f64)steps, (f64)steps / seconds / 1e6,
+		(f64)cycles / (f64)steps
+	);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	u64 steps = (argc > 1) ? strtoull(argv[1], nullptr, 10) : _DEFAULT_STEPS;
+	if (steps == 0)
+		steps = 1;
+
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	RBT_MemoryBus *bus = rbt_create_bus(&cfg);
+	RBT_Cpu *cpu = rbt_create_cpu(nullptr);
+	if (!bus || !cpu) {
+		rbt_err_flush();
+		rbt_destroy_cpu(cpu);
+		rbt_destroy_bus(bus);
+		return 1;
+	}
+	rbt_cpu_attach_bus(cpu, bus);
+
+	cpu->state.sr = RBT_SR_SUPERVISOR;
+	cpu->state.ssp = 0x8000;
+	cpu->state.gpr.sp = cpu->state.ssp;
+
+	for (u32 i = 0; i < sizeof(_loop) / sizeof(_loop[0]); i += 1) {
+		(void)rbt_bus_write_word(bus, _CODE_ADDR + (i * 2), _loop[i]);
+	}
+
+	printf("step: %llu steps\n", (unsigned long long)steps);
+
+	bool ok = _bench_steps(cpu, "plain", steps);
+	if (ok) {
+		cpu->cfg.hook = _empty_hook;
+		ok = _bench_steps(cpu, "hooked", steps / 10);
+	}
+
+	rbt_destroy_cpu(cpu);
+	rbt_destroy_bus(bus);
+	return ok ? 0 : 1;
+}
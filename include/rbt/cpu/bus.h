@@ -66,6 +66,7 @@ typedef struct RBT_MemoryBus RBT_MemoryBus;
 
 [[nodiscard]] RBT_MemoryBus *rbt_create_bus(const RBT_BusConfig *cfg);
 void rbt_destroy_bus(RBT_MemoryBus *bus);
+// Clears RAM. Only the pages written since the last reset are touched.
 void rbt_bus_reset(RBT_MemoryBus *bus);
 
 void rbt_bus_attach_iodevice(
@@ -73,6 +74,14 @@ void rbt_bus_attach_iodevice(
 );
 RBT_ErrorCode rbt_bus_init(RBT_MemoryBus *bus, usize size, const u8 *rom);
 RBT_ErrorCode rbt_bus_init_from_file(RBT_MemoryBus *bus, const char *filename);
+// Maps the ROM file read-only instead of copying it. Buses loading the same file
+// share one mapping. Falls back to rbt_bus_init_from_file() where files can't be
+// mapped.
+// The mapping isn't a snapshot: the file must not change while a bus uses it.
+// Rewriting it in place changes the ROM under the running code, truncating it
+// raises SIGBUS on the next read past its new end. Replace the file instead, or
+// use rbt_bus_init_from_file().
+RBT_ErrorCode rbt_bus_map_rom_file(RBT_MemoryBus *bus, const char *filename);
 
 RBT_ErrorCode rbt_bus_read_byte(RBT_MemoryBus *bus, u32 addr, u8 *out);
 RBT_ErrorCode rbt_bus_read_word(RBT_MemoryBus *bus, u32 addr, u16 *out);
@@ -84,3 +93,17 @@ RBT_ErrorCode rbt_bus_write_long(RBT_MemoryBus *bus, u32 addr, u32 long_);
 
 RBT_ErrorCode rbt_bus_load(RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 *out);
 RBT_ErrorCode rbt_bus_store(RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 data);
+
+// Block transfers: RAM/ROM is copied directly, devices get one access per aligned
+// word and bytes at odd edges. Addresses wrap around the 24-bit space and /DTACK
+// regions read as zero. They stop at the first failing access and return its
+// error, `transferred` (may be null) receives the bytes moved until then.
+RBT_ErrorCode rbt_bus_read_block(
+	RBT_MemoryBus *bus, u32 addr, u8 *out, usize size, usize *transferred
+);
+RBT_ErrorCode rbt_bus_write_block(
+	RBT_MemoryBus *bus, u32 addr, const u8 *data, usize size, usize *transferred
+);
+RBT_ErrorCode rbt_bus_fill(
+	RBT_MemoryBus *bus, u32 addr, u8 value, usize size, usize *transferred
+);
@@ -19,6 +19,8 @@
 
 #include "rbt/basic_types.h"
 #include "rbt/cpu/bus.h"
+#include "rbt/cpu/irq.h"
+#include "rbt/cpu/scheduler.h"
 #include "rbt/cpu/types.h"
 #include "rbt/error_codes.h"
 
@@ -27,16 +29,63 @@ typedef RBT_ErrorCode (*RBT_CpuDebugHook)(void *userdata, const RBT_Instruction
 typedef struct RBT_CpuConfig {
 	RBT_CpuModel model;
 
+	// Skip ahead when the guest spins in a short backward loop that only reads
+	// and tests (e.g. polling a status register), as if it had run until the
+	// end of the budget. Devices see fewer reads; off by default.
+	bool skip_idle_loops;
+
+	// rbt_cpu_run() records straight-line code into basic blocks the first time
+	// it runs, and replays them, chained to the blocks that follow, without
+	// looking each instruction up. Traced or hooked code still runs one
+	// instruction at a time; off by default.
+	bool translate_blocks;
+
 	RBT_CpuDebugHook hook;
 	void *userdata;
 } RBT_CpuConfig;
 
+typedef struct RBT_CpuCacheStats {
+	u64 hits;	// Instructions served from the decode cache
+	u64 misses; // Instructions that had to be decoded
+} RBT_CpuCacheStats;
+
 typedef struct RBT_Cpu RBT_Cpu;
 
 [[nodiscard]] RBT_Cpu *rbt_create_cpu(const RBT_CpuConfig *config);
 void rbt_destroy_cpu(RBT_Cpu *cpu);
 
 void rbt_cpu_attach_bus(RBT_Cpu *cpu, RBT_MemoryBus *bus);
+// The controller drives its own copy of the IPL lines, ORed with the ones set
+// through rbt_cpu_set_irq_line(). Pass null to detach it.
+void rbt_cpu_attach_irq_controller(RBT_Cpu *cpu, RBT_IrqController *irq);
+
+// Asserts or releases IPL `level` (1-7); the interrupt is autovectored. Unlike
+// every other function here it's lock-free and may be called from any thread
+// while the CPU runs, e.g. by an input thread.
+void rbt_cpu_set_irq_line(RBT_Cpu *cpu, u8 level, bool asserted);
 
 RBT_ErrorCode rbt_cpu_reset(RBT_Cpu *cpu);
+// Returns RBT_ERR_CPU_STOPPED without doing anything while the CPU waits for an
+// interrupt after STOP.
 RBT_ErrorCode rbt_cpu_step(RBT_Cpu *cpu, u16 *out_cycles);
+// Executes instructions until `cycle_budget` is spent. Returns early when an
+// interrupt becomes pending, when the CPU halts or when the debug hook (or an
+// instruction) fails; `out_cycles` always receives the cycles actually used.
+// A stopped or idle CPU (see `skip_idle_loops`) uses the rest of the budget at
+// once.
+RBT_ErrorCode rbt_cpu_run(RBT_Cpu *cpu, u32 cycle_budget, u32 *out_cycles);
+// Executes instructions up to the next scheduled event, moves the scheduler's
+// clock forward by the cycles used and fires whatever became due. Stops early
+// for the same reasons as rbt_cpu_run(). A stopped CPU goes straight to the next
+// event.
+RBT_ErrorCode rbt_cpu_run_until_event(
+	RBT_Cpu *cpu, RBT_Scheduler *sched, u32 *out_cycles
+);
+
+void rbt_cpu_flush_cache(RBT_Cpu *cpu);
+// Decodes the basic blocks starting at `pcs` ahead of their first run, e.g. from
+// the table rbt-rom-blocks writes for a ROM image. Blocks sharing a slot replace
+// each other, the later one stays. Only rbt_cpu_run() with `translate_blocks`
+// uses them.
+RBT_ErrorCode rbt_cpu_preload_blocks(RBT_Cpu *cpu, const u32 *pcs, usize count);
+void rbt_cpu_query_cache_stats(const RBT_Cpu *cpu, RBT_CpuCacheStats *out);
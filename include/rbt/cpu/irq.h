@@ -0,0 +1,74 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "rbt/basic_types.h"
+
+// Sources wired to the interrupt controller. Sources sharing a level are
+// acknowledged in this order.
+typedef enum RBT_IrqSource {
+	RBT_IRQ_VDP_HBLANK,
+	RBT_IRQ_VDP_LINE,
+	RBT_IRQ_VDP_VBLANK,
+	RBT_IRQ_VDP_BLITTER,
+	RBT_IRQ_IO_SNES,
+	RBT_IRQ_IO_PS2,
+	RBT_IRQ_EXT0,
+	RBT_IRQ_EXT1,
+	RBT_IRQ_EXT2,
+	RBT_IRQ_EXT3,
+	RBT_IRQ_SOURCE_COUNT,
+} RBT_IrqSource;
+
+enum {
+	RBT_IRQ_LEVEL_NONE = 0, // Source is disconnected
+	RBT_IRQ_LEVEL_NMI = 7,	// Non-maskable, taken on the rising edge only
+
+	RBT_IRQ_AUTOVECTOR = 0x100, // Acknowledge with the level's autovector
+};
+
+// Called when the CPU acknowledges an interrupt raised by `source`. Returns
+// the vector number to use (0-255) or RBT_IRQ_AUTOVECTOR.
+typedef u16 (*RBT_IrqAckCallback)(void *userdata, RBT_IrqSource source);
+
+// Default levels:
+//   6: VDP H-Blank, VDP line compare
+//   5: VDP V-Blank
+//   4: VDP blitter
+//   3: SNES controllers, PS/2
+//   2: Expansion cards
+typedef struct RBT_IrqController RBT_IrqController;
+
+[[nodiscard]] RBT_IrqController *rbt_create_irq_controller(void);
+void rbt_destroy_irq_controller(RBT_IrqController *irq);
+
+// Moves `source` to another IPL level, RBT_IRQ_LEVEL_NONE disconnects it
+void rbt_irq_set_level(RBT_IrqController *irq, RBT_IrqSource source, u8 level);
+[[nodiscard]] u8 rbt_irq_level(const RBT_IrqController *irq, RBT_IrqSource source);
+
+// Without a callback the source is acknowledged with an autovector
+void rbt_irq_set_ack_callback(
+	RBT_IrqController *irq, RBT_IrqSource source, RBT_IrqAckCallback callback,
+	void *userdata
+);
+
+// Sources are level-triggered: they stay asserted until lowered, usually
+// once the guest clears the device's status flag.
+void rbt_irq_raise(RBT_IrqController *irq, RBT_IrqSource source);
+void rbt_irq_lower(RBT_IrqController *irq, RBT_IrqSource source);
+[[nodiscard]] bool rbt_irq_is_raised(const RBT_IrqController *irq, RBT_IrqSource source);
@@ -0,0 +1,55 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/irq.h"
+#include "rbt/cpu/scheduler.h"
+
+// Returns `size` bytes aligned to `alignment` (a power of two), or null
+typedef void *(*RBT_AllocCallback)(void *userdata, usize size, usize alignment);
+typedef void (*RBT_FreeCallback)(void *userdata, void *block, usize size);
+
+typedef struct RBT_Allocator {
+	RBT_AllocCallback alloc;
+	RBT_FreeCallback free;
+	void *userdata;
+} RBT_Allocator;
+
+typedef struct RBT_MachineConfig {
+	RBT_CpuConfig cpu;
+	RBT_BusConfig bus;
+
+	const RBT_Allocator *allocator; // Null uses the C library
+	bool huge_pages;				// Ask the OS to back the block with huge pages
+} RBT_MachineConfig;
+
+// CPU, bus, RAM, ROM, interrupt controller and scheduler carved out of a single
+// block, every part on its own cache line. The CPU comes wired to the bus and
+// the controller. Parts belong to the machine: never destroy them one by one.
+typedef struct RBT_Machine RBT_Machine;
+
+[[nodiscard]] RBT_Machine *rbt_create_machine(const RBT_MachineConfig *cfg);
+void rbt_destroy_machine(RBT_Machine *machine);
+
+[[nodiscard]] RBT_Cpu *rbt_machine_cpu(RBT_Machine *machine);
+[[nodiscard]] RBT_MemoryBus *rbt_machine_bus(RBT_Machine *machine);
+[[nodiscard]] RBT_IrqController *rbt_machine_irq(RBT_Machine *machine);
+[[nodiscard]] RBT_Scheduler *rbt_machine_scheduler(RBT_Machine *machine);
@@ -0,0 +1,55 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+#pragma once
+
+#include "rbt/basic_types.h"
+#include "rbt/error_codes.h"
+
+// Called once the master clock reaches `cycle`, the cycle the event was
+// scheduled for. It may schedule or cancel events, including itself.
+typedef RBT_ErrorCode (*RBT_EventCallback)(void *userdata, u64 cycle);
+
+typedef u32 RBT_EventId;
+
+enum {
+	RBT_EVENT_NONE = 0, // Never returned for a scheduled event
+};
+
+typedef struct RBT_Scheduler RBT_Scheduler;
+
+[[nodiscard]] RBT_Scheduler *rbt_create_scheduler(void);
+void rbt_destroy_scheduler(RBT_Scheduler *sched);
+
+// Master clock cycles elapsed since the scheduler was created
+[[nodiscard]] u64 rbt_sched_now(const RBT_Scheduler *sched);
+// Cycles left until the earliest event is due, 0 if one is already due and
+// UINT64_MAX when nothing is scheduled
+[[nodiscard]] u64 rbt_sched_until_next(const RBT_Scheduler *sched);
+
+// Events due on the same cycle fire in the order they were scheduled. Returns
+// RBT_EVENT_NONE when the event can't be stored.
+RBT_EventId rbt_sched_at(
+	RBT_Scheduler *sched, u64 cycle, RBT_EventCallback callback, void *userdata
+);
+RBT_EventId rbt_sched_in(
+	RBT_Scheduler *sched, u64 delay, RBT_EventCallback callback, void *userdata
+);
+bool rbt_sched_cancel(RBT_Scheduler *sched, RBT_EventId id);
+
+// Moves the master clock forward and fires every event that became due. Stops
+// at the first callback that fails, later events stay scheduled.
+RBT_ErrorCode rbt_sched_advance(RBT_Scheduler *sched, u64 cycles);
@@ -177,6 +177,30 @@ typedef struct RBT_Instruction {
 
 // F E D C B A  9  8  7 6 5 4 3 2 1 0
 // T 0 S M 0 I2 I1 I0 0 0 0 X N Z V C
+typedef enum RBT_StatusFlag {
+	RBT_SR_CARRY = 1 << 0,
+	RBT_SR_OVERFLOW = 1 << 1,
+	RBT_SR_ZERO = 1 << 2,
+	RBT_SR_NEGATIVE = 1 << 3,
+	RBT_SR_EXTEND = 1 << 4,
+	RBT_SR_INTERRUPT = 0b111 << 8, // Interrupt priority mask
+	// RBT_SR_MASTER = 1 << 12, // M68020+
+	RBT_SR_SUPERVISOR = 1 << 13,
+	// RBT_SR_TRACE0 = 1 << 14, // M68020+
+	RBT_SR_TRACE1 = 1 << 15,
+
+	RBT_SR_CCR = RBT_SR_CARRY | RBT_SR_OVERFLOW | RBT_SR_ZERO | RBT_SR_NEGATIVE
+			   | RBT_SR_EXTEND,
+	RBT_SR_IMPLEMENTED = RBT_SR_CCR | RBT_SR_INTERRUPT | RBT_SR_SUPERVISOR
+					   | RBT_SR_TRACE1,
+} RBT_StatusFlag;
+
+enum {
+	RBT_SR_INTERRUPT_SHIFT = 8,
+};
+
+// Unpacked view of the status register, for code that predates the packed form.
+// Use rbt_sr_view() and rbt_sr_pack() to convert.
 typedef struct RBT_StatusRegister {
 	bool carry;
 	bool overflow;
@@ -190,6 +214,31 @@ typedef struct RBT_StatusRegister {
 	bool trace1;
 } RBT_StatusRegister;
 
+[[nodiscard]] static inline RBT_StatusRegister rbt_sr_view(u16 sr) {
+	return (RBT_StatusRegister) {
+		.carry = sr & RBT_SR_CARRY,
+		.overflow = sr & RBT_SR_OVERFLOW,
+		.zero = sr & RBT_SR_ZERO,
+		.negative = sr & RBT_SR_NEGATIVE,
+		.extend = sr & RBT_SR_EXTEND,
+		.interrupt_priority = (sr & RBT_SR_INTERRUPT) >> RBT_SR_INTERRUPT_SHIFT,
+		.supervisor = sr & RBT_SR_SUPERVISOR,
+		.trace1 = sr & RBT_SR_TRACE1,
+	};
+}
+
+[[nodiscard]] static inline u16 rbt_sr_pack(const RBT_StatusRegister *view) {
+	u16 sr = (view->interrupt_priority << RBT_SR_INTERRUPT_SHIFT) & RBT_SR_INTERRUPT;
+	sr |= view->carry ? RBT_SR_CARRY : 0;
+	sr |= view->overflow ? RBT_SR_OVERFLOW : 0;
+	sr |= view->zero ? RBT_SR_ZERO : 0;
+	sr |= view->negative ? RBT_SR_NEGATIVE : 0;
+	sr |= view->extend ? RBT_SR_EXTEND : 0;
+	sr |= view->supervisor ? RBT_SR_SUPERVISOR : 0;
+	sr |= view->trace1 ? RBT_SR_TRACE1 : 0;
+	return sr;
+}
+
 typedef union RBT_GeneralRegisters {
 	u32 flat[16]; // D0-D7 + A0-A7
 
@@ -208,7 +257,7 @@ typedef struct RBT_CpuState {
 	u32 usp; // User Stack Pointer
 	u32 ssp; // System Stack Pointer
 
-	RBT_StatusRegister sr;
+	u16 sr; // Status Register, see RBT_StatusFlag
 	RBT_GeneralRegisters gpr;
 
 	// M68010+
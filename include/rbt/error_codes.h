@@ -39,6 +39,7 @@ typedef enum RBT_ErrorCode {
 
 	// CPU errors (0x20-0x3f)
 	RBT_ERR_CPU_HALTED = 0x20,
+	RBT_ERR_CPU_STOPPED = 0x21, // Waiting for an interrupt after STOP
 
 	// Memory errors (0x40-0x5f)
 	RBT_ERR_MEM_BUS_ERROR = 0x40,
@@ -20,15 +20,25 @@
 #include "rbt/basic_types.h"
 #include "rbt/cpu/types.h"
 
+// rbt_ctz_u32(), rbt_clz_u32() and rbt_ctz_u64() are undefined for 0
 #if defined(__GNUC__) || defined(__clang__)
 #	define rbt_bswap_u16(x) __builtin_bswap16((x))
 #	define rbt_bswap_u32(x) __builtin_bswap32((x))
 #	define rbt_bswap_u64(x) __builtin_bswap64((x))
+#	define rbt_ctz_u32(x)	((u32)__builtin_ctz((x)))
+#	define rbt_clz_u32(x)	((u32)__builtin_clz((x)))
+#	define rbt_ctz_u64(x)	((u32)__builtin_ctzll((x)))
+#	define rbt_popcount_u64(x) ((u32)__builtin_popcountll((x)))
 #elif defined(_MSC_VER)
+#	include <intrin.h>
 #	include <stdlib.h>
 #	define rbt_bswap_u16(x) _byteswap_ushort((x))
 #	define rbt_bswap_u32(x) _byteswap_ulong((x))
 #	define rbt_bswap_u64(x) _byteswap_uint64((x))
+#	define rbt_ctz_u32(x)	((u32)_tzcnt_u32((x)))
+#	define rbt_clz_u32(x)	((u32)_lzcnt_u32((x)))
+#	define rbt_ctz_u64(x)	((u32)_tzcnt_u64((x)))
+#	define rbt_popcount_u64(x) ((u32)__popcnt64((x)))
 #endif
 
 #define RBT_BIT(v, bit) (((v) >> (bit)) & 1u)
@@ -18,6 +18,7 @@
 #include "rbt/cpu/bus.h"
 
 #include "bus_internal.h"
+#include "cpu/rom_image.h"
 #include "error.h"
 #include "rbt/basic_types.h"
 #include "rbt/cpu/types.h"
@@ -28,6 +29,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#	include <sys/mman.h>
+#endif
+
+enum {
+	// Past this many dirty pages, handing RAM back to the kernel beats clearing
+	// the pages one by one
+	_BUS_RESET_RELEASE_PAGES = 64,
+};
+
 static const u32 _ram_module_sizes[] = {
 	[RBT_RAM_NONE] = 0,
 	[RBT_RAM_256KB] = 256 * 1024,
@@ -39,119 +50,251 @@ static inline bool _is_address_in_range(u32 addr, u32 start, u32 size) {
 	return addr >= start && addr < start + size;
 }
 
-static inline u32 _get_ram_index(RBT_RamDevice *ram, u32 addr) {
-	assert(ram->slot_size[0] != 0 && "Slot 0 must be populated");
+// Module sizes are powers of two, mirroring inside a slot is just a mask
+static inline u8 *_get_ram_host(const RBT_RamDevice *ram, u32 addr) {
+	u32 slot = (addr >> 20) & (_BUS_RAM_SLOTS_COUNT - 1);
+	return ram->slot_base[slot] + (addr & ram->slot_mask[slot]);
+}
 
-	u32 slot = addr >> 20;
-	u32 subaddr = addr & 0x0f'ffff;
+static inline const RBT_BusPage *_bus_page(const RBT_MemoryBus *bus, u32 addr) {
+	return &bus->pages[addr >> _BUS_PAGE_SHIFT];
+}
 
-	// If slot is unpopulated, mirror into slot 0
-	if (ram->slot_size[slot] == 0) {
-		slot = 0;
-		subaddr = addr % ram->slot_size[0];
+static inline RBT_IODevice *_query_iodevice_range(RBT_MemoryBus *bus, u32 addr, u32 *offset) {
+	assert(offset);
+
+	for (i32 i = 0; i < _RBT_BUSDEV_COUNT; i += 1) {
+		RBT_IODevice *dev = &bus->mmio_devices[i];
+		if (dev->size != 0 && _is_address_in_range(addr, dev->addr, dev->size)) {
+			*offset = addr - dev->addr;
+			return dev;
+		}
 	}
 
-	return ram->slot_offset[slot] + (subaddr % ram->slot_size[slot]);
+	return nullptr;
 }
 
-static inline RBT_ErrorCode _ram_read_byte(void *device, u32 addr, u8 *byte) {
-	RBT_RamDevice *ram = (RBT_RamDevice *)device;
-	if (!ram->data) {
-		return RBT_ERR_MEM_BUS_ERROR;
+// Fixed memory map, what a page holds when no device is attached over it
+static RBT_BusPage _bus_base_page(RBT_MemoryBus *bus, u32 addr) {
+	RBT_BusPage page = { .code_page = _BUS_CODE_PAGE_NONE };
+
+	if (addr < _BUS_RAM_ADDR + _BUS_RAM_SIZE) {
+		// RAM slots are multiples of the page size, so mirrors keep pages whole
+		u8 *host = _get_ram_host(&bus->ram, addr);
+		page.kind = _BUS_PAGE_MEMORY;
+		page.read = host;
+		page.write = host;
+		page.code_page = (u32)(host - bus->ram.data) >> _BUS_CODE_PAGE_SHIFT;
+	} else if (_is_address_in_range(addr, _BUS_ROM_ADDR, _BUS_ROM_SIZE * 2)) {
+		u32 offset = (addr - _BUS_ROM_ADDR) % _BUS_ROM_SIZE;
+		page.kind = _BUS_PAGE_MEMORY;
+		page.read = &bus->rom[offset];
+		page.code_page = _BUS_CODE_RAM_PAGES + (offset >> _BUS_CODE_PAGE_SHIFT);
+	} else if (addr >= _BUS_RESERVED_BERR_ADDR
+			   && addr < _BUS_RESERVED_BERR_ADDR + _BUS_RESERVED_BERR_SIZE) {
+		page.kind = _BUS_PAGE_BERR;
+	} else if (addr >= _BUS_RESERVED_DTACK_ADDR
+			   && addr < _BUS_RESERVED_DTACK_ADDR + _BUS_RESERVED_DTACK_SIZE) {
+		page.kind = _BUS_PAGE_DTACK;
+	} else if (addr >= _BUS_EXT0_ADDR) {
+		page.kind = _BUS_PAGE_BERR; // Empty expansion slot
+	}
+
+	return page;
+}
+
+// Rebuilds a page table entry from the memory map and the attached devices
+static void _bus_map_page(RBT_MemoryBus *bus, u32 index) {
+	bus->fetch.base = _BUS_FETCH_NONE; // Refilled by the next fetch
+
+	u32 start = index << _BUS_PAGE_SHIFT;
+	u32 end = start + _BUS_PAGE_MASK;
+
+	RBT_BusPage page = _bus_base_page(bus, start);
+	if (page.kind == _BUS_PAGE_MEMORY) {
+		bus->pages[index] = page; // RAM/ROM can't be overridden by devices
+		return;
 	}
 
-	// RAM region (Wrap around on unused ram slots)
-	*byte = ram->data[_get_ram_index(ram, addr)];
-	return RBT_ERR_SUCCESS;
-}
+	usize overlapping = 0;
+	for (i32 i = 0; i < _RBT_BUSDEV_COUNT; i += 1) {
+		RBT_IODevice *dev = &bus->mmio_devices[i];
+		if (dev->size == 0 || dev->addr > end || dev->addr + (dev->size - 1) < start)
+			continue;
 
-static inline RBT_ErrorCode _ram_write_byte(void *device, u32 addr, u8 byte) {
-	RBT_RamDevice *ram = (RBT_RamDevice *)device;
-	if (!ram->data) {
-		return RBT_ERR_MEM_BUS_ERROR;
+		overlapping += 1;
+		if (dev->addr <= start && dev->addr + (dev->size - 1) >= end)
+			page.kind = _BUS_PAGE_DEVICE;
+		if (!page.dev)
+			page.dev = dev;
 	}
 
-	// RAM region (Wrap around at unused ram slots)
-	ram->data[_get_ram_index(ram, addr)] = byte;
-	return RBT_ERR_SUCCESS;
+	// Shared pages keep their first device, it's checked before any scan
+	if (overlapping > 1 || (overlapping == 1 && page.kind != _BUS_PAGE_DEVICE))
+		page.kind = _BUS_PAGE_SHARED;
+
+	bus->pages[index] = page;
 }
 
-static inline RBT_ErrorCode _rom_read_byte(void *device, u32 addr, u8 *byte) {
-	u8 *rom = (u8 *)device;
+static void _bus_map_range(RBT_MemoryBus *bus, u32 addr, u32 size) {
+	if (size == 0)
+		return;
+
+	u32 first = (addr & 0xff'ffff) >> _BUS_PAGE_SHIFT;
+	u32 last = ((addr + (size - 1)) & 0xff'ffff) >> _BUS_PAGE_SHIFT;
+	if (last < first)
+		last = _BUS_PAGE_COUNT - 1; // Clamp ranges wrapping around the 24-bit space
 
-	// ROM region
-	u32 offset = (addr - _BUS_ROM_ADDR) % _BUS_ROM_SIZE;
-	*byte = rom[offset];
-	return RBT_ERR_SUCCESS;
+	for (u32 index = first; index <= last; index += 1) {
+		_bus_map_page(bus, index);
+	}
 }
 
-static inline RBT_ErrorCode _rom_read_word(void *device, u32 addr, u16 *word) {
-	u8 *rom = (u8 *)device;
+// Finds the device behind an address the page table can't serve from host
+// memory. Returns RBT_ERR_SUCCESS with a null `*out` on /DTACK regions. Word
+// accesses must be aligned, unless /DTACK or /BERR take precedence. Faults are
+// recorded in `bus->fault` for the CPU's exception frame.
+static inline RBT_ErrorCode _bus_find_device(
+	RBT_MemoryBus *bus, u32 addr, bool is_word, bool is_read, RBT_IODevice **out,
+	u32 *offset
+) {
+	const RBT_BusPage *page = _bus_page(bus, addr);
+	RBT_BusPageKind kind = page->kind;
+	*out = page->dev;
 
-	u32 offset = (addr - _BUS_ROM_ADDR) % _BUS_ROM_SIZE;
+	if (kind == _BUS_PAGE_SHARED) {
+		if (!_is_address_in_range(addr, page->dev->addr, page->dev->size))
+			*out = _query_iodevice_range(bus, addr, offset);
+		kind = *out ? _BUS_PAGE_DEVICE : _bus_base_page(bus, addr).kind;
+	}
 
-	u16 data = rom[offset] << 8;
-	if (offset + 1 < _BUS_ROM_SIZE) {
-		data |= rom[offset + 1];
+	switch (kind) {
+	case _BUS_PAGE_DTACK: //
+		*out = nullptr;
+		return RBT_ERR_SUCCESS;
+	case _BUS_PAGE_BERR:
+		bus->fault = (RBT_BusFault) { addr, is_read };
+		_push_event(RBT_SEVERITY_ERROR, RBT_ERR_MEM_BUS_ERROR, _ERR_FMT_BUS_ERROR, addr);
+		return RBT_ERR_MEM_BUS_ERROR;
+	default: break;
 	}
 
-	*word = data;
-	return RBT_ERR_SUCCESS;
+	// The M68000/MC68008/MC68010 does not support unaligned access
+	if (is_word && (addr & 1)) {
+		bus->fault = (RBT_BusFault) { addr, is_read };
+		_push_event(RBT_SEVERITY_WARN, RBT_ERR_SUCCESS, _ERR_FMT_UNALIGNED, addr);
+		return RBT_ERR_MEM_ADDR_ERROR;
+	}
+
+	switch (kind) {
+	case _BUS_PAGE_DEVICE: //
+		*offset = addr - (*out)->addr;
+		return RBT_ERR_SUCCESS;
+	case _BUS_PAGE_MEMORY:
+		// Reads are always served from host memory, only ROM writes get here
+		_push_event(RBT_SEVERITY_WARN, RBT_ERR_SUCCESS, _ERR_FMT_ROM_WRITE, addr);
+		return RBT_ERR_MEM_READONLY;
+	default:
+		_push_event(RBT_SEVERITY_WARN, RBT_ERR_SUCCESS, _ERR_FMT_UNMAPPED, addr);
+		return RBT_ERR_MEM_UNMAPPED;
+	}
 }
 
-static inline RBT_ErrorCode _rom_write_byte(void *device, u32 addr, u8 byte) {
-	(void)device;
-	(void)byte;
+void _bus_invalidate_code_range(RBT_MemoryBus *bus, u32 first_page, u32 count) {
+	assert(first_page + count <= _BUS_CODE_PAGE_COUNT);
 
-	_push_warn("Write attempt on ROM at: 0x%06x", addr);
-	return RBT_ERR_MEM_READONLY;
+	for (u32 page = first_page; page < first_page + count; page += 1) {
+		bus->code_mark[page] = false;
+		bus->code_gen[page] += 1;
+	}
 }
 
-static RBT_IODevice *_query_iodevice_range(RBT_MemoryBus *bus, u32 addr, u32 *offset) {
-	assert(offset);
-
-	for (i32 i = 0; i < _RBT_BUSDEV_COUNT; i += 1) {
-		RBT_IODevice *dev = &bus->mmio_devices[i];
-		if (dev->size != 0 && _is_address_in_range(addr, dev->addr, dev->size)) {
-			*offset = addr - dev->addr;
-			return dev;
-		}
+// RAM starts out zero-filled. Anonymous mappings only take memory once a page
+// is touched, and can give it back on reset.
+static u8 *_bus_alloc_ram(usize size, bool *is_mapped) {
+#ifdef MAP_ANONYMOUS
+	int prot = PROT_READ | PROT_WRITE;
+	void *data = mmap(nullptr, size, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (data != MAP_FAILED) {
+		*is_mapped = true;
+		return data;
 	}
+#endif
 
-	return nullptr;
+	*is_mapped = false;
+	return calloc(size, 1);
 }
 
-RBT_ErrorCode _bus_fetch_imm(
-	RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 *out
-) {
-	switch (size) {
-	case RBT_SIZE_BYTE:
-	case RBT_SIZE_WORD: {
-		u16 word;
-		RBT_ErrorCode err = rbt_bus_read_word(bus, addr, &word);
-		*out = size == RBT_SIZE_BYTE ? (word & 0xff) : word;
-		return err;
-	}
-	case RBT_SIZE_LONG: return rbt_bus_read_long(bus, addr, out);
-	default:			return RBT_ERR_INVALID_ARGS;
+static void _bus_free_ram(u8 *data, usize size, bool is_mapped) {
+	if (!data)
+		return;
+
+#ifdef MAP_ANONYMOUS
+	if (is_mapped) {
+		munmap(data, size);
+		return;
 	}
+#else
+	(void)size;
+	(void)is_mapped;
+#endif
+	free(data);
+}
 
-	unreachable();
+static void _bus_mark_dirty(RBT_MemoryBus *bus, usize offset, usize size) {
+	usize first = offset >> _BUS_CODE_PAGE_SHIFT;
+	usize last = (offset + size - 1) >> _BUS_CODE_PAGE_SHIFT;
+	for (usize page = first; page <= last; page += 1) {
+		bus->ram.dirty[page >> 6] |= 1ull << (page & 63);
+	}
 }
 
 [[nodiscard]] RBT_MemoryBus *rbt_create_bus(const RBT_BusConfig *cfg) {
 	assert(cfg);
 
-	if (cfg->ram_slots[0] == RBT_RAM_NONE) {
-		_push_fatal(RBT_ERR_INVALID_ARGS, "RAM slot 0 must be populated");
+	usize ram_size = _bus_ram_size(cfg);
+	if (ram_size == 0)
 		return nullptr;
-	}
 
+	bool is_mapped;
 	RBT_MemoryBus *bus = malloc(sizeof(RBT_MemoryBus));
-	if (!bus) {
+	u8 *ram = _bus_alloc_ram(ram_size, &is_mapped);
+	u8 *rom = malloc(_BUS_ROM_SIZE);
+	if (!bus || !ram || !rom) {
 		_push_fatal(RBT_ERR_SYS_OUT_OF_MEMORY, "Failed to allocate RBT_MemoryBus");
-		goto error;
+		free(bus);
+		_bus_free_ram(ram, ram_size, is_mapped);
+		free(rom);
+		return nullptr;
+	}
+
+	_bus_setup(bus, cfg, ram, rom);
+
+	// Unlike the caller's memory in _bus_setup(), ours is known to be zero
+	bus->ram.is_mapped = is_mapped;
+	memset(bus->ram.dirty, 0, sizeof(bus->ram.dirty));
+	return bus;
+}
+
+usize _bus_ram_size(const RBT_BusConfig *cfg) {
+	assert(cfg);
+
+	if (cfg->ram_slots[0] == RBT_RAM_NONE) {
+		_push_fatal(RBT_ERR_INVALID_ARGS, "RAM slot 0 must be populated");
+		return 0;
+	}
+
+	usize size = 0;
+	for (i32 i = 0; i < _BUS_RAM_SLOTS_COUNT; i += 1) {
+		size += _ram_module_sizes[(u32)cfg->ram_slots[i]];
 	}
+	return size;
+}
+
+void _bus_setup(RBT_MemoryBus *bus, const RBT_BusConfig *cfg, u8 *ram, u8 *rom) {
+	assert(bus && cfg);
+	assert(ram && rom);
+
 	memset(bus, 0, sizeof(RBT_MemoryBus));
 
 	u32 offset = 0;
@@ -162,66 +305,75 @@ RBT_ErrorCode _bus_fetch_imm(
 	}
 
 	bus->ram.size = offset;
-	bus->ram.data = malloc(bus->ram.size);
-	if (!bus->ram.data) {
-		_push_fatal(RBT_ERR_SYS_OUT_OF_MEMORY, "Failed to allocate RAM");
-		goto error;
-	}
-
-	bus->rom = malloc(_BUS_ROM_SIZE);
-	if (!bus->rom) {
-		_push_fatal(RBT_ERR_SYS_OUT_OF_MEMORY, "Failed to allocate ROM memory area");
-		goto error;
-	}
-	memset(bus->rom, 0, _BUS_ROM_SIZE);
-
-	// Register IO Devices
-	bus->mmio_devices[RBT_BUSDEV_RAM] = (RBT_IODevice) {
-		.addr = _BUS_RAM_ADDR,
-		.size = _BUS_RAM_SIZE,
-		.device = &bus->ram,
-		.read_byte = _ram_read_byte,
-		.read_word = nullptr,
-		.write_byte = _ram_write_byte,
-		.write_word = nullptr,
-	};
-
-	bus->mmio_devices[RBT_BUSDEV_ROM] = (RBT_IODevice) {
-		.addr = _BUS_ROM_ADDR,
-		.size = _BUS_ROM_SIZE * 2, // map out the 512KB of ROM + MIRROR
-		.device = bus->rom,
-		.read_byte = _rom_read_byte,
-		.read_word = _rom_read_word,
-		.write_byte = _rom_write_byte,
-		.write_word = nullptr,
-	};
+	bus->ram.data = ram;
+	_bus_mark_dirty(bus, 0, bus->ram.size); // Cleared by the first reset
 
-	return bus;
+	// If slot is unpopulated, mirror into slot 0
+	for (i32 i = 0; i < _BUS_RAM_SLOTS_COUNT; i += 1) {
+		i32 slot = bus->ram.slot_size[i] ? i : 0;
+		bus->ram.slot_base[i] = &bus->ram.data[bus->ram.slot_offset[slot]];
+		bus->ram.slot_mask[i] = bus->ram.slot_size[slot] - 1;
+	}
 
-error:
-	if (bus)
-		rbt_destroy_bus(bus);
+	bus->rom = rom;
+	bus->rom_data = rom;
+	memset(bus->rom_data, 0, _BUS_ROM_SIZE);
 
-	return nullptr;
+	// RAM and ROM are mapped straight into the page table, no devices needed
+	for (u32 index = 0; index < _BUS_PAGE_COUNT; index += 1) {
+		_bus_map_page(bus, index);
+	}
 }
 
 void rbt_destroy_bus(RBT_MemoryBus *bus) {
 	if (!bus)
 		return;
 
-	if (bus->ram.data)
-		free(bus->ram.data);
-	if (bus->rom)
-		free(bus->rom);
+	_bus_teardown(bus);
+	_bus_free_ram(bus->ram.data, bus->ram.size, bus->ram.is_mapped);
+	free(bus->rom_data);
 
 	free(bus);
 }
 
+void _bus_teardown(RBT_MemoryBus *bus) {
+	assert(bus);
+
+	_rom_image_release(bus->rom_image);
+	bus->rom_image = nullptr;
+}
+
 void rbt_bus_reset(RBT_MemoryBus *bus) {
 	if (!bus)
 		return;
 
-	memset(bus->ram.data, 0, bus->ram.size);
+	RBT_RamDevice *ram = &bus->ram;
+	usize words = sizeof(ram->dirty) / sizeof(ram->dirty[0]);
+
+	bool is_released = false;
+#ifdef __linux__
+	u32 dirty_pages = 0;
+	for (usize i = 0; i < words; i += 1) {
+		dirty_pages += rbt_popcount_u64(ram->dirty[i]);
+	}
+
+	// Private anonymous pages read back as zero once dropped
+	is_released = ram->is_mapped && dirty_pages > _BUS_RESET_RELEASE_PAGES
+			   && madvise(ram->data, ram->size, MADV_DONTNEED) == 0;
+#endif
+
+	// Pages that were never written still hold zeros and valid decoded code
+	for (usize i = 0; i < words; i += 1) {
+		u64 bits = ram->dirty[i];
+		ram->dirty[i] = 0;
+
+		for (; bits; bits &= bits - 1) {
+			u32 page = (u32)(i * 64) + rbt_ctz_u64(bits);
+			if (!is_released)
+				memset(&ram->data[page << _BUS_CODE_PAGE_SHIFT], 0, _BUS_CODE_PAGE_SIZE);
+			_bus_invalidate_code_range(bus, page, 1);
+		}
+	}
 }
 
 void rbt_bus_attach_iodevice(
@@ -236,7 +388,34 @@ void rbt_bus_attach_iodevice(
 		return;
 	}
 
+	RBT_IODevice previous = bus->mmio_devices[busdev];
 	bus->mmio_devices[busdev] = *device;
+
+	// Pages of the old range may go back to the base memory map
+	_bus_map_range(bus, previous.addr, previous.size);
+	_bus_map_range(bus, device->addr, device->size);
+}
+
+// Points the ROM region at `rom`, owned by `image` if not null. The previous
+// image is released.
+static void _bus_select_rom(RBT_MemoryBus *bus, const u8 *rom, RBT_RomImage *image) {
+	if (bus->rom == rom)
+		return;
+
+	_rom_image_release(bus->rom_image);
+	bus->rom = rom;
+	bus->rom_image = image;
+	bus->map_gen += 1;
+	_bus_map_range(bus, _BUS_ROM_ADDR, _BUS_ROM_SIZE * 2);
+}
+
+// Mirrors the vector table into RAM and drops code decoded from the old ROM
+static void _bus_load_rom(RBT_MemoryBus *bus) {
+	usize vec_table_size = 1024; // 256 vectors * 4 bytes
+	memcpy(bus->ram.data, bus->rom, vec_table_size);
+	_bus_mark_dirty(bus, 0, vec_table_size);
+
+	_bus_invalidate_code_range(bus, 0, _BUS_CODE_PAGE_COUNT);
 }
 
 RBT_ErrorCode rbt_bus_init(RBT_MemoryBus *bus, usize size, const u8 *rom) {
@@ -250,17 +429,15 @@ RBT_ErrorCode rbt_bus_init(RBT_MemoryBus *bus, usize size, const u8 *rom) {
 		_push_warn("ROM truncated: size %zu exceeds max %u", size, _BUS_ROM_SIZE);
 		size = _BUS_ROM_SIZE;
 	}
-	memcpy(bus->rom, rom, size);
-
-	// Mirror vector table into RAM
-	usize vec_table_size = 1024; // 256 vectors * 4 bytes
-	memcpy(bus->ram.data, bus->rom, vec_table_size);
+	_bus_select_rom(bus, bus->rom_data, nullptr);
+	memcpy(bus->rom_data, rom, size);
+	_bus_load_rom(bus);
 
 	return RBT_ERR_SUCCESS;
 }
 
 RBT_ErrorCode rbt_bus_init_from_file(RBT_MemoryBus *bus, const char *filename) {
-	assert(bus && bus->rom);
+	assert(bus && bus->rom_data);
 	assert(filename);
 
 	FILE *file = fopen(filename, "rb");
@@ -268,6 +445,7 @@ RBT_ErrorCode rbt_bus_init_from_file(RBT_MemoryBus *bus, const char *filename) {
 		_push_error(RBT_ERR_SYS_IO, "Failed to open ROM file at: %s", filename);
 		return RBT_ERR_SYS_IO;
 	}
+	_bus_select_rom(bus, bus->rom_data, nullptr);
 
 	usize size = 0;
 	while (size < _BUS_ROM_SIZE) {
@@ -281,7 +459,7 @@ RBT_ErrorCode rbt_bus_init_from_file(RBT_MemoryBus *bus, const char *filename) {
 		if (bytes_read > remaining)
 			bytes_read = remaining;
 
-		memcpy(bus->rom + size, buf, bytes_read);
+		memcpy(bus->rom_data + size, buf, bytes_read);
 		size += bytes_read;
 	}
 
@@ -292,10 +470,28 @@ RBT_ErrorCode rbt_bus_init_from_file(RBT_MemoryBus *bus, const char *filename) {
 	}
 
 	fclose(file);
+	_bus_load_rom(bus);
 
-	// Mirror vector table into RAM
-	usize vec_table_size = 1024; // 256 vectors * 4 bytes
-	memcpy(bus->ram.data, bus->rom, vec_table_size);
+	return RBT_ERR_SUCCESS;
+}
+
+RBT_ErrorCode rbt_bus_map_rom_file(RBT_MemoryBus *bus, const char *filename) {
+	assert(bus);
+	assert(filename);
+
+	RBT_RomImage *image;
+	RBT_ErrorCode err = _rom_image_acquire(filename, &image);
+	if (err == RBT_ERR_UNIMPLEMENTED)
+		return rbt_bus_init_from_file(bus, filename);
+	if (err)
+		return err;
+
+	// Loading the same file again keeps the current mapping
+	if (image == bus->rom_image)
+		_rom_image_release(image);
+	else
+		_bus_select_rom(bus, _rom_image_data(image), image);
+	_bus_load_rom(bus);
 
 	return RBT_ERR_SUCCESS;
 }
@@ -306,25 +502,23 @@ RBT_ErrorCode rbt_bus_read_byte(RBT_MemoryBus *bus, u32 addr, u8 *out) {
 
 	addr &= 0x00ffffff;
 
-	if (_is_address_in_range(addr, _BUS_RESERVED_DTACK_ADDR, _BUS_RESERVED_DTACK_SIZE)) {
+	const RBT_BusPage *page = _bus_page(bus, addr);
+	if (page->read) {
+		*out = page->read[addr & _BUS_PAGE_MASK];
 		return RBT_ERR_SUCCESS;
 	}
 
-	if (_is_address_in_range(addr, _BUS_RESERVED_BERR_ADDR, _BUS_RESERVED_BERR_SIZE)) {
-		_push_error(
-			RBT_ERR_MEM_BUS_ERROR, "Tried to access invalid address at: 0x%06x", addr
-		);
-		return RBT_ERR_MEM_BUS_ERROR;
-	}
+	if (page->kind == _BUS_PAGE_DTACK)
+		return RBT_ERR_SUCCESS;
 
 	u32 offset;
-	RBT_IODevice *io = _query_iodevice_range(bus, addr, &offset);
-	if (!io || !io->read_byte) {
-		const RBT_ErrorEntry *last = rbt_query_last_error();
-		if (last && last->code == RBT_ERR_MEM_BUS_ERROR)
-			return RBT_ERR_MEM_BUS_ERROR;
+	RBT_IODevice *io;
+	RBT_ErrorCode err = _bus_find_device(bus, addr, false, true, &io, &offset);
+	if (err || !io)
+		return err;
 
-		_push_warn("Memory isn't mapped at: 0x%06x", addr);
+	if (!io->read_byte) {
+		_push_event(RBT_SEVERITY_WARN, RBT_ERR_SUCCESS, _ERR_FMT_UNMAPPED, addr);
 		return RBT_ERR_MEM_UNMAPPED;
 	}
 
@@ -335,45 +529,28 @@ RBT_ErrorCode rbt_bus_read_word(RBT_MemoryBus *bus, u32 addr, u16 *out) {
 	assert(bus);
 	assert(out);
 
-	addr &= 0x00ffffff;
+	return _bus_read_word(bus, addr, out);
+}
 
-	if (_is_address_in_range(addr, _BUS_RESERVED_DTACK_ADDR, _BUS_RESERVED_DTACK_SIZE)) {
+RBT_ErrorCode _bus_read_word_slow(RBT_MemoryBus *bus, u32 addr, u16 *out) {
+	addr &= 0x00ffffff;
+	if (_bus_page(bus, addr)->kind == _BUS_PAGE_DTACK)
 		return RBT_ERR_SUCCESS;
-	}
-
-	if (_is_address_in_range(addr, _BUS_RESERVED_BERR_ADDR, _BUS_RESERVED_BERR_SIZE)) {
-		_push_error(
-			RBT_ERR_MEM_BUS_ERROR, "Tried to access invalid address at: 0x%06x", addr
-		);
-		return RBT_ERR_MEM_BUS_ERROR;
-	}
-
-	// The M68000/MC68008/MC68010 does not support unaligned access
-	if (addr & 1) {
-		_push_warn("Unaligned memory access at: 0x%06x", addr);
-		return RBT_ERR_MEM_ADDR_ERROR;
-	}
 
 	u32 offset;
-	RBT_IODevice *io = _query_iodevice_range(bus, addr, &offset);
-	if (!io) {
-		const RBT_ErrorEntry *last = rbt_query_last_error();
-		if (last && last->code == RBT_ERR_MEM_BUS_ERROR)
-			return RBT_ERR_MEM_BUS_ERROR;
-
-		_push_warn("Memory isn't mapped at: 0x%06x", addr);
-		return RBT_ERR_MEM_UNMAPPED;
-	}
+	RBT_IODevice *io;
+	RBT_ErrorCode err = _bus_find_device(bus, addr, true, true, &io, &offset);
+	if (err || !io)
+		return err;
 
 	if (io->read_word)
 		return io->read_word(io->device, offset, out);
 
 	if (!io->read_byte) {
-		_push_error(RBT_ERR_MEM_UNMAPPED, "Memory isn't mapped at: 0x%06x", addr);
+		_push_event(RBT_SEVERITY_ERROR, RBT_ERR_MEM_UNMAPPED, _ERR_FMT_UNMAPPED, addr);
 		return RBT_ERR_MEM_UNMAPPED;
 	}
 
-	RBT_ErrorCode err;
 	u8 hi;
 	u8 lo;
 
@@ -393,14 +570,18 @@ RBT_ErrorCode rbt_bus_read_long(RBT_MemoryBus *bus, u32 addr, u32 *out) {
 	assert(bus);
 	assert(out);
 
+	return _bus_read_long(bus, addr, out);
+}
+
+RBT_ErrorCode _bus_read_long_slow(RBT_MemoryBus *bus, u32 addr, u32 *out) {
 	u16 high_word;
 	u16 low_word;
 
-	RBT_ErrorCode err = rbt_bus_read_word(bus, addr, &high_word);
+	RBT_ErrorCode err = _bus_read_word(bus, addr, &high_word);
 	if (err)
 		return err;
 
-	err = rbt_bus_read_word(bus, addr + 2, &low_word);
+	err = _bus_read_word(bus, addr + 2, &low_word);
 	if (err)
 		return err;
 
@@ -413,25 +594,24 @@ RBT_ErrorCode rbt_bus_write_byte(RBT_MemoryBus *bus, u32 addr, u8 byte) {
 
 	addr &= 0x00ffffff;
 
-	if (_is_address_in_range(addr, _BUS_RESERVED_DTACK_ADDR, _BUS_RESERVED_DTACK_SIZE)) {
+	const RBT_BusPage *page = _bus_page(bus, addr);
+	if (page->write) {
+		page->write[addr & _BUS_PAGE_MASK] = byte;
+		_bus_note_write(bus, page);
 		return RBT_ERR_SUCCESS;
 	}
 
-	if (_is_address_in_range(addr, _BUS_RESERVED_BERR_ADDR, _BUS_RESERVED_BERR_SIZE)) {
-		_push_error(
-			RBT_ERR_MEM_BUS_ERROR, "Tried to access invalid address at: 0x%06x", addr
-		);
-		return RBT_ERR_MEM_BUS_ERROR;
-	}
+	if (page->kind == _BUS_PAGE_DTACK)
+		return RBT_ERR_SUCCESS;
 
 	u32 offset;
-	RBT_IODevice *io = _query_iodevice_range(bus, addr, &offset);
-	if (!io || !io->write_byte) {
-		const RBT_ErrorEntry *last = rbt_query_last_error();
-		if (last && last->code == RBT_ERR_MEM_BUS_ERROR)
-			return RBT_ERR_MEM_BUS_ERROR;
+	RBT_IODevice *io;
+	RBT_ErrorCode err = _bus_find_device(bus, addr, false, false, &io, &offset);
+	if (err || !io)
+		return err;
 
-		_push_warn("Memory isn't mapped at: 0x%06x", addr);
+	if (!io->write_byte) {
+		_push_event(RBT_SEVERITY_WARN, RBT_ERR_SUCCESS, _ERR_FMT_UNMAPPED, addr);
 		return RBT_ERR_MEM_UNMAPPED;
 	}
 
@@ -441,45 +621,29 @@ RBT_ErrorCode rbt_bus_write_byte(RBT_MemoryBus *bus, u32 addr, u8 byte) {
 RBT_ErrorCode rbt_bus_write_word(RBT_MemoryBus *bus, u32 addr, u16 word) {
 	assert(bus);
 
-	addr &= 0x00ffffff;
+	return _bus_write_word(bus, addr, word);
+}
 
-	if (_is_address_in_range(addr, _BUS_RESERVED_DTACK_ADDR, _BUS_RESERVED_DTACK_SIZE)) {
+RBT_ErrorCode _bus_write_word_slow(RBT_MemoryBus *bus, u32 addr, u16 word) {
+	addr &= 0x00ffffff;
+	if (_bus_page(bus, addr)->kind == _BUS_PAGE_DTACK)
 		return RBT_ERR_SUCCESS;
-	}
-
-	if (_is_address_in_range(addr, _BUS_RESERVED_BERR_ADDR, _BUS_RESERVED_BERR_SIZE)) {
-		_push_error(
-			RBT_ERR_MEM_BUS_ERROR, "Tried to access invalid address at: 0x%06x", addr
-		);
-		return RBT_ERR_MEM_BUS_ERROR;
-	}
-
-	// The M68000/MC68008/MC68010 doesn't support unaligned access
-	if (addr & 1) {
-		_push_warn("Unaligned memory access at: 0x%06x", addr);
-		return RBT_ERR_MEM_ADDR_ERROR;
-	}
 
 	u32 offset;
-	RBT_IODevice *io = _query_iodevice_range(bus, addr, &offset);
-	if (!io) {
-		const RBT_ErrorEntry *last = rbt_query_last_error();
-		if (last && last->code == RBT_ERR_MEM_BUS_ERROR)
-			return RBT_ERR_MEM_BUS_ERROR;
-
-		_push_warn("Memory isn't mapped at: 0x%06x", addr);
-		return RBT_ERR_MEM_UNMAPPED;
-	}
+	RBT_IODevice *io;
+	RBT_ErrorCode err = _bus_find_device(bus, addr, true, false, &io, &offset);
+	if (err || !io)
+		return err;
 
 	if (io->write_word)
 		return io->write_word(io->device, offset, word);
 
 	if (!io->write_byte) {
-		_push_error(RBT_ERR_MEM_UNMAPPED, "Memory isn't mapped at: 0x%06x", addr);
+		_push_event(RBT_SEVERITY_ERROR, RBT_ERR_MEM_UNMAPPED, _ERR_FMT_UNMAPPED, addr);
 		return RBT_ERR_MEM_UNMAPPED;
 	}
 
-	RBT_ErrorCode err = io->write_byte(io->device, offset + 0, (word >> 8) & 0xff);
+	err = io->write_byte(io->device, offset + 0, (word >> 8) & 0xff);
 	if (err)
 		return err;
 
@@ -489,47 +653,166 @@ RBT_ErrorCode rbt_bus_write_word(RBT_MemoryBus *bus, u32 addr, u16 word) {
 RBT_ErrorCode rbt_bus_write_long(RBT_MemoryBus *bus, u32 addr, u32 long_) {
 	assert(bus);
 
-	RBT_ErrorCode err = rbt_bus_write_word(bus, addr, (long_ >> 16) & 0xffff);
+	return _bus_write_long(bus, addr, long_);
+}
+
+RBT_ErrorCode _bus_write_long_slow(RBT_MemoryBus *bus, u32 addr, u32 long_) {
+	RBT_ErrorCode err = _bus_write_word(bus, addr, (long_ >> 16) & 0xffff);
 	if (err)
 		return err;
 
-	return rbt_bus_write_word(bus, addr + 2, long_ & 0xffff);
+	return _bus_write_word(bus, addr + 2, long_ & 0xffff);
 }
 
 RBT_ErrorCode rbt_bus_load(RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 *out) {
-	RBT_ErrorCode err;
-
-	switch (size) {
-	case RBT_SIZE_BYTE: {
-		u8 byte;
-		err = rbt_bus_read_byte(bus, addr, &byte);
-		if (!err)
-			*out = byte;
-		return err;
-	};
-	case RBT_SIZE_WORD: {
-		u16 word;
-		err = rbt_bus_read_word(bus, addr, &word);
-		if (!err)
-			*out = word;
-		return err;
-	};
-	case RBT_SIZE_LONG: return rbt_bus_read_long(bus, addr, out);
-	default:			return RBT_ERR_INVALID_ARGS;
-	}
-
-	unreachable();
+	return _bus_load(bus, size, addr, out);
 }
 
 RBT_ErrorCode rbt_bus_store(
 	RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 data
 ) {
-	switch (size) {
-	case RBT_SIZE_BYTE: return rbt_bus_write_byte(bus, addr, data & 0x00ff);
-	case RBT_SIZE_WORD: return rbt_bus_write_word(bus, addr, data & 0xffff);
-	case RBT_SIZE_LONG: return rbt_bus_write_long(bus, addr, data);
-	default:			return RBT_ERR_INVALID_ARGS;
+	return _bus_store(bus, size, addr, data);
+}
+
+// Block transfers go page by page, the unit the memory map works in
+static inline u32 _bus_block_chunk(u32 addr, usize remaining) {
+	u32 room = _BUS_PAGE_MASK + 1 - (addr & _BUS_PAGE_MASK);
+	return remaining < room ? (u32)remaining : room;
+}
+
+// Devices see aligned word accesses, bytes only at odd edges of the chunk
+static RBT_ErrorCode _bus_read_device_block(
+	RBT_MemoryBus *bus, u32 addr, u8 *out, u32 size, usize *done
+) {
+	for (u32 i = 0; i < size;) {
+		bool is_word = ((addr + i) & 1) == 0 && size - i >= 2;
+
+		// /DTACK regions leave the output untouched, they read as zero here
+		RBT_ErrorCode err;
+		if (is_word) {
+			u16 word = 0;
+			err = _bus_read_word_slow(bus, addr + i, &word);
+			out[i + 0] = (word >> 8) & 0xff;
+			out[i + 1] = word & 0xff;
+		} else {
+			out[i] = 0;
+			err = rbt_bus_read_byte(bus, addr + i, &out[i]);
+		}
+		if (err)
+			return err;
+
+		i += is_word ? 2 : 1;
+		*done += is_word ? 2 : 1;
+	}
+
+	return RBT_ERR_SUCCESS;
+}
+
+static RBT_ErrorCode _bus_write_device_block(
+	RBT_MemoryBus *bus, u32 addr, const u8 *data, u32 size, usize *done
+) {
+	for (u32 i = 0; i < size;) {
+		bool is_word = ((addr + i) & 1) == 0 && size - i >= 2;
+
+		RBT_ErrorCode err;
+		if (is_word)
+			err = _bus_write_word_slow(bus, addr + i, (data[i] << 8) | data[i + 1]);
+		else
+			err = rbt_bus_write_byte(bus, addr + i, data[i]);
+		if (err)
+			return err;
+
+		i += is_word ? 2 : 1;
+		*done += is_word ? 2 : 1;
+	}
+
+	return RBT_ERR_SUCCESS;
+}
+
+RBT_ErrorCode rbt_bus_read_block(
+	RBT_MemoryBus *bus, u32 addr, u8 *out, usize size, usize *transferred
+) {
+	assert(bus);
+	assert(out || size == 0);
+
+	usize done = 0;
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	while (done < size && !err) {
+		u32 at = (u32)(addr + done) & 0xff'ffff;
+		u32 chunk = _bus_block_chunk(at, size - done);
+
+		const RBT_BusPage *page = _bus_page(bus, at);
+		if (page->read) {
+			memcpy(&out[done], &page->read[at & _BUS_PAGE_MASK], chunk);
+			done += chunk;
+		} else if (page->kind == _BUS_PAGE_DTACK) {
+			memset(&out[done], 0, chunk);
+			done += chunk;
+		} else {
+			err = _bus_read_device_block(bus, at, &out[done], chunk, &done);
+		}
+	}
+
+	if (transferred)
+		*transferred = done;
+	return err;
+}
+
+RBT_ErrorCode rbt_bus_write_block(
+	RBT_MemoryBus *bus, u32 addr, const u8 *data, usize size, usize *transferred
+) {
+	assert(bus);
+	assert(data || size == 0);
+
+	usize done = 0;
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	while (done < size && !err) {
+		u32 at = (u32)(addr + done) & 0xff'ffff;
+		u32 chunk = _bus_block_chunk(at, size - done);
+
+		const RBT_BusPage *page = _bus_page(bus, at);
+		if (page->write) {
+			memcpy(&page->write[at & _BUS_PAGE_MASK], &data[done], chunk);
+			_bus_note_write(bus, page);
+			done += chunk;
+		} else if (page->kind == _BUS_PAGE_DTACK) {
+			done += chunk;
+		} else {
+			err = _bus_write_device_block(bus, at, &data[done], chunk, &done);
+		}
+	}
+
+	if (transferred)
+		*transferred = done;
+	return err;
+}
+
+RBT_ErrorCode rbt_bus_fill(
+	RBT_MemoryBus *bus, u32 addr, u8 value, usize size, usize *transferred
+) {
+	assert(bus);
+
+	usize done = 0;
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	while (done < size && !err) {
+		u32 at = (u32)(addr + done) & 0xff'ffff;
+		u32 chunk = _bus_block_chunk(at, size - done);
+
+		const RBT_BusPage *page = _bus_page(bus, at);
+		if (page->write) {
+			memset(&page->write[at & _BUS_PAGE_MASK], value, chunk);
+			_bus_note_write(bus, page);
+			done += chunk;
+		} else if (page->kind == _BUS_PAGE_DTACK) {
+			done += chunk;
+		} else {
+			u8 pattern[_BUS_PAGE_MASK + 1];
+			memset(pattern, value, chunk);
+			err = _bus_write_device_block(bus, at, pattern, chunk, &done);
+		}
 	}
 
-	unreachable();
+	if (transferred)
+		*transferred = done;
+	return err;
 }
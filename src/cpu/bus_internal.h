@@ -17,10 +17,24 @@
 
 #pragma once
 
+#include "cpu/rom_image.h"
 #include "rbt/basic_types.h"
 #include "rbt/cpu/bus.h"
 #include "rbt/cpu/types.h"
 #include "rbt/error_codes.h"
+#include "rbt/helpers.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Guest memory is big-endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#	define _bus_be16(x) (x)
+#	define _bus_be32(x) (x)
+#else
+#	define _bus_be16(x) rbt_bswap_u16(x)
+#	define _bus_be32(x) rbt_bswap_u32(x)
+#endif
 
 enum {
 	_BUS_RAM_ADDR = 0x00'0000,
@@ -54,23 +68,341 @@ enum {
 	_BUS_RESERVED_BERR_SIZE = 11 * (1024 * 1024), // ~11MB triggers /BERR
 	_BUS_RESERVED_DTACK_ADDR = 0xf8'0000,
 	_BUS_RESERVED_DTACK_SIZE = 3 * (64 * 1024), // 192KB does nothing /DTACK
+
+	// Code pages: physical RAM pages followed by ROM pages, used to invalidate
+	// decoded instructions when the memory backing them changes.
+	_BUS_CODE_PAGE_SHIFT = 12, // 4KB pages
+	_BUS_CODE_PAGE_SIZE = 1 << _BUS_CODE_PAGE_SHIFT,
+	_BUS_CODE_RAM_PAGES = _BUS_RAM_SIZE >> _BUS_CODE_PAGE_SHIFT,
+	_BUS_CODE_ROM_PAGES = _BUS_ROM_SIZE >> _BUS_CODE_PAGE_SHIFT,
+	_BUS_CODE_PAGE_COUNT = _BUS_CODE_RAM_PAGES + _BUS_CODE_ROM_PAGES,
+	_BUS_CODE_PAGE_NONE = UINT32_MAX,
+
+	// Memory map: one entry per 4KB page of the 24-bit address space
+	_BUS_PAGE_SHIFT = _BUS_CODE_PAGE_SHIFT,
+	_BUS_PAGE_MASK = (1 << _BUS_PAGE_SHIFT) - 1,
+	_BUS_PAGE_COUNT = 0x100'0000 >> _BUS_PAGE_SHIFT,
+
+	// Outside the 24-bit space, no address falls in an empty fetch window
+	_BUS_FETCH_NONE = 0x8000'0000,
 };
 
+typedef enum RBT_BusPageKind {
+	_BUS_PAGE_UNMAPPED = 0,
+	_BUS_PAGE_MEMORY, // RAM/ROM, accessed through the host pointers
+	_BUS_PAGE_DEVICE, // A single device covers the whole page
+	_BUS_PAGE_SHARED, // Several devices share the page, looked up by address
+	_BUS_PAGE_BERR,	  // Access triggers /BERR
+	_BUS_PAGE_DTACK,  // Access is acknowledged and does nothing
+} RBT_BusPageKind;
+
+typedef struct RBT_BusPage {
+	const u8 *read;	   // Host memory backing the page, if it's readable RAM/ROM
+	u8 *write;		   // Host memory backing the page, if it's writable RAM
+	RBT_IODevice *dev; // _BUS_PAGE_DEVICE only
+	u32 code_page;	   // Code page backing the page, or _BUS_CODE_PAGE_NONE
+	u8 kind;		   // RBT_BusPageKind
+} RBT_BusPage;
+
 typedef struct RBT_RamDevice {
 	u8 *data; // 0x00'0000-0x3f'ffff (Max 4MB)
 	usize size;
 
 	u32 slot_size[_BUS_RAM_SLOTS_COUNT];
 	u32 slot_offset[_BUS_RAM_SLOTS_COUNT];
+
+	// Resolved at creation, unpopulated slots point at slot 0
+	u8 *slot_base[_BUS_RAM_SLOTS_COUNT];
+	u32 slot_mask[_BUS_RAM_SLOTS_COUNT];
+
+	// Bit per 4KB page written since the last reset
+	u64 dirty[_BUS_CODE_RAM_PAGES / 64];
+	bool is_mapped; // `data` is an anonymous mapping owned by the bus
 } RBT_RamDevice;
 
+// Page the instruction stream is being fetched from. Reads go straight to its
+// host memory until the PC leaves the page or the page table changes.
+typedef struct RBT_FetchWindow {
+	const u8 *host; // Host memory behind `base`
+	u32 base;		// First address of the page, or _BUS_FETCH_NONE
+} RBT_FetchWindow;
+
+// Last access that ended in /BERR or an address error
+typedef struct RBT_BusFault {
+	u32 addr;
+	bool is_read;
+} RBT_BusFault;
+
 typedef struct RBT_MemoryBus {
 	RBT_IODevice mmio_devices[_RBT_BUSDEV_COUNT];
+	RBT_BusPage pages[_BUS_PAGE_COUNT];
 
 	RBT_RamDevice ram;
-	u8 *rom; // 0xf0'0000-0xf3'ffff (256KB)
+	const u8 *rom;			 // 0xf0'0000-0xf3'ffff (256KB), `rom_data` or the image
+	u8 *rom_data;			 // ROM copied in by rbt_bus_init*()
+	RBT_RomImage *rom_image; // ROM mapped by rbt_bus_map_rom_file(), may be null
+	RBT_BusFault fault;
+	RBT_FetchWindow fetch;
+
+	// Bumped whenever host pointers into ROM change
+	u32 map_gen;
+
+	// Bumped whenever a page holding decoded code is written to
+	u32 code_gen[_BUS_CODE_PAGE_COUNT];
+	bool code_mark[_BUS_CODE_PAGE_COUNT];
 } RBT_MemoryBus;
 
-RBT_ErrorCode _bus_fetch_imm(
+// Returns the code page backing `addr`, or _BUS_CODE_PAGE_NONE if the address
+// isn't backed by RAM/ROM (and thus must never be cached).
+static inline u32 _bus_code_page(RBT_MemoryBus *bus, u32 addr) {
+	return bus->pages[(addr & 0xff'ffff) >> _BUS_PAGE_SHIFT].code_page;
+}
+
+void _bus_invalidate_code_range(RBT_MemoryBus *bus, u32 first_page, u32 count);
+
+// RAM needed by `cfg`, 0 if it isn't a valid configuration
+[[nodiscard]] usize _bus_ram_size(const RBT_BusConfig *cfg);
+// Initializes a bus living in memory the caller owns. `ram` holds
+// _bus_ram_size() bytes and `rom` _BUS_ROM_SIZE bytes.
+void _bus_setup(RBT_MemoryBus *bus, const RBT_BusConfig *cfg, u8 *ram, u8 *rom);
+// Releases what the bus holds besides the memory given to _bus_setup()
+void _bus_teardown(RBT_MemoryBus *bus);
+
+static inline void _bus_mark_code(RBT_MemoryBus *bus, u32 page) {
+	bus->code_mark[page] = true;
+}
+
+// Bookkeeping of a write to a RAM page: marks it dirty and drops the decoded
+// code it holds
+static inline void _bus_note_write(RBT_MemoryBus *bus, const RBT_BusPage *page) {
+	u32 code_page = page->code_page; // RAM pages come first, it's the RAM page too
+	bus->ram.dirty[code_page >> 6] |= 1ull << (code_page & 63);
+
+	if (bus->code_mark[code_page]) {
+		bus->code_mark[code_page] = false;
+		bus->code_gen[code_page] += 1;
+	}
+}
+
+// Returns the host memory behind `size` bytes at `addr` if all of it is readable
+// RAM/ROM laid out contiguously, null otherwise. The pointer stays valid until
+// `map_gen` changes.
+[[nodiscard]] static inline const u8 *_bus_host_range(
+	const RBT_MemoryBus *bus, u32 addr, u32 size
+) {
+	addr &= 0xff'ffff;
+	if (size == 0 || addr + size > 0x100'0000)
+		return nullptr;
+
+	const u8 *base = bus->pages[addr >> _BUS_PAGE_SHIFT].read;
+	if (!base)
+		return nullptr;
+	base += addr & _BUS_PAGE_MASK;
+
+	// Mirrored RAM slots and ROM map distinct pages onto the same host memory
+	u32 offset = _BUS_PAGE_MASK + 1 - (addr & _BUS_PAGE_MASK);
+	for (; offset < size; offset += _BUS_PAGE_MASK + 1) {
+		if (bus->pages[(addr + offset) >> _BUS_PAGE_SHIFT].read != base + offset)
+			return nullptr;
+	}
+
+	return base;
+}
+
+// Host memory fast paths: RAM/ROM accesses are served straight from the page
+// table. They return false when the access must go through the full bus logic
+// (devices, reserved regions, misaligned or page-crossing accesses).
+
+[[nodiscard]] static inline bool _bus_try_read_word(
+	const RBT_MemoryBus *bus, u32 addr, u16 *out
+) {
+	addr &= 0xff'ffff;
+	const u8 *host = bus->pages[addr >> _BUS_PAGE_SHIFT].read;
+	if (!host || (addr & 1))
+		return false;
+
+	u16 raw;
+	memcpy(&raw, &host[addr & _BUS_PAGE_MASK], sizeof(raw));
+	*out = _bus_be16(raw);
+	return true;
+}
+
+[[nodiscard]] static inline bool _bus_try_read_long(
+	const RBT_MemoryBus *bus, u32 addr, u32 *out
+) {
+	addr &= 0xff'ffff;
+	const u8 *host = bus->pages[addr >> _BUS_PAGE_SHIFT].read;
+	if (!host || (addr & 1) || (addr & _BUS_PAGE_MASK) > _BUS_PAGE_MASK - 3)
+		return false;
+
+	u32 raw;
+	memcpy(&raw, &host[addr & _BUS_PAGE_MASK], sizeof(raw));
+	*out = _bus_be32(raw);
+	return true;
+}
+
+[[nodiscard]] static inline bool _bus_try_write_word(
+	RBT_MemoryBus *bus, u32 addr, u16 word
+) {
+	addr &= 0xff'ffff;
+	const RBT_BusPage *page = &bus->pages[addr >> _BUS_PAGE_SHIFT];
+	if (!page->write || (addr & 1))
+		return false;
+
+	u16 raw = _bus_be16(word);
+	memcpy(&page->write[addr & _BUS_PAGE_MASK], &raw, sizeof(raw));
+	_bus_note_write(bus, page);
+	return true;
+}
+
+[[nodiscard]] static inline bool _bus_try_write_long(
+	RBT_MemoryBus *bus, u32 addr, u32 long_
+) {
+	addr &= 0xff'ffff;
+	const RBT_BusPage *page = &bus->pages[addr >> _BUS_PAGE_SHIFT];
+	if (!page->write || (addr & 1) || (addr & _BUS_PAGE_MASK) > _BUS_PAGE_MASK - 3)
+		return false;
+
+	u32 raw = _bus_be32(long_);
+	memcpy(&page->write[addr & _BUS_PAGE_MASK], &raw, sizeof(raw));
+	_bus_note_write(bus, page);
+	return true;
+}
+
+// Full bus logic behind the fast paths, for devices and bus errors
+RBT_ErrorCode _bus_read_word_slow(RBT_MemoryBus *bus, u32 addr, u16 *out);
+RBT_ErrorCode _bus_read_long_slow(RBT_MemoryBus *bus, u32 addr, u32 *out);
+RBT_ErrorCode _bus_write_word_slow(RBT_MemoryBus *bus, u32 addr, u16 word);
+RBT_ErrorCode _bus_write_long_slow(RBT_MemoryBus *bus, u32 addr, u32 long_);
+
+// Same as the rbt_bus_* functions, with the fast path inlined into the caller
+
+static inline RBT_ErrorCode _bus_read_word(RBT_MemoryBus *bus, u32 addr, u16 *out) {
+	if (_bus_try_read_word(bus, addr, out))
+		return RBT_ERR_SUCCESS;
+	return _bus_read_word_slow(bus, addr, out);
+}
+
+static inline RBT_ErrorCode _bus_read_long(RBT_MemoryBus *bus, u32 addr, u32 *out) {
+	if (_bus_try_read_long(bus, addr, out))
+		return RBT_ERR_SUCCESS;
+	return _bus_read_long_slow(bus, addr, out);
+}
+
+static inline RBT_ErrorCode _bus_write_word(RBT_MemoryBus *bus, u32 addr, u16 word) {
+	if (_bus_try_write_word(bus, addr, word))
+		return RBT_ERR_SUCCESS;
+	return _bus_write_word_slow(bus, addr, word);
+}
+
+static inline RBT_ErrorCode _bus_write_long(RBT_MemoryBus *bus, u32 addr, u32 long_) {
+	if (_bus_try_write_long(bus, addr, long_))
+		return RBT_ERR_SUCCESS;
+	return _bus_write_long_slow(bus, addr, long_);
+}
+
+static inline RBT_ErrorCode _bus_load(
 	RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 *out
-);
+) {
+	RBT_ErrorCode err;
+
+	switch (size) {
+	case RBT_SIZE_BYTE: {
+		u8 byte;
+		err = rbt_bus_read_byte(bus, addr, &byte);
+		if (!err)
+			*out = byte;
+		return err;
+	}
+	case RBT_SIZE_WORD: {
+		u16 word;
+		err = _bus_read_word(bus, addr, &word);
+		if (!err)
+			*out = word;
+		return err;
+	}
+	case RBT_SIZE_LONG: return _bus_read_long(bus, addr, out);
+	default:			return RBT_ERR_INVALID_ARGS;
+	}
+
+	unreachable();
+}
+
+static inline RBT_ErrorCode _bus_store(
+	RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 data
+) {
+	switch (size) {
+	case RBT_SIZE_BYTE: return rbt_bus_write_byte(bus, addr, data & 0x00ff);
+	case RBT_SIZE_WORD: return _bus_write_word(bus, addr, data & 0xffff);
+	case RBT_SIZE_LONG: return _bus_write_long(bus, addr, data);
+	default:			return RBT_ERR_INVALID_ARGS;
+	}
+
+	unreachable();
+}
+
+// Host memory behind `size` bytes of the instruction stream at `addr`, moving
+// the fetch window onto its page if needed. Null when the access must go
+// through the full bus logic.
+[[nodiscard]] static inline const u8 *_bus_fetch_host(
+	RBT_MemoryBus *bus, u32 addr, u32 size
+) {
+	addr &= 0xff'ffff;
+	if (addr & 1)
+		return nullptr;
+
+	u32 offset = addr - bus->fetch.base;
+	if (offset <= _BUS_PAGE_MASK + 1 - size)
+		return &bus->fetch.host[offset];
+
+	offset = addr & _BUS_PAGE_MASK;
+	const u8 *host = bus->pages[addr >> _BUS_PAGE_SHIFT].read;
+	if (!host || offset > _BUS_PAGE_MASK + 1 - size)
+		return nullptr;
+
+	bus->fetch = (RBT_FetchWindow) { host, addr - offset };
+	return &host[offset];
+}
+
+// Instruction stream reads: opcodes and extension words
+
+static inline RBT_ErrorCode _bus_fetch_word(RBT_MemoryBus *bus, u32 addr, u16 *out) {
+	const u8 *host = _bus_fetch_host(bus, addr, sizeof(u16));
+	if (!host)
+		return _bus_read_word_slow(bus, addr, out);
+
+	u16 raw;
+	memcpy(&raw, host, sizeof(raw));
+	*out = _bus_be16(raw);
+	return RBT_ERR_SUCCESS;
+}
+
+static inline RBT_ErrorCode _bus_fetch_long(RBT_MemoryBus *bus, u32 addr, u32 *out) {
+	const u8 *host = _bus_fetch_host(bus, addr, sizeof(u32));
+	if (!host)
+		return _bus_read_long_slow(bus, addr, out);
+
+	u32 raw;
+	memcpy(&raw, host, sizeof(raw));
+	*out = _bus_be32(raw);
+	return RBT_ERR_SUCCESS;
+}
+
+// Immediate operands are stored in a full word, bytes use the low half
+static inline RBT_ErrorCode _bus_fetch_imm(
+	RBT_MemoryBus *bus, RBT_OperandSize size, u32 addr, u32 *out
+) {
+	switch (size) {
+	case RBT_SIZE_BYTE:
+	case RBT_SIZE_WORD: {
+		u16 word;
+		RBT_ErrorCode err = _bus_fetch_word(bus, addr, &word);
+		*out = size == RBT_SIZE_BYTE ? (word & 0xff) : word;
+		return err;
+	}
+	case RBT_SIZE_LONG: return _bus_fetch_long(bus, addr, out);
+	default:			return RBT_ERR_INVALID_ARGS;
+	}
+
+	unreachable();
+}
@@ -17,8 +17,10 @@
 
 #include "rbt/cpu/cpu.h"
 
+#include "cpu/bus_internal.h"
 #include "cpu/cpu_internal.h"
 #include "cpu/decode.h"
+#include "cpu/irq_internal.h"
 #include "cpu/timing.h"
 #include "error.h"
 #include "rbt/basic_types.h"
@@ -27,6 +29,7 @@
 #include "rbt/error_codes.h"
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -34,39 +37,337 @@
 #include "cpu/cpu_execute.inc"
 // source-inline-end
 
-static RBT_ErrorCode _cpu_check_exception(RBT_Cpu *cpu) {
+// Labels-as-values are a GNU extension, other compilers get a plain loop.
+// Define RBT_NO_THREADED_DISPATCH to force the portable loop.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(RBT_NO_THREADED_DISPATCH)
+#	define _CPU_THREADED_DISPATCH 1
+#else
+#	define _CPU_THREADED_DISPATCH 0
+#endif
+
+static inline bool _cpu_interrupt_pending(const RBT_Cpu *cpu) {
+	u32 lines = atomic_load_explicit(&cpu->irq_lines, memory_order_acquire);
+	if (!lines)
+		return false;
+	return _cpu_irq_level(lines) > _sr_interrupt_priority(cpu->state.sr)
+		|| (lines & _CPU_IRQ_NMI_EDGE);
+}
+
+// Vector number for an interrupt at `level`. Levels asserted by the controller
+// go through its IACK cycle, the others are autovectored.
+static u8 _cpu_interrupt_vector(RBT_Cpu *cpu, u32 lines, u8 level) {
+	if (level == RBT_IRQ_LEVEL_NMI) {
+		atomic_fetch_and_explicit(
+			&cpu->irq_lines, ~(u32)_CPU_IRQ_NMI_EDGE, memory_order_relaxed
+		);
+	}
+
+	if (cpu->irq && ((lines >> _CPU_IRQ_CTRL_SHIFT) & (1u << level)))
+		return _irq_acknowledge(cpu->irq, level);
+	return _VEC_AUTOVEC_L1 + (level - 1);
+}
+
+// Resolves what an executor needs from `instr` ahead of time
+static void _cpu_pack_instruction(
+	const RBT_Cpu *cpu, const RBT_Instruction *instr, RBT_PackedInstr *out
+) {
+	*out = (RBT_PackedInstr) {
+		.start_pc = instr->start_pc,
+		.opcode = instr->words[0],
+		.aux = (instr->aux.mode == RBT_EA_IMMEDIATE) ? (u16)instr->aux.imm : 0,
+		.mnemonic = (u8)instr->mnemonic,
+		.size = (u8)instr->size,
+		.len = instr->len,
+		.ea_cycles = _timing_ea_cycles(instr, cpu->cfg.model),
+	};
+	_ea_pack(&instr->src, &out->src);
+	_ea_pack(&instr->dst, &out->dst);
+}
+
+// Returns the packed instruction at `pc`, decoding it only on a cache miss.
+// Instructions outside RAM/ROM, or crossing a code page, are never cached.
+static RBT_ErrorCode _cpu_fetch_instruction(
+	RBT_Cpu *cpu, u32 pc, const RBT_PackedInstr **out
+) {
+	pc &= 0xff'ffff;
+
+	RBT_ICache *cache = &cpu->icache;
+	RBT_ICacheEntry *entry = &cache->entries[(pc >> 1) & (_CPU_ICACHE_SIZE - 1)];
+
+	u32 page = _bus_code_page(cpu->bus, pc);
+	if (page == _BUS_CODE_PAGE_NONE) {
+		cache->misses += 1;
+		*out = &cpu->current_packed;
+
+		RBT_ErrorCode err = _decode_instruction(cpu->bus, pc, &cpu->current_instr);
+		if (!err)
+			_cpu_pack_instruction(cpu, &cpu->current_instr, &cpu->current_packed);
+		return err;
+	}
+
+	// Code pages are fixed per address, the tag alone tells which one to check
+	if (entry->instr.start_pc == pc && entry->page_gen == cpu->bus->code_gen[page]) {
+		cache->hits += 1;
+		*out = &entry->instr;
+		return RBT_ERR_SUCCESS;
+	}
+
+	cache->misses += 1;
+	RBT_ErrorCode err = _decode_instruction(cpu->bus, pc, &cpu->current_instr);
+	if (err)
+		return err;
+
+	u32 last_page = _bus_code_page(cpu->bus, pc + cpu->current_instr.len - 1);
+	if (last_page != page) {
+		*out = &cpu->current_packed;
+		_cpu_pack_instruction(cpu, &cpu->current_instr, &cpu->current_packed);
+		return RBT_ERR_SUCCESS;
+	}
+
+	*out = &entry->instr;
+	_cpu_pack_instruction(cpu, &cpu->current_instr, &entry->instr);
+	entry->page_gen = cpu->bus->code_gen[page];
+	_bus_mark_code(cpu->bus, page);
+	return RBT_ERR_SUCCESS;
+}
+
+// Special status word of the MC68010 format $8 frame, and the MC68000 group 0
+// status word
+enum {
+	_CPU_SSW_IF = 1u << 13,	// Instruction fetch
+	_CPU_SSW_DF = 1u << 12,	// Data fault
+	_CPU_SSW_RW = 1u << 8,	// Read cycle
+	_CPU_STATUS_RW = 1u << 4,
+
+	_CPU_FC_USER_DATA = 1,
+	_CPU_FC_USER_PROGRAM = 2,
+	_CPU_FC_SUPERVISOR = 4, // Added to the user codes
+};
+
+[[nodiscard]] static RBT_TimingException _cpu_exception_kind(RBT_CpuVector vec) {
+	switch (vec) {
+	case _VEC_BUS_ERROR:  return _TIMING_EXC_BUS_ERROR;
+	case _VEC_ADDR_ERROR: return _TIMING_EXC_ADDR_ERROR;
+	case _VEC_ILLEGAL:
+	case _VEC_LINE_A:
+	case _VEC_LINE_F:	  return _TIMING_EXC_ILLEGAL;
+	case _VEC_ZERO_DIV:	  return _TIMING_EXC_ZERO_DIV;
+	case _VEC_CHK:		  return _TIMING_EXC_CHK;
+	case _VEC_TRAPV:	  return _TIMING_EXC_TRAPV;
+	case _VEC_PRIVILEGE:  return _TIMING_EXC_PRIVILEGE;
+	case _VEC_TRACE:	  return _TIMING_EXC_TRACE;
+	case _VEC_FMT_ERROR:  return _TIMING_EXC_FMT_ERROR;
+	default:			  break;
+	}
+
+	if (vec >= _VEC_TRAP_0 && vec <= _VEC_TRAP_F)
+		return _TIMING_EXC_TRAP;
+	return _TIMING_EXC_INTERRUPT; // Autovectors and vectors from the IACK cycle
+}
+
+// Caches the host memory behind the vector table at the current VBR
+static void _cpu_resolve_vectors(RBT_Cpu *cpu) {
+	cpu->vectors_vbr = cpu->state.vbr;
+	cpu->vectors = nullptr;
+	if (cpu->bus) {
+		cpu->vectors_map_gen = cpu->bus->map_gen;
+		cpu->vectors = _bus_host_range(cpu->bus, cpu->state.vbr, _CPU_VECTOR_TABLE_SIZE);
+	}
+}
+
+static RBT_ErrorCode _cpu_read_vector(RBT_Cpu *cpu, RBT_CpuVector vec, u32 *out) {
+	// MOVEC may have moved the table since it was resolved, or a ROM swapped in
+	if (cpu->state.vbr != cpu->vectors_vbr || cpu->bus->map_gen != cpu->vectors_map_gen)
+		_cpu_resolve_vectors(cpu);
+
+	if (cpu->vectors) {
+		u32 raw;
+		memcpy(&raw, &cpu->vectors[(u32)vec * 4], sizeof(raw));
+		*out = _bus_be32(raw);
+		return RBT_ERR_SUCCESS;
+	}
+
+	return _bus_read_long(cpu->bus, _get_vector_address(&cpu->state, vec), out);
+}
+
+// Bus and address errors abort the access and leave a group 0 exception pending.
+// Another one before the handler of the first starts halts the CPU. Other errors
+// are returned as they are.
+static RBT_ErrorCode _cpu_fault(
+	RBT_Cpu *cpu, RBT_ErrorCode err, bool is_fetch, u16 opcode
+) {
+	if (err != RBT_ERR_MEM_BUS_ERROR && err != RBT_ERR_MEM_ADDR_ERROR)
+		return err;
+
+	const RBT_BusFault *fault = &cpu->bus->fault;
+	if (cpu->is_faulting) {
+		cpu->is_halted = true;
+		_push_error(RBT_ERR_CPU_HALTED, "Double bus fault at: 0x%06x", fault->addr);
+		return RBT_ERR_CPU_HALTED;
+	}
+
+	u8 function_code = is_fetch ? _CPU_FC_USER_PROGRAM : _CPU_FC_USER_DATA;
+	if (cpu->state.sr & RBT_SR_SUPERVISOR)
+		function_code += _CPU_FC_SUPERVISOR;
+
+	cpu->fault = (RBT_CpuFaultInfo) {
+		.addr = fault->addr,
+		.opcode = opcode,
+		.function_code = function_code,
+		.is_read = fault->is_read,
+		.is_fetch = is_fetch,
+	};
+
+	if (err == RBT_ERR_MEM_ADDR_ERROR)
+		cpu->pending.address_error = true;
+	else
+		cpu->pending.bus_error = true;
+	return RBT_ERR_SUCCESS;
+}
+
+// Lays out the stack frame of `vec` from the lowest address up, returns its
+// length in words.
+static u32 _cpu_build_frame(
+	const RBT_Cpu *cpu, RBT_CpuVector vec, u16 sr, u32 pc, u16 *frame
+) {
+	const RBT_CpuFaultInfo *fault = &cpu->fault;
+	bool is_group0 = vec == _VEC_BUS_ERROR || vec == _VEC_ADDR_ERROR;
+
+	if (cpu->cfg.model != RBT_CPU_M68010) {
+		if (!is_group0) {
+			frame[0] = sr;
+			frame[1] = pc >> 16;
+			frame[2] = pc & 0xffff;
+			return _CPU_FRAME_SHORT / 2;
+		}
+
+		frame[0] = (fault->is_read ? _CPU_STATUS_RW : 0) | fault->function_code;
+		frame[1] = fault->addr >> 16;
+		frame[2] = fault->addr & 0xffff;
+		frame[3] = fault->opcode; // Instruction register
+		frame[4] = sr;
+		frame[5] = pc >> 16;
+		frame[6] = pc & 0xffff;
+		return _CPU_FRAME_GROUP0 / 2;
+	}
+
+	frame[0] = sr;
+	frame[1] = pc >> 16;
+	frame[2] = pc & 0xffff;
+	frame[3] = (u16)vec * 4; // Format $0
+	if (!is_group0)
+		return _CPU_FRAME_FMT0 / 2;
+
+	// Data buffers and internal state aren't modeled, RTE never reruns the cycle
+	memset(&frame[4], 0, _CPU_FRAME_FMT8 - _CPU_FRAME_FMT0);
+	frame[3] |= 0x8 << _CPU_FRAME_FMT_SHIFT;
+	frame[4] = (fault->is_fetch ? _CPU_SSW_IF : _CPU_SSW_DF)
+			 | (fault->is_read ? _CPU_SSW_RW : 0) | fault->function_code;
+	frame[5] = fault->addr >> 16;
+	frame[6] = fault->addr & 0xffff;
+	frame[12] = fault->opcode; // Instruction input buffer
+	return _CPU_FRAME_FMT8 / 2;
+}
+
+// Switches to supervisor mode, stacks the frame of `vec` and jumps to its
+// handler. The processing time is added to the current step.
+static RBT_ErrorCode _cpu_enter_exception(RBT_Cpu *cpu, RBT_CpuVector vec) {
 	assert(cpu);
+	assert(cpu->bus);
 
-	// Group 0 - Exception Processing
-	// 0: Reset - asserted at startup
-	// 1: Address Error - Thrown by bus
-	// 2: Bus Error - Thrown by bus
+	// The stacked status register must hold the real flags
+	_cpu_sync_ccr(cpu);
+
+	u16 sr = cpu->state.sr;
+	u32 pc = cpu->state.pc;
+	if (vec == _VEC_BUS_ERROR || vec == _VEC_ADDR_ERROR)
+		cpu->is_faulting = true;
+	cpu->is_stopped = false;
+	cpu->is_idle = false;
+
+	_cpu_write_sr(cpu, (sr | RBT_SR_SUPERVISOR) & ~RBT_SR_TRACE1);
+	cpu->timing.exception_cycles += _exception_timing(
+		_cpu_exception_kind(vec), cpu->cfg.model
+	);
+
+	u16 frame[_CPU_FRAME_FMT8 / 2];
+	u32 count = _cpu_build_frame(cpu, vec, sr, pc, frame);
+
+	// Stack grows downwards, the frame is written from the new top
+	u32 sp = cpu->state.gpr.sp - (count * 2);
+	_cpu_set_sp(cpu, sp);
+
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	for (u32 i = 0; i < count && !err; i += 1) {
+		err = _bus_write_word(cpu->bus, sp + (i * 2), frame[i]);
+	}
+
+	if (!err)
+		err = _cpu_read_vector(cpu, vec, &pc);
+	if (err)
+		return _cpu_fault(cpu, err, false, 0);
+
+	cpu->state.pc = pc;
+	return RBT_ERR_SUCCESS;
+}
+
+RBT_ErrorCode _cpu_raise_exception(RBT_Cpu *cpu, RBT_CpuVector vec) {
+	assert(cpu);
+
+	cpu->timing.trapped = true;
+	return _cpu_enter_exception(cpu, vec);
+}
+
+// Group 0: Bus and address errors left by the last access
+static RBT_ErrorCode _cpu_take_fault(RBT_Cpu *cpu) {
 	if (cpu->pending.address_error) {
 		cpu->pending.address_error = false;
-		return _cpu_raise_exception(cpu, _VEC_ADDR_ERROR);
+		return _cpu_enter_exception(cpu, _VEC_ADDR_ERROR);
 	}
 	if (cpu->pending.bus_error) {
 		cpu->pending.bus_error = false;
-		return _cpu_raise_exception(cpu, _VEC_BUS_ERROR);
+		return _cpu_enter_exception(cpu, _VEC_BUS_ERROR);
+	}
+
+	return RBT_ERR_SUCCESS;
+}
+
+static RBT_ErrorCode _cpu_check_exception(RBT_Cpu *cpu) {
+	assert(cpu);
+
+	// Group 0 - Exception Processing
+	// 0: Reset - asserted at startup
+	// 1: Address Error - Thrown by bus
+	// 2: Bus Error - Thrown by bus
+	// The aborted instruction is not traced
+	if (cpu->pending.address_error || cpu->pending.bus_error) {
+		cpu->pending.trace = false;
+		return _cpu_take_fault(cpu);
 	}
 
 	// Group 1 - Exception Processing
-	// 3: Trace
+	// 3: Trace - After an instruction that started with T1 set
 	// 4: Interrupt
 	// 5: Illegal - Check at decode or Instruction
 	// 6: Privilege - Check at execution
-	if (cpu->state.sr.trace1) {
-		return _cpu_raise_exception(cpu, _VEC_TRACE);
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	if (cpu->pending.trace) {
+		cpu->pending.trace = false;
+		err = _cpu_enter_exception(cpu, _VEC_TRACE);
+		if (err)
+			return err;
 	}
-	if (cpu->pending.interrupt
-		&& cpu->pending.interrupt_level > cpu->state.sr.interrupt_priority) {
-		RBT_CpuVector autovec = _VEC_AUTOVEC_L1 + (cpu->pending.interrupt_level - 1);
-		RBT_ErrorCode err = _cpu_raise_exception(cpu, autovec);
+	if (_cpu_interrupt_pending(cpu)) {
+		u32 lines = atomic_load_explicit(&cpu->irq_lines, memory_order_acquire);
+		u8 level = _cpu_irq_level(lines);
+		err = _cpu_enter_exception(
+			cpu, (RBT_CpuVector)_cpu_interrupt_vector(cpu, lines, level)
+		);
 		if (err)
 			return err;
 
-		cpu->pending.interrupt = false;
-		cpu->state.sr.interrupt_priority = cpu->pending.interrupt_level;
+		cpu->state.sr &= ~RBT_SR_INTERRUPT;
+		cpu->state.sr |= level << RBT_SR_INTERRUPT_SHIFT;
 	}
 
 	// Group 2 - Exception Processing
@@ -74,69 +375,43 @@ static RBT_ErrorCode _cpu_check_exception(RBT_Cpu *cpu) {
 	// 8: CHK - Instruction
 	// 9: Zero Div - Instruction
 
-	return RBT_ERR_SUCCESS;
-}
-
-RBT_ErrorCode _cpu_raise_exception(RBT_Cpu *cpu, RBT_CpuVector vec) {
-	assert(cpu);
-
-	(void)cpu;
-	(void)vec;
-
-	return RBT_ERR_SUCCESS;
+	// Stacking any of the above may have faulted
+	return _cpu_take_fault(cpu);
 }
 
 RBT_ErrorCode _stack_push_word(RBT_Cpu *cpu, u16 word) {
 	assert(cpu);
 	assert(cpu->bus);
 
-	u32 *sp;
-	if (cpu->state.sr.supervisor)
-		sp = &cpu->state.ssp;
-	else
-		sp = &cpu->state.usp;
-
 	// Stack grows downwards
-	*sp -= 2; // Word is 2-bytes
-	cpu->state.gpr.sp = *sp;
+	u32 sp = cpu->state.gpr.sp - 2; // Word is 2-bytes
+	_cpu_set_sp(cpu, sp);
 
-	return rbt_bus_write_word(cpu->bus, *sp, word);
+	return _bus_write_word(cpu->bus, sp, word);
 }
 
 RBT_ErrorCode _stack_push_long(RBT_Cpu *cpu, u32 long_) {
 	assert(cpu);
 	assert(cpu->bus);
 
-	u32 *sp;
-	if (cpu->state.sr.supervisor)
-		sp = &cpu->state.ssp;
-	else
-		sp = &cpu->state.usp;
-
 	// Stack grows downwards
-	*sp -= 4; // Long is 4-bytes
-	cpu->state.gpr.sp = *sp;
+	u32 sp = cpu->state.gpr.sp - 4; // Long is 4-bytes
+	_cpu_set_sp(cpu, sp);
 
-	return rbt_bus_write_long(cpu->bus, *sp, long_);
+	return _bus_write_long(cpu->bus, sp, long_);
 }
 
 RBT_ErrorCode _stack_pop_word(RBT_Cpu *cpu, u16 *out) {
 	assert(cpu);
 	assert(cpu->bus);
 
-	u32 *sp;
-	if (cpu->state.sr.supervisor)
-		sp = &cpu->state.ssp;
-	else
-		sp = &cpu->state.usp;
-
-	RBT_ErrorCode err = rbt_bus_read_word(cpu->bus, *sp, out);
+	u32 sp = cpu->state.gpr.sp;
+	RBT_ErrorCode err = _bus_read_word(cpu->bus, sp, out);
 	if (err)
 		return err;
 
 	// Stack grows downwards
-	*sp += 2; // Word is 2-bytes
-	cpu->state.gpr.sp = *sp;
+	_cpu_set_sp(cpu, sp + 2); // Word is 2-bytes
 	return RBT_ERR_SUCCESS;
 }
 
@@ -144,22 +419,79 @@ RBT_ErrorCode _stack_pop_long(RBT_Cpu *cpu, u32 *out) {
 	assert(cpu);
 	assert(cpu->bus);
 
-	u32 *sp;
-	if (cpu->state.sr.supervisor)
-		sp = &cpu->state.ssp;
-	else
-		sp = &cpu->state.usp;
-
-	RBT_ErrorCode err = rbt_bus_read_long(cpu->bus, *sp, out);
+	u32 sp = cpu->state.gpr.sp;
+	RBT_ErrorCode err = _bus_read_long(cpu->bus, sp, out);
 	if (err)
 		return err;
 
 	// Stack grows downwards
-	*sp += 4; // Long is 4-bytes
-	cpu->state.gpr.sp = *sp;
+	_cpu_set_sp(cpu, sp + 4); // Long is 4-bytes
 	return RBT_ERR_SUCCESS;
 }
 
+enum {
+	_CPU_IDLE_LOOP_MAX = 16, // Longest idle loop body, in bytes
+};
+
+// Whether `instr` leaves everything but the condition codes and the PC alone
+static bool _cpu_is_idle_instruction(const RBT_Instruction *instr) {
+	u32 modes = instr->src.mode | instr->dst.mode;
+	if (modes & (RBT_EA_INDIRECT_POSTINC | RBT_EA_INDIRECT_PREDEC))
+		return false;
+
+	switch (instr->mnemonic) {
+	case RBT_OP_BTST:
+	case RBT_OP_CMP:
+	case RBT_OP_CMPA:
+	case RBT_OP_CMPI:
+	case RBT_OP_TST:
+	case RBT_OP_BRA:
+	case RBT_OP_Bcc:
+	case RBT_OP_NOP: return true;
+	default:         return false;
+	}
+}
+
+void _cpu_detect_idle_loop(RBT_Cpu *cpu, u32 pc, u32 target) {
+	assert(cpu);
+
+	// Traced and hooked code has to see every instruction
+	if ((cpu->state.sr & RBT_SR_TRACE1) || cpu->cfg.hook)
+		return;
+
+	// Only RAM/ROM code can be told apart from its last visit
+	u32 page = _bus_code_page(cpu->bus, pc);
+	if (page == _BUS_CODE_PAGE_NONE)
+		return;
+
+	u32 gen = cpu->bus->code_gen[page];
+	if (cpu->idle_branch_pc == pc && cpu->idle_branch_gen == gen) {
+		cpu->is_idle = cpu->idle_branch_ok;
+		return;
+	}
+
+	// The body is decoded again rather than looked up, the cache entries may
+	// hold the branch itself
+	target &= 0xff'ffff;
+	u32 addr = target;
+	bool is_idle = pc - target <= _CPU_IDLE_LOOP_MAX
+				&& _bus_code_page(cpu->bus, target) == page;
+	while (is_idle && addr < pc) {
+		RBT_Instruction instr;
+		if (_decode_instruction(cpu->bus, addr, &instr))
+			is_idle = false;
+		else if (!_cpu_is_idle_instruction(&instr))
+			is_idle = false;
+		else
+			addr += instr.len;
+	}
+
+	cpu->idle_branch_pc = pc;
+	cpu->idle_branch_gen = gen;
+	cpu->idle_branch_ok = is_idle && addr == pc;
+	cpu->is_idle = cpu->idle_branch_ok;
+}
+
 RBT_Cpu *rbt_create_cpu(const RBT_CpuConfig *config) {
 	RBT_Cpu *cpu = malloc(sizeof(RBT_Cpu));
 	if (!cpu) {
@@ -168,10 +500,7 @@ RBT_Cpu *rbt_create_cpu(const RBT_CpuConfig *config) {
 		);
 		return nullptr;
 	}
-	memset(cpu, 0, sizeof(RBT_Cpu));
-	cpu->cfg.model = config ? config->model : RBT_CPU_M68000;
-	cpu->cfg.hook = config ? config->hook : nullptr;
-	cpu->cfg.userdata = config ? config->userdata : nullptr;
+	_cpu_setup(cpu, config);
 
 	return cpu;
 }
@@ -179,12 +508,77 @@ RBT_Cpu *rbt_create_cpu(const RBT_CpuConfig *config) {
 void rbt_destroy_cpu(RBT_Cpu *cpu) {
 	if (!cpu)
 		return;
+	_cpu_teardown(cpu);
 	free(cpu);
 }
 
+void _cpu_setup(RBT_Cpu *cpu, const RBT_CpuConfig *config) {
+	assert(cpu);
+
+	memset(cpu, 0, sizeof(RBT_Cpu));
+	cpu->cfg.model = config ? config->model : RBT_CPU_M68000;
+	cpu->cfg.skip_idle_loops = config ? config->skip_idle_loops : false;
+	cpu->cfg.translate_blocks = config ? config->translate_blocks : false;
+	cpu->cfg.hook = config ? config->hook : nullptr;
+	cpu->cfg.userdata = config ? config->userdata : nullptr;
+
+	rbt_cpu_flush_cache(cpu);
+}
+
+void _cpu_teardown(RBT_Cpu *cpu) {
+	assert(cpu);
+
+	if (cpu->irq)
+		cpu->irq->cpu = nullptr;
+}
+
 void rbt_cpu_attach_bus(RBT_Cpu *cpu, RBT_MemoryBus *bus) {
 	assert(cpu);
 	cpu->bus = bus;
+	rbt_cpu_flush_cache(cpu);
+	_cpu_resolve_vectors(cpu);
+}
+
+void rbt_cpu_attach_irq_controller(RBT_Cpu *cpu, RBT_IrqController *irq) {
+	assert(cpu);
+
+	if (irq && irq->cpu)
+		rbt_cpu_attach_irq_controller(irq->cpu, nullptr);
+	if (cpu->irq)
+		cpu->irq->cpu = nullptr;
+	_cpu_drive_irq_lines(cpu, _CPU_IRQ_LEVEL_MASK << _CPU_IRQ_CTRL_SHIFT, 0);
+
+	cpu->irq = irq;
+	if (irq) {
+		irq->cpu = cpu;
+		irq->lines = 0; // Drive whatever is raised right now
+		_irq_update_lines(irq);
+	}
+}
+
+void rbt_cpu_set_irq_line(RBT_Cpu *cpu, u8 level, bool asserted) {
+	assert(cpu);
+	assert(level >= 1 && level <= 7);
+
+	u32 line = 1u << (level + _CPU_IRQ_HOST_SHIFT);
+	_cpu_drive_irq_lines(cpu, line, asserted ? line : 0);
+}
+
+void _cpu_drive_irq_lines(RBT_Cpu *cpu, u32 mask, u32 lines) {
+	assert(cpu);
+	assert((lines & ~mask) == 0);
+
+	u32 old = atomic_load_explicit(&cpu->irq_lines, memory_order_relaxed);
+	u32 new;
+	do {
+		new = (old & ~mask) | lines;
+		if (_cpu_irq_level(new) == RBT_IRQ_LEVEL_NMI
+			&& _cpu_irq_level(old) != RBT_IRQ_LEVEL_NMI) {
+			new |= _CPU_IRQ_NMI_EDGE;
+		}
+	} while (!atomic_compare_exchange_weak_explicit(
+		&cpu->irq_lines, &old, new, memory_order_release, memory_order_relaxed
+	));
 }
 
 RBT_ErrorCode rbt_cpu_reset(RBT_Cpu *cpu) {
@@ -192,28 +586,133 @@ RBT_ErrorCode rbt_cpu_reset(RBT_Cpu *cpu) {
 	assert(cpu->bus);
 
 	memset(&cpu->state, 0, sizeof(RBT_CpuState));
+	memset(&cpu->ccr, 0, sizeof(RBT_LazyCcr));
+	memset(&cpu->pending, 0, sizeof(RBT_CpuPendingException));
 	cpu->state.vbr = 0;
+	cpu->is_faulting = false;
+	cpu->is_stopped = false;
+	cpu->is_idle = false;
+	_cpu_resolve_vectors(cpu);
 
-	u32 ssp_vec_addr = _get_vector_address(&cpu->state, _VEC_INITIAL_SSP);
-	u32 pc_vec_addr = _get_vector_address(&cpu->state, _VEC_INITIAL_PC);
-
-	RBT_ErrorCode err = rbt_bus_read_long(cpu->bus, ssp_vec_addr, &cpu->state.ssp);
+	RBT_ErrorCode err = _cpu_read_vector(cpu, _VEC_INITIAL_SSP, &cpu->state.ssp);
 	if (err)
 		return err;
 
-	err = rbt_bus_read_long(cpu->bus, pc_vec_addr, &cpu->state.pc);
+	err = _cpu_read_vector(cpu, _VEC_INITIAL_PC, &cpu->state.pc);
 	if (err)
 		return err;
 
-	cpu->state.sr.supervisor = true;	  // CPU is forced into supervisor
-	cpu->state.sr.trace1 = false;		  // Disable tracing
-	cpu->state.sr.interrupt_priority = 7; // Interrupt mask is set to 7
+	// CPU is forced into supervisor, tracing is disabled and the interrupt mask
+	// is set to 7
+	cpu->state.sr = RBT_SR_SUPERVISOR | RBT_SR_INTERRUPT;
 
 	// Mirror SSP into A7 since we are in supervisor mode
 	cpu->state.gpr.sp = cpu->state.ssp;
 	return RBT_ERR_SUCCESS;
 }
 
+// Takes pending exceptions and fetches the instruction at PC. Bus and address
+// errors on the fetch become group 0 exceptions, taken right away; undecodable
+// opcodes run as ILLEGAL. Returns RBT_ERR_CPU_STOPPED instead while the CPU is
+// stopped or idle.
+static inline RBT_ErrorCode _cpu_next_instruction(
+	RBT_Cpu *cpu, const RBT_PackedInstr **out
+) {
+	for (;;) {
+		RBT_ErrorCode err = _cpu_check_exception(cpu);
+		if (err)
+			return err;
+
+		// Only an exception gets the CPU out of STOP; an idle loop runs again
+		// once the caller has moved the devices forward
+		if (cpu->is_stopped || cpu->is_idle) {
+			cpu->is_idle = false;
+			return RBT_ERR_CPU_STOPPED;
+		}
+
+		err = _cpu_fetch_instruction(cpu, cpu->state.pc, out);
+		if (err == RBT_ERR_DECODE_ILLEGAL || err == RBT_ERR_DECODE_ILLEGAL_EA) {
+			u32 pc = cpu->state.pc & 0xff'ffff;
+			cpu->current_instr = (RBT_Instruction) {
+				.mnemonic = RBT_OP_ILLEGAL,
+				.start_pc = pc,
+				.len = 2,
+				.word_count = 1,
+			};
+			cpu->current_packed = (RBT_PackedInstr) {
+				.start_pc = pc,
+				.mnemonic = RBT_OP_ILLEGAL,
+				.len = 2,
+			};
+			*out = &cpu->current_packed;
+			err = RBT_ERR_SUCCESS;
+		}
+
+		if (!err) {
+			cpu->is_faulting = false;
+			cpu->pending.trace = cpu->state.sr & RBT_SR_TRACE1;
+			return RBT_ERR_SUCCESS;
+		}
+
+		err = _cpu_fault(cpu, err, true, 0);
+		if (err)
+			return err;
+	}
+}
+
+// The cache only keeps the packed form: decodes `instr` again for the debug hook
+static RBT_ErrorCode _cpu_call_hook(RBT_Cpu *cpu, const RBT_PackedInstr *instr) {
+	RBT_Instruction *view = &cpu->current_instr;
+	if (instr->mnemonic == RBT_OP_ILLEGAL
+		|| _decode_instruction(cpu->bus, instr->start_pc, view)) {
+		*view = (RBT_Instruction) {
+			.mnemonic = RBT_OP_ILLEGAL,
+			.start_pc = instr->start_pc,
+			.len = 2,
+			.words = { instr->opcode },
+			.word_count = 1,
+		};
+	}
+
+	_cpu_sync_ccr(cpu); // The hook may inspect the CPU state
+	return cpu->cfg.hook(cpu->cfg.userdata, view);
+}
+
+// Executes a single instruction, the debug hook gets to see it before it runs.
+// A copy of the instruction goes to `record` if not null.
+static inline RBT_ErrorCode _cpu_execute_next(
+	RBT_Cpu *cpu, u16 *out_cycles, RBT_PackedInstr *record
+) {
+	const RBT_PackedInstr *instr;
+	RBT_ErrorCode err = _cpu_next_instruction(cpu, &instr);
+	if (err)
+		return err;
+	if (record)
+		*record = *instr;
+
+	if (cpu->cfg.hook) {
+		err = _cpu_call_hook(cpu, instr);
+		if (err)
+			return err;
+	}
+
+	// Increment PC before executing next instruction
+	cpu->state.pc += instr->len;
+
+	err = _cpu_execute(instr, cpu);
+	if (err) {
+		err = _cpu_fault(cpu, err, false, instr->opcode);
+		if (err)
+			return err;
+	}
+
+	*out_cycles = _timing_step_cycles(
+		instr->mnemonic, instr->size, instr->ea_cycles, &cpu->timing, cpu->cfg.model
+	);
+
+	return RBT_ERR_SUCCESS;
+}
+
 RBT_ErrorCode rbt_cpu_step(RBT_Cpu *cpu, u16 *out_cycles) {
 	assert(cpu);
 	assert(cpu->bus);
@@ -221,26 +720,466 @@ RBT_ErrorCode rbt_cpu_step(RBT_Cpu *cpu, u16 *out_cycles) {
 	if (cpu->is_halted)
 		return RBT_ERR_CPU_HALTED;
 
-	RBT_ErrorCode err = _cpu_check_exception(cpu);
-	if (err)
-		return err;
+	// Single steps run idle loops like any other code
+	cpu->is_idle = false;
 
-	err = _decode_instruction(cpu->bus, cpu->state.pc, &cpu->current_instr);
+	const u32 *pc_source = _err_set_pc_source(&cpu->state.pc);
+	u16 cycles = 0;
+	RBT_ErrorCode err = _cpu_execute_next(cpu, &cycles, nullptr);
+	_cpu_sync_ccr(cpu); // Callers read the flags straight from the state
+	_err_set_pc_source(pc_source);
 	if (err)
 		return err;
 
-	RBT_Instruction *instr = &cpu->current_instr;
+	if (out_cycles)
+		*out_cycles = cycles;
+	return RBT_ERR_SUCCESS;
+}
 
-	// Increment PC before executing next instruction
-	cpu->state.pc += instr->len;
+// A stopped or idle CPU has nothing to do until an interrupt or a device event,
+// which can't happen before the budget runs out: skip straight to its end
+static inline void _cpu_skip_idle(u32 cycle_budget, u32 *cycles, RBT_ErrorCode *err) {
+	if (*err != RBT_ERR_CPU_STOPPED)
+		return;
 
-	err = _cpu_execute(instr, cpu);
-	if (err)
+	*err = RBT_ERR_SUCCESS;
+	if (*cycles < cycle_budget)
+		*cycles = cycle_budget;
+}
+
+#if _CPU_THREADED_DISPATCH
+// Threaded code: every handler gets its own copy of the retire/fetch sequence and
+// jumps straight into the next handler, so each one has its own indirect branch to
+// predict instead of all of them sharing a single call site.
+#	pragma GCC diagnostic push
+#	pragma GCC diagnostic ignored "-Wpedantic" // Labels as values
+static RBT_ErrorCode _cpu_run(RBT_Cpu *cpu, u32 cycle_budget, u32 *out_cycles) {
+	static void *const handlers[RBT_OP_LINEF + 1] = {
+#	define _CPU_OP_LABEL(mnemonic, handler) [RBT_OP_##mnemonic] = &&op_##mnemonic,
+		_CPU_OP_LIST(_CPU_OP_LABEL)
+#	undef _CPU_OP_LABEL
+		[RBT_OP_LINEA] = &&op_LINEA,
+		[RBT_OP_LINEF] = &&op_LINEF,
+	};
+
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	const RBT_PackedInstr *instr = nullptr;
+	u32 cycles = 0;
+	cpu->is_idle = false; // Devices may have moved since the last run
+
+#	define _CPU_RETIRE()                                                      \
+		do {                                                                  \
+			if (err) {                                                        \
+				err = _cpu_fault(cpu, err, false, instr->opcode);             \
+				if (err)                                                      \
+					goto done;                                                \
+			}                                                                 \
+			cycles += _timing_step_cycles(                                    \
+				instr->mnemonic, instr->size, instr->ea_cycles, &cpu->timing, \
+				cpu->cfg.model                                                \
+			);                                                                \
+			if (_cpu_interrupt_pending(cpu))                                  \
+				goto done;                                                    \
+		} while (0)
+
+#	define _CPU_DISPATCH()                                    \
+		do {                                                   \
+			if (cycles >= cycle_budget)                        \
+				goto done;                                     \
+			if (cpu->is_halted) {                              \
+				err = RBT_ERR_CPU_HALTED;                      \
+				goto done;                                     \
+			}                                                  \
+			err = _cpu_next_instruction(cpu, &instr);          \
+			if (err)                                           \
+				goto done;                                     \
+			if (cpu->cfg.hook) {                               \
+				err = _cpu_call_hook(cpu, instr);              \
+				if (err)                                       \
+					goto done;                                 \
+			}                                                  \
+			cpu->state.pc += instr->len;                       \
+			goto *handlers[instr->mnemonic];                   \
+		} while (0)
+
+	_CPU_DISPATCH();
+
+#	define _CPU_OP_BODY(mnemonic, handler) \
+	op_##mnemonic:                          \
+		err = handler(instr, cpu);          \
+		_CPU_RETIRE();                      \
+		_CPU_DISPATCH();
+	_CPU_OP_LIST(_CPU_OP_BODY)
+#	undef _CPU_OP_BODY
+
+op_LINEA:
+	err = _cpu_reject(instr, cpu, _VEC_LINE_A);
+	_CPU_RETIRE();
+	_CPU_DISPATCH();
+
+op_LINEF:
+	err = _cpu_reject(instr, cpu, _VEC_LINE_F);
+	_CPU_RETIRE();
+	_CPU_DISPATCH();
+
+#	undef _CPU_DISPATCH
+#	undef _CPU_RETIRE
+
+done:
+	_cpu_skip_idle(cycle_budget, &cycles, &err);
+	*out_cycles = cycles;
+	return err;
+}
+#	pragma GCC diagnostic pop
+#else
+static RBT_ErrorCode _cpu_run(RBT_Cpu *cpu, u32 cycle_budget, u32 *out_cycles) {
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	u32 cycles = 0;
+	cpu->is_idle = false; // Devices may have moved since the last run
+
+	while (cycles < cycle_budget) {
+		if (cpu->is_halted) {
+			err = RBT_ERR_CPU_HALTED;
+			break;
+		}
+
+		u16 instr_cycles = 0;
+		err = _cpu_execute_next(cpu, &instr_cycles, nullptr);
+		if (err)
+			break;
+		cycles += instr_cycles;
+
+		// Give control back so the caller can observe the interrupt before it's taken
+		if (_cpu_interrupt_pending(cpu))
+			break;
+	}
+
+	_cpu_skip_idle(cycle_budget, &cycles, &err);
+	*out_cycles = cycles;
+	return err;
+}
+#endif
+
+// Whether the block has to end after `instr`: it may leave the straight line, or
+// change what the next instruction runs under
+static bool _cpu_ends_block(const RBT_PackedInstr *instr) {
+	if (instr->dst.mode == _EA_SR)
+		return true;
+
+	switch (instr->mnemonic) {
+	case RBT_OP_Bcc:
+	case RBT_OP_BRA:
+	case RBT_OP_BSR:
+	case RBT_OP_DBcc:
+	case RBT_OP_JMP:
+	case RBT_OP_JSR:
+	case RBT_OP_RTD:
+	case RBT_OP_RTE:
+	case RBT_OP_RTR:
+	case RBT_OP_RTS:
+	case RBT_OP_TRAP:
+	case RBT_OP_TRAPV:
+	case RBT_OP_BKPT:
+	case RBT_OP_ILLEGAL:
+	case RBT_OP_LINEA:
+	case RBT_OP_LINEF:
+	case RBT_OP_RESET:
+	case RBT_OP_STOP: return true;
+	default:          return false;
+	}
+}
+
+// Blocks skip the exception checks between instructions and the debug hook
+static inline bool _cpu_can_run_blocks(const RBT_Cpu *cpu) {
+	const RBT_CpuPendingException *pending = &cpu->pending;
+	if (pending->bus_error || pending->address_error || pending->trace)
+		return false;
+	if ((cpu->state.sr & RBT_SR_TRACE1) || cpu->cfg.hook)
+		return false;
+	return !cpu->is_stopped && !cpu->is_idle && !_cpu_interrupt_pending(cpu);
+}
+
+static inline u32 _cpu_block_slot(u32 pc) {
+	return ((pc >> 1) * 0x9e37'79b1u) >> (32 - _CPU_BLOCK_SLOT_BITS);
+}
+
+static inline bool _cpu_block_matches(
+	const RBT_Cpu *cpu, const RBT_CpuBlock *block, u32 pc
+) {
+	return block && block->start_pc == pc
+		&& block->page_gen == cpu->bus->code_gen[block->code_page];
+}
+
+// Whether a block run must stop after an instruction that was expected to
+// continue at `next`
+static inline bool _cpu_block_breaks(
+	const RBT_Cpu *cpu, const RBT_CpuBlock *block, u32 next, u32 cycles, u32 budget
+) {
+	return cpu->state.pc != next || cycles >= budget
+		|| block->page_gen != cpu->bus->code_gen[block->code_page]
+		|| _cpu_interrupt_pending(cpu);
+}
+
+// Runs the instructions at PC one at a time, as long as they belong in a block,
+// and copies them into `block`. The block is only kept if its code page wasn't
+// written to meanwhile.
+static RBT_ErrorCode _cpu_record_block(
+	RBT_Cpu *cpu, RBT_CpuBlock *block, u32 cycle_budget, u32 *cycles
+) {
+	u32 start = cpu->state.pc & 0xff'ffff;
+	u32 page = _bus_code_page(cpu->bus, start);
+	*block = (RBT_CpuBlock) {
+		.start_pc = _CPU_ICACHE_TAG_NONE,
+		.end_pc = start,
+		.code_page = page,
+	};
+	if (page == _BUS_CODE_PAGE_NONE) {
+		u16 instr_cycles = 0;
+		RBT_ErrorCode err = _cpu_execute_next(cpu, &instr_cycles, nullptr);
+		*cycles += instr_cycles;
 		return err;
+	}
+
+	block->page_gen = cpu->bus->code_gen[page];
+	_bus_mark_code(cpu->bus, page);
+
+	for (;;) {
+		RBT_PackedInstr *instr = &block->instrs[block->count];
+		u32 from = cpu->state.pc;
+
+		u16 instr_cycles = 0;
+		RBT_ErrorCode err = _cpu_execute_next(cpu, &instr_cycles, instr);
+		if (err)
+			return err;
+		*cycles += instr_cycles;
+
+		// Faults, exceptions taken on the fetch and page-crossing instructions
+		// stay out of the block
+		u32 end = block->end_pc + instr->len;
+		bool is_faulting = cpu->pending.bus_error || cpu->pending.address_error;
+		if (instr->start_pc != block->end_pc || instr->mnemonic == RBT_OP_ILLEGAL
+			|| _bus_code_page(cpu->bus, end - 1) != page || is_faulting)
+			break;
+
+		block->count += 1;
+		block->end_pc = end;
+		if (_cpu_ends_block(instr) || block->count == _CPU_BLOCK_MAX_INSTRS)
+			break;
+		if (_cpu_block_breaks(cpu, block, from + instr->len, *cycles, cycle_budget))
+			break;
+	}
+
+	if (block->count > 0 && block->page_gen == cpu->bus->code_gen[page])
+		block->start_pc = start;
+	return RBT_ERR_SUCCESS;
+}
+
+// Replays `block` from its first instruction, until its end or until the code
+// takes another way
+static RBT_ErrorCode _cpu_run_block(
+	RBT_Cpu *cpu, const RBT_CpuBlock *block, u32 cycle_budget, u32 *cycles
+) {
+	cpu->is_faulting = false;
+
+	for (u32 i = 0; i < block->count; i += 1) {
+		const RBT_PackedInstr *instr = &block->instrs[i];
+		u32 next = cpu->state.pc + instr->len;
+		cpu->state.pc = next;
+
+		RBT_ErrorCode err = _cpu_execute(instr, cpu);
+		if (err) {
+			err = _cpu_fault(cpu, err, false, instr->opcode);
+			if (err)
+				return err;
+			next = _CPU_ICACHE_TAG_NONE; // Group 0 exception is pending
+		}
+
+		*cycles += _timing_step_cycles(
+			instr->mnemonic, instr->size, instr->ea_cycles, &cpu->timing,
+			cpu->cfg.model
+		);
+		if (_cpu_block_breaks(cpu, block, next, *cycles, cycle_budget))
+			break;
+	}
+
+	return RBT_ERR_SUCCESS;
+}
+
+// Same as _cpu_run(), going from block to block whenever nothing needs to be
+// checked between instructions
+static RBT_ErrorCode _cpu_run_blocks(RBT_Cpu *cpu, u32 cycle_budget, u32 *out_cycles) {
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	RBT_CpuBlock *block = nullptr; // Last block run, its exits get linked
+	u32 cycles = 0;
+	cpu->is_idle = false; // Devices may have moved since the last run
+
+	while (cycles < cycle_budget) {
+		if (cpu->is_halted) {
+			err = RBT_ERR_CPU_HALTED;
+			break;
+		}
+
+		if (!_cpu_can_run_blocks(cpu)) {
+			u16 instr_cycles = 0;
+			err = _cpu_execute_next(cpu, &instr_cycles, nullptr);
+			if (err)
+				break;
+			cycles += instr_cycles;
+			block = nullptr;
+		} else {
+			u32 pc = cpu->state.pc & 0xff'ffff;
+			RBT_CpuBlock **link = nullptr;
+			if (block)
+				link = &block->exits[pc == block->end_pc ? 0 : 1];
+
+			block = link ? *link : nullptr;
+			if (!_cpu_block_matches(cpu, block, pc)) {
+				block = &cpu->blocks[_cpu_block_slot(pc)];
+				if (!_cpu_block_matches(cpu, block, pc)) {
+					err = _cpu_record_block(cpu, block, cycle_budget, &cycles);
+					if (err)
+						break;
+					if (!_cpu_block_matches(cpu, block, pc))
+						block = nullptr;
+					if (link)
+						*link = block;
+					continue;
+				}
+				if (link)
+					*link = block;
+			}
+
+			err = _cpu_run_block(cpu, block, cycle_budget, &cycles);
+			if (err)
+				break;
+		}
+
+		// Give control back so the caller can observe the interrupt before it's taken
+		if (_cpu_interrupt_pending(cpu))
+			break;
+	}
+
+	_cpu_skip_idle(cycle_budget, &cycles, &err);
+	*out_cycles = cycles;
+	return err;
+}
+
+// Fills `block` from the decoder alone, for code known to be reachable. It stops
+// where _cpu_record_block() would, short of the conditions only known at runtime.
+static RBT_ErrorCode _cpu_build_block(RBT_Cpu *cpu, RBT_CpuBlock *block, u32 pc) {
+	u32 start = pc & 0xff'ffff;
+	u32 page = _bus_code_page(cpu->bus, start);
+	*block = (RBT_CpuBlock) {
+		.start_pc = _CPU_ICACHE_TAG_NONE,
+		.end_pc = start,
+		.code_page = page,
+	};
+	if (page == _BUS_CODE_PAGE_NONE || (start & 1))
+		return RBT_ERR_SUCCESS;
+
+	block->page_gen = cpu->bus->code_gen[page];
+	_bus_mark_code(cpu->bus, page);
+
+	while (block->count < _CPU_BLOCK_MAX_INSTRS) {
+		const RBT_PackedInstr *instr;
+		RBT_ErrorCode err = _cpu_fetch_instruction(cpu, block->end_pc, &instr);
+		if (err)
+			return err;
+
+		u32 end = block->end_pc + instr->len;
+		if (instr->mnemonic == RBT_OP_ILLEGAL
+			|| _bus_code_page(cpu->bus, end - 1) != page)
+			break;
+
+		block->instrs[block->count] = *instr;
+		block->count += 1;
+		block->end_pc = end;
+		if (_cpu_ends_block(instr))
+			break;
+	}
+
+	if (block->count > 0)
+		block->start_pc = start;
+	return RBT_ERR_SUCCESS;
+}
+
+RBT_ErrorCode rbt_cpu_run(RBT_Cpu *cpu, u32 cycle_budget, u32 *out_cycles) {
+	assert(cpu);
+	assert(cpu->bus);
+
+	const u32 *pc_source = _err_set_pc_source(&cpu->state.pc);
+	u32 cycles = 0;
+	RBT_ErrorCode err = cpu->cfg.translate_blocks
+						  ? _cpu_run_blocks(cpu, cycle_budget, &cycles)
+						  : _cpu_run(cpu, cycle_budget, &cycles);
+	_cpu_sync_ccr(cpu);
+	_err_set_pc_source(pc_source);
+
+	if (out_cycles)
+		*out_cycles = cycles;
+	return err;
+}
+
+RBT_ErrorCode rbt_cpu_run_until_event(
+	RBT_Cpu *cpu, RBT_Scheduler *sched, u32 *out_cycles
+) {
+	assert(cpu);
+	assert(cpu->bus);
+	assert(sched);
+
+	u64 budget = rbt_sched_until_next(sched);
+	if (budget > UINT32_MAX)
+		budget = UINT32_MAX;
+
+	// Instructions aren't split, an event fires after the one that reaches it
+	u32 cycles = 0;
+	RBT_ErrorCode err = RBT_ERR_SUCCESS;
+	if (budget > 0) {
+		const u32 *pc_source = _err_set_pc_source(&cpu->state.pc);
+		err = cpu->cfg.translate_blocks ? _cpu_run_blocks(cpu, (u32)budget, &cycles)
+										: _cpu_run(cpu, (u32)budget, &cycles);
+		_cpu_sync_ccr(cpu);
+		_err_set_pc_source(pc_source);
+	}
+
+	RBT_ErrorCode event_err = rbt_sched_advance(sched, cycles);
 
 	if (out_cycles)
-		*out_cycles = _calculate_timing(instr, &cpu->timing, cpu->cfg.model);
-	memset(&cpu->timing, 0, sizeof(RBT_TimingCtx));
+		*out_cycles = cycles;
+	return err ? err : event_err;
+}
+
+void rbt_cpu_flush_cache(RBT_Cpu *cpu) {
+	assert(cpu);
 
+	for (usize i = 0; i < _CPU_ICACHE_SIZE; i += 1) {
+		cpu->icache.entries[i].instr.start_pc = _CPU_ICACHE_TAG_NONE;
+	}
+	for (usize i = 0; i < _CPU_BLOCK_SLOTS; i += 1) {
+		cpu->blocks[i].start_pc = _CPU_ICACHE_TAG_NONE;
+	}
+	cpu->idle_branch_pc = _CPU_ICACHE_TAG_NONE;
+}
+
+RBT_ErrorCode rbt_cpu_preload_blocks(RBT_Cpu *cpu, const u32 *pcs, usize count) {
+	assert(cpu);
+	assert(cpu->bus);
+	assert(pcs || count == 0);
+
+	for (usize i = 0; i < count; i += 1) {
+		u32 pc = pcs[i] & 0xff'ffff;
+		RBT_CpuBlock *block = &cpu->blocks[_cpu_block_slot(pc)];
+		RBT_ErrorCode err = _cpu_build_block(cpu, block, pc);
+		if (err)
+			return err;
+	}
 	return RBT_ERR_SUCCESS;
 }
+
+void rbt_cpu_query_cache_stats(const RBT_Cpu *cpu, RBT_CpuCacheStats *out) {
+	assert(cpu);
+	assert(out);
+
+	out->hits = cpu->icache.hits;
+	out->misses = cpu->icache.misses;
+}
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "cpu/packed_instr.h"
 #include "cpu/timing.h"
 #include "rbt/basic_types.h"
 #include "rbt/cpu/bus.h"
@@ -26,6 +27,8 @@
 #include "rbt/helpers.h"
 
 #include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 typedef enum RBT_CpuVector {
 	_VEC_INITIAL_SSP = 0, // Reset: Initial SSP
@@ -83,10 +86,29 @@ typedef enum RBT_CpuVector {
 typedef struct RBT_CpuPendingException {
 	bool bus_error;
 	bool address_error;
-	bool interrupt;
-	u8 interrupt_level; // 1-7
+	bool trace; // The last instruction started with T1 set
 } RBT_CpuPendingException;
 
+// Sizes in bytes of the exception stack frames
+enum {
+	_CPU_FRAME_SHORT = 6,	// MC68000 groups 1 and 2: SR, PC
+	_CPU_FRAME_GROUP0 = 14,	// MC68000 bus and address errors
+	_CPU_FRAME_FMT0 = 8,	// MC68010 format $0: SR, PC, format/vector
+	_CPU_FRAME_FMT8 = 58,	// MC68010 format $8: bus and address errors
+
+	_CPU_FRAME_FMT_SHIFT = 12, // Format nibble of the format/vector word
+	_CPU_VECTOR_TABLE_SIZE = (_VEC_USER_LAST + 1) * 4,
+};
+
+// IPL lines seen by the CPU. Each driver owns a byte with a bit per level and
+// the CPU takes the highest level asserted by any of them.
+enum {
+	_CPU_IRQ_HOST_SHIFT = 0,	  // rbt_cpu_set_irq_line()
+	_CPU_IRQ_CTRL_SHIFT = 8,	  // Attached interrupt controller
+	_CPU_IRQ_LEVEL_MASK = 0xfe,	  // Levels 1-7 of a driver
+	_CPU_IRQ_NMI_EDGE = 1u << 16, // Level 7 went up and hasn't been taken yet
+};
+
 typedef struct RBT_CpuFaultInfo {
 	u32 addr;
 	u16 opcode;
@@ -95,21 +117,115 @@ typedef struct RBT_CpuFaultInfo {
 	bool is_fetch;
 } RBT_CpuFaultInfo;
 
+enum {
+	_CPU_ICACHE_SIZE = 4096, // Direct-mapped; must be a power of two
+	_CPU_ICACHE_TAG_NONE = UINT32_MAX,
+};
+
+// Half a cache line. The start PC of the instruction is the tag, and the code
+// page holding it follows from the PC.
+typedef struct RBT_ICacheEntry {
+	u32 page_gen; // Code page generation when it was decoded
+	RBT_PackedInstr instr;
+} RBT_ICacheEntry;
+
+typedef struct RBT_ICache {
+	RBT_ICacheEntry entries[_CPU_ICACHE_SIZE];
+	u64 hits;
+	u64 misses;
+} RBT_ICache;
+
+enum {
+	_CPU_BLOCK_SLOT_BITS = 8,
+	_CPU_BLOCK_SLOTS = 1 << _CPU_BLOCK_SLOT_BITS, // Hashed by start PC
+	_CPU_BLOCK_MAX_INSTRS = 16,
+};
+
+// Straight-line code as it ran the first time, from `start_pc` up to the first
+// branch, trap or SR write. It never leaves its code page. `exits` link the
+// blocks that ran next, once falling through `end_pc` and once going elsewhere;
+// a link is only followed if its block still starts at the new PC.
+typedef struct RBT_CpuBlock {
+	u32 start_pc; // _CPU_ICACHE_TAG_NONE while the slot is empty
+	u32 end_pc;
+	u32 code_page;
+	u32 page_gen; // Code page generation when it was recorded
+	u32 count;
+	struct RBT_CpuBlock *exits[2];
+	RBT_PackedInstr instrs[_CPU_BLOCK_MAX_INSTRS];
+} RBT_CpuBlock;
+
+typedef enum RBT_CcrOp {
+	_CCR_OP_NONE = 0, // Condition codes in the status register are up to date
+	_CCR_OP_LOGIC,	  // N Z from result, V C cleared
+	_CCR_OP_ADD,	  // N Z V C from dst + src
+	_CCR_OP_SUB,	  // N Z V C from dst - src
+} RBT_CcrOp;
+
+// Operands of the last instruction that changed the condition codes. Flags are
+// only computed from it when something reads them, see _cpu_sync_ccr().
+typedef struct RBT_LazyCcr {
+	u8 op;		 // RBT_CcrOp
+	u8 size;	 // RBT_OperandSize
+	bool extend; // X is set to C too
+	u32 src;
+	u32 dst;
+	u32 result;
+} RBT_LazyCcr;
+
 typedef struct RBT_Cpu {
 	RBT_CpuConfig cfg; // General CPU configuration
 
 	RBT_CpuState state;
+	RBT_LazyCcr ccr; // Pending condition codes of `state.sr`
 	RBT_MemoryBus *bus;
-	RBT_Instruction current_instr;
+	RBT_Instruction current_instr;	// Decoder's view, for the debug hook
+	RBT_PackedInstr current_packed; // Used when the PC can't be cached
+	RBT_ICache icache;
+	RBT_CpuBlock blocks[_CPU_BLOCK_SLOTS]; // Used with `cfg.translate_blocks`
 
 	RBT_CpuFaultInfo fault;
 	RBT_TimingCtx timing;
 	RBT_CpuPendingException pending;
+	RBT_IrqController *irq;
+	_Atomic(u32) irq_lines;
+
+	// Host copy of the vector table at `vectors_vbr`, null when it isn't entirely
+	// backed by RAM/ROM and vectors have to be read through the bus
+	const u8 *vectors;
+	u32 vectors_vbr;
+	u32 vectors_map_gen;
+
+	// Verdict of the last backward branch checked by _cpu_detect_idle_loop(),
+	// valid while its code page keeps the same generation
+	u32 idle_branch_pc;
+	u32 idle_branch_gen;
+	bool idle_branch_ok;
+
+	bool is_faulting; // Group 0 exception taken, the handler hasn't run yet
+	bool is_stopped;  // STOP executed, only an exception resumes execution
+	bool is_idle;	  // Spinning in a loop that only a device can end
 	bool is_halted;
 } RBT_Cpu;
 
+// Initializes a CPU living in memory the caller owns, and unlinks it from the
+// interrupt controller and error reports before that memory goes away
+void _cpu_setup(RBT_Cpu *cpu, const RBT_CpuConfig *config);
+void _cpu_teardown(RBT_Cpu *cpu);
+
+// Takes an exception raised by the current instruction. Its processing time
+// replaces the instruction's own.
 RBT_ErrorCode _cpu_raise_exception(RBT_Cpu *cpu, RBT_CpuVector vec);
 
+// Flags the CPU as idle when the backward branch at `pc` to `target` closes a
+// loop that only polls: nothing but tests and branches, no writes, no register
+// updates. Run loops then skip to the end of their budget.
+void _cpu_detect_idle_loop(RBT_Cpu *cpu, u32 pc, u32 target);
+
+// Replaces the lines selected by `mask` with `lines`, latching the level 7
+// edge. Lock-free, may be called from any thread.
+void _cpu_drive_irq_lines(RBT_Cpu *cpu, u32 mask, u32 lines);
+
 RBT_ErrorCode _stack_push_word(RBT_Cpu *cpu, u16 word);
 RBT_ErrorCode _stack_push_long(RBT_Cpu *cpu, u32 long_);
 
@@ -123,47 +239,87 @@ RBT_ErrorCode _stack_pop_long(RBT_Cpu *cpu, u32 *out);
 	return state->vbr + ((u32)vec * 4);
 }
 
-[[nodiscard]] static inline u16 _pack_status_register(const RBT_StatusRegister *sr) {
-	assert(sr);
-
-	u16 word = 0;
-
-	if (sr->carry)
-		word |= 1 << 0;
-	if (sr->overflow)
-		word |= 1 << 1;
-	if (sr->zero)
-		word |= 1 << 2;
-	if (sr->negative)
-		word |= 1 << 3;
-	if (sr->extend)
-		word |= 1 << 4;
-
-	word |= (sr->interrupt_priority & 0x07) << 8;
-
-	// if (sr->master)
-	//	word |= 1 << 12;
-	if (sr->supervisor)
-		word |= 1 << 13;
-	// if (sr->trace0)
-	//	word |= 1 << 14;
-	if (sr->trace1)
-		word |= 1 << 15;
-
-	return word;
+// Writes the pending condition codes into the status register. Must be called
+// before N/Z/V/C/X are read or written through `state.sr`.
+static inline void _cpu_sync_ccr(RBT_Cpu *cpu) {
+	assert(cpu);
+
+	RBT_LazyCcr *ccr = &cpu->ccr;
+	if (ccr->op == _CCR_OP_NONE)
+		return;
+
+	u32 mask = 0xffff'ffffu >> (32 - (ccr->size * 8));
+	u32 msb = (mask >> 1) + 1; // Most-Significant Bit
+	u32 src = ccr->src & mask;
+	u32 dst = ccr->dst & mask;
+	u32 result = ccr->result & mask;
+
+	bool carry = false;
+	bool overflow = false;
+	switch (ccr->op) {
+	case _CCR_OP_ADD:
+		carry = result < dst;
+		overflow = ((dst ^ result) & (src ^ result) & msb) != 0;
+		break;
+	case _CCR_OP_SUB:
+		carry = src > dst; // borrow
+		overflow = ((dst ^ src) & (dst ^ result) & msb) != 0;
+		break;
+	default:
+		break;
+	}
+
+	u16 flags = (carry ? RBT_SR_CARRY : 0) | (overflow ? RBT_SR_OVERFLOW : 0)
+			  | (result == 0 ? RBT_SR_ZERO : 0) | ((result & msb) ? RBT_SR_NEGATIVE : 0);
+	u16 written = RBT_SR_CARRY | RBT_SR_OVERFLOW | RBT_SR_ZERO | RBT_SR_NEGATIVE;
+	if (ccr->extend) {
+		flags |= carry ? RBT_SR_EXTEND : 0;
+		written |= RBT_SR_EXTEND;
+	}
+
+	cpu->state.sr = (cpu->state.sr & ~written) | flags;
+
+	ccr->op = _CCR_OP_NONE;
+	ccr->extend = false;
+}
+
+// Writes the status register, swapping A7 with the other stack pointer when the
+// supervisor bit changes. The inactive one lives in `state.usp`/`state.ssp`.
+static inline void _cpu_write_sr(RBT_Cpu *cpu, u16 sr) {
+	assert(cpu);
+
+	_cpu_sync_ccr(cpu); // Pending flags would overwrite the new ones
+	sr &= RBT_SR_IMPLEMENTED;
+
+	RBT_CpuState *state = &cpu->state;
+	if ((state->sr ^ sr) & RBT_SR_SUPERVISOR) {
+		if (sr & RBT_SR_SUPERVISOR) {
+			state->usp = state->gpr.sp;
+			state->gpr.sp = state->ssp;
+		} else {
+			state->ssp = state->gpr.sp;
+			state->gpr.sp = state->usp;
+		}
+	}
+
+	state->sr = sr;
+}
+
+// Moves A7 and the stack pointer of the current mode along with it
+static inline void _cpu_set_sp(RBT_Cpu *cpu, u32 sp) {
+	cpu->state.gpr.sp = sp;
+	if (cpu->state.sr & RBT_SR_SUPERVISOR)
+		cpu->state.ssp = sp;
+	else
+		cpu->state.usp = sp;
+}
+
+[[nodiscard]] static inline u8 _sr_interrupt_priority(u16 sr) {
+	return (sr & RBT_SR_INTERRUPT) >> RBT_SR_INTERRUPT_SHIFT;
 }
 
-static inline void _unpack_status_register(RBT_StatusRegister *sr, u16 word) {
-	assert(sr);
-
-	sr->carry = word & (1 << 0);
-	sr->overflow = word & (1 << 1);
-	sr->zero = word & (1 << 2);
-	sr->negative = word & (1 << 3);
-	sr->extend = word & (1 << 4);
-	sr->interrupt_priority = rbt_bits(word, 10, 8);
-	// sr->master = word & (1 << 12);
-	sr->supervisor = word & (1 << 13);
-	// sr->trace0 = word & (1 << 14);
-	sr->trace1 = word & (1 << 15);
+// Highest IPL level asserted in `lines` by any driver, 0 if none
+[[nodiscard]] static inline u8 _cpu_irq_level(u32 lines) {
+	u32 levels = (lines | (lines >> _CPU_IRQ_CTRL_SHIFT)) & _CPU_IRQ_LEVEL_MASK;
+	return levels ? (u8)(31 - rbt_clz_u32(levels)) : 0;
 }
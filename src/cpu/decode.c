@@ -31,6 +31,12 @@
 #include <stdio.h>
 #include <string.h>
 
+// source-inline-begin
+#ifndef RBT_OPTABLE_GENERATOR
+#	include "cpu/optable.inc" // Generated at build time by tools/gen_optable.c
+#endif
+// source-inline-end
+
 // Opcode field bits
 #define _OP_GROUP(word)	   (rbt_bits((word), 15, 12))
 #define _OP_SUBGROUP(word) (rbt_bits((word), 11, 8))
@@ -176,10 +182,9 @@ static u8 _decode_bit(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 	// Is dynamic?
 	if (rbt_bits(opcode, 11, 8) == 0b1000) {
 		u16 bits;
-		if (rbt_bus_read_word(bus, curr_pc, &bits)) {
-			const RBT_ErrorEntry *last = rbt_query_last_error();
-			return last ? last->code : RBT_ERR_GENERIC;
-		}
+		RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &bits);
+		if (err)
+			return err;
 		curr_pc += 2;
 
 		instr->src.mode = RBT_EA_IMMEDIATE;
@@ -249,10 +254,9 @@ static u8 _decode_imm(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 	instr->src.mode = RBT_EA_IMMEDIATE;
 	instr->src.size = instr->size;
 
-	if (_bus_fetch_imm(bus, instr->size, curr_pc, &instr->src.imm)) {
-		const RBT_ErrorEntry *last = rbt_query_last_error();
-		return last ? last->code : RBT_ERR_GENERIC;
-	}
+	RBT_ErrorCode err = _bus_fetch_imm(bus, instr->size, curr_pc, &instr->src.imm);
+	if (err)
+		return err;
 
 	// Skip out immediate words
 	curr_pc += (instr->size == RBT_SIZE_LONG) ? 4 : 2;
@@ -315,10 +319,9 @@ static u8 _decode_moves_movep(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 		instr->mnemonic = RBT_OP_MOVEP;
 
 		u16 disp;
-		if (rbt_bus_read_word(bus, curr_pc, &disp)) {
-			const RBT_ErrorEntry *last = rbt_query_last_error();
-			return last ? last->code : RBT_ERR_GENERIC;
-		}
+		RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &disp);
+		if (err)
+			return err;
 		curr_pc += 2;
 
 		// OP-MODE:
@@ -358,10 +361,9 @@ static u8 _decode_moves_movep(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 		}
 
 		u16 ext;
-		if (rbt_bus_read_word(bus, curr_pc, &ext)) {
-			const RBT_ErrorEntry *last = rbt_query_last_error();
-			return last ? last->code : RBT_ERR_GENERIC;
-		}
+		RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &ext);
+		if (err)
+			return err;
 		curr_pc += 2;
 
 		// Store extension word as auxiliar operand
@@ -570,10 +572,9 @@ static u8 _decode_movem(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 	instr->size = RBT_BIT(opcode, 6) ? RBT_SIZE_LONG : RBT_SIZE_WORD;
 
 	u16 regs;
-	if (rbt_bus_read_word(bus, curr_pc, &regs)) {
-		const RBT_ErrorEntry *last = rbt_query_last_error();
-		return last ? last->code : RBT_ERR_GENERIC;
-	}
+	RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &regs);
+	if (err)
+		return err;
 	curr_pc += 2;
 
 	// If mem->reg: EA invalid: Dn, An, -(An), #imm
@@ -811,10 +812,9 @@ static u8 _decode_misc(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 
 		if (instr->mnemonic == RBT_OP_LINK) {
 			u16 offset;
-			if (rbt_bus_read_word(bus, curr_pc, &offset)) {
-				const RBT_ErrorEntry *last = rbt_query_last_error();
-				return last ? last->code : RBT_ERR_GENERIC;
-			}
+			RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &offset);
+			if (err)
+				return err;
 
 			instr->size = RBT_SIZE_WORD;
 			instr->dst.mode = RBT_EA_DISPLACEMENT;
@@ -850,10 +850,9 @@ static u8 _decode_misc(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 	//        ARRR CTRL_REGISTER
 	if (rbt_bits(opcode, 3, 1) == 0b101) {
 		u16 aux;
-		if (rbt_bus_read_word(bus, curr_pc, &aux)) {
-			const RBT_ErrorEntry *last = rbt_query_last_error();
-			return last ? last->code : RBT_ERR_GENERIC;
-		}
+		RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &aux);
+		if (err)
+			return err;
 
 		instr->mnemonic = RBT_OP_MOVEC;
 		instr->size = RBT_SIZE_LONG;
@@ -902,25 +901,25 @@ static u8 _decode_misc(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 	case 0b101: instr->mnemonic = RBT_OP_RTS; break;
 	case 0b110: instr->mnemonic = RBT_OP_TRAPV; break;
 	case 0b111: instr->mnemonic = RBT_OP_RTR; break;
-	default:	unreachable();
+	default:
+		_push_warn("MISC: Unknown encoding at: 0x%06x", instr->start_pc);
+		return RBT_ERR_DECODE_ILLEGAL;
 	}
 
 	if (instr->mnemonic == RBT_OP_STOP) {
 		instr->src.size = RBT_SIZE_WORD;
 		instr->src.mode = RBT_EA_IMMEDIATE;
 
-		if (_bus_fetch_imm(bus, instr->src.size, curr_pc, &instr->src.imm)) {
-			const RBT_ErrorEntry *last = rbt_query_last_error();
-			return last ? last->code : RBT_ERR_GENERIC;
-		}
+		RBT_ErrorCode err = _bus_fetch_imm(bus, instr->src.size, curr_pc, &instr->src.imm);
+		if (err)
+			return err;
 	}
 
 	if (instr->mnemonic == RBT_OP_RTD) {
 		u16 disp;
-		if (rbt_bus_read_word(bus, curr_pc, &disp)) {
-			const RBT_ErrorEntry *last = rbt_query_last_error();
-			return last ? last->code : RBT_ERR_GENERIC;
-		}
+		RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &disp);
+		if (err)
+			return err;
 
 		instr->src.mode = RBT_EA_DISPLACEMENT;
 		instr->src.size = RBT_SIZE_WORD;
@@ -986,10 +985,9 @@ static u8 _decode_addq_subq(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 
 		if (ea_mode == 0b001) {
 			u16 offset;
-			if (rbt_bus_read_word(bus, curr_pc, &offset)) {
-				const RBT_ErrorEntry *last = rbt_query_last_error();
-				return last ? last->code : RBT_ERR_GENERIC;
-			}
+			RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &offset);
+			if (err)
+				return err;
 
 			instr->mnemonic = RBT_OP_DBcc;
 			instr->size = RBT_SIZE_WORD;
@@ -1076,10 +1074,9 @@ static u8 _decode_branch(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 	// Read 16-bits offset if 8-bits offset is 0x00
 	if (offset == 0x00) {
 		instr->size = RBT_SIZE_WORD;
-		if (rbt_bus_read_word(bus, curr_pc, &offset)) {
-			const RBT_ErrorEntry *last = rbt_query_last_error();
-			return last ? last->code : RBT_ERR_GENERIC;
-		}
+		RBT_ErrorCode err = _bus_fetch_word(bus, curr_pc, &offset);
+		if (err)
+			return err;
 	}
 
 	if (cond == RBT_COND_T) {
@@ -1706,88 +1703,131 @@ static u8 _decode_shift(RBT_Instruction *instr, RBT_MemoryBus *bus) {
 	return RBT_ERR_SUCCESS;
 }
 
-RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr) {
-	assert(bus);
-	assert(instr);
-
-	memset(instr, 0, sizeof(RBT_Instruction));
-	instr->start_pc = pc & 0xff'ffff;
-	instr->word_count = 1;
+// MOVEQ: 0111 RRR0 QQQQQQQQ [..L]
+static u8 _decode_moveq(RBT_Instruction *instr, RBT_MemoryBus *bus) {
+	(void)bus;
+	u16 opcode = instr->words[0];
 
-	if (rbt_bus_read_word(bus, instr->start_pc, &instr->words[0])) {
-		_push_error(RBT_ERR_MEM_BUS_ERROR, "Failed to fetch instruction word");
-		return RBT_ERR_MEM_BUS_ERROR;
+	if (RBT_BIT(opcode, 8)) {
+		_push_error(
+			RBT_ERR_DECODE_ILLEGAL, "MOVEQ: Unknown encoding at 0x%06x", instr->start_pc
+		);
+		return RBT_ERR_DECODE_ILLEGAL;
 	}
 
-	u16 opcode = instr->words[0];
+	u8 quick = _OP_MOVEQ_QUICK(opcode);
+	u8 dreg = _OP_REG(opcode);
+
+	instr->mnemonic = RBT_OP_MOVEQ;
+	instr->size = RBT_SIZE_LONG;
+
+	instr->src.mode = RBT_EA_IMMEDIATE;
+	instr->src.size = RBT_SIZE_NONE;
+	instr->src.imm = quick;
+
+	instr->dst.mode = RBT_EA_DIRECT_DATA;
+	instr->dst.reg = dreg;
+
+	return RBT_ERR_SUCCESS;
+}
+
+static u8 _decode_linea(RBT_Instruction *instr, RBT_MemoryBus *bus) {
+	(void)bus;
+	instr->mnemonic = RBT_OP_LINEA;
+	instr->size = RBT_SIZE_NONE;
+	return RBT_ERR_SUCCESS;
+}
+
+static u8 _decode_linef(RBT_Instruction *instr, RBT_MemoryBus *bus) {
+	(void)bus;
+	instr->mnemonic = RBT_OP_LINEF;
+	instr->size = RBT_SIZE_NONE;
+	return RBT_ERR_SUCCESS;
+}
+
+typedef u8 (*RBT_OpDecodeFn)(RBT_Instruction *instr, RBT_MemoryBus *bus);
+
+// Illegal and generic entries are handled by _decode_from_info()
+static const RBT_OpDecodeFn _decoders[_OPDECODER_COUNT] = {
+	[_OPDECODER_BIT] = _decode_bit,
+	[_OPDECODER_IMM] = _decode_imm,
+	[_OPDECODER_MOVES_MOVEP] = _decode_moves_movep,
+	[_OPDECODER_MOVE_MOVEA] = _decode_move_movea,
+	[_OPDECODER_MOVE_REG] = _decode_move_reg,
+	[_OPDECODER_NEGX_CLR_NOT] = _decode_negx_clr_not,
+	[_OPDECODER_MOVEM] = _decode_movem,
+	[_OPDECODER_EXT_NBCD_SWAP_BKPT_PEA] = _decode_ext_nbcd_swap_bkpt_pea,
+	[_OPDECODER_ILLEGAL_TAS_TST] = _decode_illegal_tas_tst,
+	[_OPDECODER_MISC] = _decode_misc,
+	[_OPDECODER_CHK_LEA] = _decode_chk_lea,
+	[_OPDECODER_ADDQ_SUBQ] = _decode_addq_subq,
+	[_OPDECODER_BRANCH] = _decode_branch,
+	[_OPDECODER_MOVEQ] = _decode_moveq,
+	[_OPDECODER_ORDIV] = _decode_ordiv,
+	[_OPDECODER_SUBSUBX] = _decode_subsubx,
+	[_OPDECODER_LINEA] = _decode_linea,
+	[_OPDECODER_CMP_EOR] = _decode_cmp_eor,
+	[_OPDECODER_AND_MUL] = _decode_and_mul,
+	[_OPDECODER_ADDADDX] = _decode_addaddx,
+	[_OPDECODER_SHIFT] = _decode_shift,
+	[_OPDECODER_LINEF] = _decode_linef,
+};
+
+RBT_OpDecoder _decode_select(u16 opcode) {
 	RBT_OpGroup group = _OP_GROUP(opcode);
-	RBT_ErrorCode status = RBT_ERR_SUCCESS;
 
 	switch (group) {
 	case _OPGROUP_BITMOVEPIMM: {
 		u8 subgroup = _OP_SUBGROUP(opcode);
 
-		if (subgroup == 0x0e) {
-			// MOVES: 0000 1110 SS MMMRRR [BWL] (M68010+)
-			status = _decode_moves_movep(instr, bus);
-			break;
-		}
+		// MOVES: 0000 1110 SS MMMRRR [BWL] (M68010+)
+		if (subgroup == 0x0e)
+			return _OPDECODER_MOVES_MOVEP;
 
-		if (subgroup == 0x08) {
-			// Static BTST/BCHG/BCLR/BSET: 0000 1000 TT MMMRRR [B.L]
-			status = _decode_bit(instr, bus);
-			break;
-		}
+		// Static BTST/BCHG/BCLR/BSET: 0000 1000 TT MMMRRR [B.L]
+		if (subgroup == 0x08)
+			return _OPDECODER_BIT;
 
 		if (RBT_BIT(opcode, 8)) {
 			// We can check here, since An is an invalid EA mode in next opcodes
-			if (_OP_EA_MODE(opcode) == 0b001) {
-				// MOVEP: 0000 DDD1 OO 001RRR [.WL]
-				status = _decode_moves_movep(instr, bus);
-				break;
-			}
+			// MOVEP: 0000 DDD1 OO 001RRR [.WL]
+			if (_OP_EA_MODE(opcode) == 0b001)
+				return _OPDECODER_MOVES_MOVEP;
 
 			// Dynamic BTST/BCHG/BCLR/BSET: 0000 DDD1 TT MMMRRR [B.L]
-			status = _decode_bit(instr, bus);
-			break;
+			return _OPDECODER_BIT;
 		}
 
 		// ORI/ANDI/SUBI/ADDI/EORI/CMPI: 0000 TTT0 SS MMMRRR [BWL]
-		status = _decode_imm(instr, bus);
-	} break;
+		return _OPDECODER_IMM;
+	}
 	case _OPGROUP_MOVEBYTE:
 	case _OPGROUP_MOVELONG:
 	case _OPGROUP_MOVEWORD:
 		// MOVE:  00SS RRRMMM MMMRRR [BWL]
 		// MOVEA: 00SS RRR001 MMMRRR [.WL]
-		status = _decode_move_movea(instr, bus);
-		break;
+		return _OPDECODER_MOVE_MOVEA;
 	case _OPGROUP_MISC: {
 		u8 subgroup = _OP_SUBGROUP(opcode);
 		u8 subtype = rbt_bits(opcode, 8, 6);
 
 		// CHK: 0100 DDD 110 MMMRRR [.W.]
 		// LEA: 0100 AAA 111 MMMRRR [..L]
-		if (subtype == 0b110 || subtype == 0b111) {
-			status = _decode_chk_lea(instr, bus);
-			break;
-		}
+		if (subtype == 0b110 || subtype == 0b111)
+			return _OPDECODER_CHK_LEA;
 
 		// MOVE fr SR:  0100 000 011 MMMRRR [.W.]
 		// MOVE fr CCR: 0100 001 011 MMMRRR [.W.]
 		// MOVE to CCR: 0100 010 011 MMMRRR [.W.]
 		// MOVE to SR:  0100 011 011 MMMRRR [.W.]
-		if ((!RBT_BIT(opcode, 11) && subtype == 0b011)) {
-			status = _decode_move_reg(instr, bus);
-			break;
-		}
+		if ((!RBT_BIT(opcode, 11) && subtype == 0b011))
+			return _OPDECODER_MOVE_REG;
 
 		// MOVEM: 0100 1d001s MMMRRR [.WL]
 		//        Register List Mask
 		if (RBT_BIT(opcode, 11) && rbt_bits(opcode, 9, 7) == 0b001
 			&& _OP_EA_MODE(opcode) != 0b000) {
-			status = _decode_movem(instr, bus);
-			break;
+			return _OPDECODER_MOVEM;
 		}
 
 		// EXT:   0100 100 ooo 000DDD [.WL]
@@ -1795,18 +1835,14 @@ RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *i
 		// SWAP:  0100 100 001 000RRR [.W.]
 		// BKPT:  0100 100 001 001NNN [...] (M68010+)
 		// PEA:   0100 100 001 MMMRRR [..L]
-		if (rbt_bits(opcode, 11, 9) == 0b100) {
-			status = _decode_ext_nbcd_swap_bkpt_pea(instr, bus);
-			break;
-		}
+		if (rbt_bits(opcode, 11, 9) == 0b100)
+			return _OPDECODER_EXT_NBCD_SWAP_BKPT_PEA;
 
 		// ILLEGAL: 0100 1010 11111100 [...]
 		// TAS:     0100 1010 11MMMRRR [B..]
 		// TST:     0100 1010 SSMMMRRR [BWL]
-		if (subgroup == 0b1010) {
-			status = _decode_illegal_tas_tst(instr, bus);
-			break;
-		}
+		if (subgroup == 0b1010)
+			return _OPDECODER_ILLEGAL_TAS_TST;
 
 		// JSR:      0100 1110 10 MMMRRR [...]
 		// JMP:      0100 1110 11 MMMRRR [...]
@@ -1827,93 +1863,56 @@ RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *i
 		// RTR:      0100 1110 0111 0111 [...]
 		// MOVEC:    0100 1110 0111 101d [..L] (M68010+)
 		//           ARRR CTRL_REGISTER
-		if (subgroup == 0b1110) {
-			status = _decode_misc(instr, bus);
-			break;
-		}
+		if (subgroup == 0b1110)
+			return _OPDECODER_MISC;
 
 		// NEGX/CLR/NEG/NOT: 0100 TTT0 SS MMMRRR [BWL]
-		status = _decode_negx_clr_not(instr, bus);
-	} break;
+		return _OPDECODER_NEGX_CLR_NOT;
+	}
 	case _OPGROUP_ADDQSUBQ:
 		// ADDQ: 0101 QQQ0 SS MMMRRR [BWL]
 		// SUBQ: 0101 QQQ1 SS MMMRRR [BWL]
 		// Scc:  0101 cccc 11 MMMRRR [B..]
 		// DBcc: 0101 cccc 11 001RRR [.W.]
-		status = _decode_addq_subq(instr, bus);
-		break;
+		return _OPDECODER_ADDQ_SUBQ;
 	case _OPGROUP_BRANCH:
 		// BRA: 0110 0000 dddddddd [BW.]
 		// BSR: 0110 0001 dddddddd [BW.]
 		// Bcc: 0110 cccc dddddddd [BW.]
-		status = _decode_branch(instr, bus);
-		break;
-	case _OPGROUP_MOVEQ: {
+		return _OPDECODER_BRANCH;
+	case _OPGROUP_MOVEQ:
 		// MOVEQ: 0111 RRR0 QQQQQQQQ [..L]
-		u16 opcode = instr->words[0];
-
-		if (RBT_BIT(opcode, 8)) {
-			_push_error(
-				RBT_ERR_DECODE_ILLEGAL, "MOVEQ: Unknown encoding at 0x%06x",
-				instr->start_pc
-			);
-			status = RBT_ERR_DECODE_ILLEGAL;
-			break;
-		}
-
-		u8 quick = _OP_MOVEQ_QUICK(opcode);
-		u8 dreg = _OP_REG(opcode);
-
-		instr->mnemonic = RBT_OP_MOVEQ;
-		instr->size = RBT_SIZE_LONG;
-
-		instr->src.mode = RBT_EA_IMMEDIATE;
-		instr->src.size = RBT_SIZE_NONE;
-		instr->src.imm = quick;
-
-		instr->dst.mode = RBT_EA_DIRECT_DATA;
-		instr->dst.reg = dreg;
-
-		status = RBT_ERR_SUCCESS;
-	} break;
+		return _OPDECODER_MOVEQ;
 	case _OPGROUP_ORDIV:
 		// DIVU: 1000 RRR0 11 MMMRRR [.W.]
 		// DIVS: 1000 RRR1 11 MMMRRR [.W.]
 		// SBCD: 1000 RRR 10000 mRRR [B..]
 		// OR:   1000 RRRd SS MMMRRR [BWL]
-		status = _decode_ordiv(instr, bus);
-		break;
+		return _OPDECODER_ORDIV;
 	case _OPGROUP_SUBSUBX:
 		// SUB:  1001 DDDd SS MMMRRR [BWL]
 		// SUBX: 1001 RRR1 SS 00mRRR [BWL]
 		// SUBA: 1001 AAAs 11 MMMRRR [.WL]
-		status = _decode_subsubx(instr, bus);
-		break;
-	case _OPGROUP_LINEA:
-		instr->mnemonic = RBT_OP_LINEA;
-		instr->size = RBT_SIZE_NONE;
-		break;
+		return _OPDECODER_SUBSUBX;
+	case _OPGROUP_LINEA: return _OPDECODER_LINEA;
 	case _OPGROUP_CMPEOR:
 		// EOR:  1011 DDD1 SS MMMRRR [BWL]
 		// CMPM: 1011 AAA1 SS 001RRR [BWL]
 		// CMP:  1011 DDD0 SS MMMRRR [BWL]
 		// CMPA: 1011 AAAS 11 MMMRRR [.WL]
-		status = _decode_cmp_eor(instr, bus);
-		break;
+		return _OPDECODER_CMP_EOR;
 	case _OPGROUP_ANDMUL:
 		// MULU: 1100 DDD0 11 MMMRRR [.W.]
 		// MULS: 1100 DDD1 11 MMMRRR [.W.]
 		// ABCD: 1100 RRR 10000 mRRR [B..]
 		// EXG:  1100 RRR1 ooooo RRR [..L]
 		// AND:  1100 DDDd SS MMMRRR [BWL]
-		status = _decode_and_mul(instr, bus);
-		break;
+		return _OPDECODER_AND_MUL;
 	case _OPGROUP_ADDADDX:
 		// ADD:  1101 DDDd SS MMMRRR [BWL]
 		// ADDX: 1101 RRR1 SS 00mRRR [BWL]
 		// ADDA: 1101 AAAs 11 MMMRRR [.WL]
-		status = _decode_addaddx(instr, bus);
-		break;
+		return _OPDECODER_ADDADDX;
 	case _OPGROUP_SHIFT:
 		// ASd:  1110 000d 11 MMMRRR [.W.]
 		// LSd:  1110 001d 11 MMMRRR [.W.]
@@ -1923,15 +1922,129 @@ RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *i
 		// LSd:  1110 rrrd SS m01DDD [BWL]
 		// ROXd: 1110 rrrd SS m10DDD [BWL]
 		// ROd:  1110 rrrd SS m11DDD [BWL]
-		status = _decode_shift(instr, bus);
-		break;
-	case _OPGROUP_LINEF:
-		instr->mnemonic = RBT_OP_LINEF;
-		instr->size = RBT_SIZE_NONE;
-		break;
+		return _OPDECODER_SHIFT;
+	case _OPGROUP_LINEF: return _OPDECODER_LINEF;
+	default:			 unreachable();
+	}
+}
+
+static u8 _decode_operand(
+	const RBT_OperandSpec *spec, RBT_MemoryBus *bus, u32 *pc, RBT_EffectiveAddress *ea
+) {
+	switch (spec->kind) {
+	case _OPERAND_NONE: return RBT_ERR_SUCCESS;
+	case _OPERAND_EA:
+		*pc = _ea_decode(spec->field >> 3, spec->field & 0b111, spec->size, bus, *pc, ea);
+		return (*pc == UINT32_MAX) ? RBT_ERR_DECODE_INVALID_EA : RBT_ERR_SUCCESS;
+	case _OPERAND_CONST:
+		ea->mode = (RBT_AddressMode)(1u << spec->field);
+		ea->size = spec->size;
+
+		if (ea->mode == RBT_EA_DISPLACEMENT)
+			ea->disp = spec->value;
+		else if (ea->mode == RBT_EA_IMMEDIATE)
+			ea->imm = (u16)spec->value;
+		else
+			ea->reg = (u8)spec->value;
+		return RBT_ERR_SUCCESS;
+	case _OPERAND_EXT: {
+		u32 value;
+		RBT_ErrorCode err = _bus_fetch_imm(bus, spec->size, *pc, &value);
+		if (err)
+			return err;
+		*pc += (spec->size == RBT_SIZE_LONG) ? 4 : 2;
+
+		ea->mode = (RBT_AddressMode)(1u << spec->field);
+		ea->size = spec->size;
+
+		if (ea->mode == RBT_EA_DISPLACEMENT)
+			ea->disp = rbt_sign_extend(spec->size, value);
+		else
+			ea->imm = value;
+		return RBT_ERR_SUCCESS;
+	}
 	default: unreachable();
 	}
+}
+
+static u8 _decode_generic(
+	RBT_Instruction *instr, const RBT_OpcodeInfo *info, RBT_MemoryBus *bus
+) {
+	u32 curr_pc = instr->start_pc + 2;
+
+	instr->mnemonic = info->mnemonic;
+	instr->size = info->size;
+
+	const RBT_OperandSpec *first = &info->src;
+	const RBT_OperandSpec *second = &info->dst;
+	RBT_EffectiveAddress *first_ea = &instr->src;
+	RBT_EffectiveAddress *second_ea = &instr->dst;
+
+	if (info->flags & _OPINFO_DST_FIRST) {
+		first = &info->dst;
+		second = &info->src;
+		first_ea = &instr->dst;
+		second_ea = &instr->src;
+	}
+
+	u8 status = _decode_operand(&info->aux, bus, &curr_pc, &instr->aux);
+	if (status)
+		return status;
+
+	status = _decode_operand(first, bus, &curr_pc, first_ea);
+	if (status)
+		return status;
+
+	return _decode_operand(second, bus, &curr_pc, second_ea);
+}
+
+static inline u8 _decode_from_info(
+	RBT_Instruction *instr, const RBT_OpcodeInfo *info, RBT_MemoryBus *bus
+) {
+	switch (info->decoder) {
+	case _OPDECODER_GENERIC: return _decode_generic(instr, info, bus);
+	case _OPDECODER_ILLEGAL:
+		_push_error(
+			info->status, "Illegal opcode 0x%04x at: 0x%06x", instr->words[0],
+			instr->start_pc
+		);
+		return info->status;
+	default: return _decoders[info->decoder](instr, bus);
+	}
+}
+
+static inline RBT_ErrorCode _decode_fetch(
+	RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr
+) {
+	assert(bus);
+	assert(instr);
+
+	// Decoders fill in what their opcode family uses. Operands left at
+	// RBT_EA_NONE and words past `word_count` are never read, nor is the part of
+	// an operand its mode doesn't use (see _decode_instruction_equal()).
+	instr->mnemonic = RBT_OP_ILLEGAL;
+	instr->size = RBT_SIZE_NONE;
+	instr->start_pc = pc & 0xff'ffff;
+	instr->len = 0;
+	instr->aux.mode = RBT_EA_NONE;
+	instr->aux.size = RBT_SIZE_NONE;
+	instr->src.mode = RBT_EA_NONE;
+	instr->src.size = RBT_SIZE_NONE;
+	instr->dst.mode = RBT_EA_NONE;
+	instr->dst.size = RBT_SIZE_NONE;
+	instr->word_count = 1;
+
+	// Bus and address errors are kept apart, the CPU takes a different exception
+	RBT_ErrorCode err = _bus_fetch_word(bus, instr->start_pc, &instr->words[0]);
+	if (err) {
+		_push_error(err, "Failed to fetch instruction word");
+		return err;
+	}
 
+	return RBT_ERR_SUCCESS;
+}
+
+static inline void _decode_finish(RBT_Instruction *instr) {
 	instr->word_count += _store_operand_as_words(
 		&instr->aux, &instr->words[instr->word_count]
 	);
@@ -1943,5 +2056,101 @@ RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *i
 	);
 
 	instr->len = instr->word_count * 2; // length is stored as bytes
+}
+
+RBT_ErrorCode _decode_instruction_reference(
+	RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr
+) {
+	RBT_ErrorCode status = _decode_fetch(bus, pc, instr);
+	if (status)
+		return status;
+
+	status = _decoders[_decode_select(instr->words[0])](instr, bus);
+
+	_decode_finish(instr);
+	return status;
+}
+
+RBT_ErrorCode _decode_instruction_with(
+	RBT_MemoryBus *bus, u32 pc, const RBT_OpcodeInfo *info, RBT_Instruction *instr
+) {
+	assert(info);
+
+	RBT_ErrorCode status = _decode_fetch(bus, pc, instr);
+	if (status)
+		return status;
+
+	status = _decode_from_info(instr, info, bus);
+
+	_decode_finish(instr);
+	return status;
+}
+
+[[nodiscard]] static bool _index_equal(
+	const RBT_IndexExtension *a, const RBT_IndexExtension *b
+) {
+	return a->is_addr == b->is_addr && a->is_long == b->is_long && a->xreg == b->xreg
+		&& a->disp == b->disp;
+}
+
+[[nodiscard]] static bool _operand_equal(
+	const RBT_EffectiveAddress *a, const RBT_EffectiveAddress *b
+) {
+	if (a->mode != b->mode || a->size != b->size)
+		return false;
+
+	switch (a->mode) {
+	case RBT_EA_DIRECT_DATA:
+	case RBT_EA_DIRECT_ADDR: return a->reg == b->reg;
+	case RBT_EA_INDIRECT:
+	case RBT_EA_INDIRECT_POSTINC:
+	case RBT_EA_INDIRECT_PREDEC: return a->indirect == b->indirect;
+	case RBT_EA_INDIRECT_DISPLACEMENT:
+		return a->ind_disp.areg == b->ind_disp.areg
+			&& a->ind_disp.disp == b->ind_disp.disp;
+	case RBT_EA_INDIRECT_INDEXED:
+		return a->ind_idx.areg == b->ind_idx.areg
+			&& _index_equal(&a->ind_idx.ix, &b->ind_idx.ix);
+	case RBT_EA_ABSOLUTE_SHORT: return a->absolute_short == b->absolute_short;
+	case RBT_EA_ABSOLUTE_LONG:	return a->absolute_long == b->absolute_long;
+	case RBT_EA_PC_DISPLACEMENT:
+		return a->start_pc == b->start_pc && a->pc_disp == b->pc_disp;
+	case RBT_EA_PC_INDEXED:
+		return a->start_pc == b->start_pc && _index_equal(&a->pc_idx, &b->pc_idx);
+	case RBT_EA_IMMEDIATE:	  return a->imm == b->imm;
+	case RBT_EA_DISPLACEMENT: return a->disp == b->disp;
+	default:				  return true; // Registers and RBT_EA_NONE carry no value
+	}
+}
+
+bool _decode_instruction_equal(const RBT_Instruction *a, const RBT_Instruction *b) {
+	assert(a);
+	assert(b);
+
+	if (a->mnemonic != b->mnemonic || a->size != b->size || a->start_pc != b->start_pc
+		|| a->len != b->len || a->word_count != b->word_count)
+		return false;
+	if (memcmp(a->words, b->words, a->word_count * sizeof(u16)) != 0)
+		return false;
+
+	return _operand_equal(&a->aux, &b->aux) && _operand_equal(&a->src, &b->src)
+		&& _operand_equal(&a->dst, &b->dst);
+}
+
+#ifndef RBT_OPTABLE_GENERATOR
+RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr) {
+	RBT_ErrorCode status = _decode_fetch(bus, pc, instr);
+	if (status)
+		return status;
+
+	status = _decode_from_info(instr, &_op_table[instr->words[0]], bus);
+
+	_decode_finish(instr);
 	return status;
 }
+#else
+// The opcode table doesn't exist yet while it's being generated
+RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr) {
+	return _decode_instruction_reference(bus, pc, instr);
+}
+#endif
@@ -41,4 +41,82 @@ typedef enum RBT_OpGroup {
 	_OPGROUP_LINEF,		  // Extensions
 } RBT_OpGroup;
 
+typedef enum RBT_OpDecoder {
+	_OPDECODER_ILLEGAL, // Pre-marked illegal encoding
+	_OPDECODER_GENERIC, // Fully described by its RBT_OpcodeInfo
+	_OPDECODER_BIT,
+	_OPDECODER_IMM,
+	_OPDECODER_MOVES_MOVEP,
+	_OPDECODER_MOVE_MOVEA,
+	_OPDECODER_MOVE_REG,
+	_OPDECODER_NEGX_CLR_NOT,
+	_OPDECODER_MOVEM,
+	_OPDECODER_EXT_NBCD_SWAP_BKPT_PEA,
+	_OPDECODER_ILLEGAL_TAS_TST,
+	_OPDECODER_MISC,
+	_OPDECODER_CHK_LEA,
+	_OPDECODER_ADDQ_SUBQ,
+	_OPDECODER_BRANCH,
+	_OPDECODER_MOVEQ,
+	_OPDECODER_ORDIV,
+	_OPDECODER_SUBSUBX,
+	_OPDECODER_LINEA,
+	_OPDECODER_CMP_EOR,
+	_OPDECODER_AND_MUL,
+	_OPDECODER_ADDADDX,
+	_OPDECODER_SHIFT,
+	_OPDECODER_LINEF,
+	_OPDECODER_COUNT,
+} RBT_OpDecoder;
+
+typedef enum RBT_OperandKind {
+	_OPERAND_NONE,
+	_OPERAND_EA,	// Decoded by _ea_decode() from `field` (MMMRRR)
+	_OPERAND_CONST, // Mode `1 << field` with `value` taken from the opcode
+	_OPERAND_EXT,	// Mode `1 << field` with value read from extension words
+} RBT_OperandKind;
+
+typedef struct RBT_OperandSpec {
+	u8 kind;  // RBT_OperandKind
+	u8 field; // _OPERAND_EA: MMMRRR, otherwise the RBT_AddressMode bit
+	u8 size;  // RBT_OperandSize
+	i16 value;
+} RBT_OperandSpec;
+
+enum {
+	_OPINFO_DST_FIRST = 1 << 0, // Destination extension words precede the source
+};
+
+// Everything the decoder needs to know about an opcode word. Generated at build
+// time from the reference decoder, see tools/gen_optable.c.
+typedef struct RBT_OpcodeInfo {
+	u8 decoder;	 // RBT_OpDecoder
+	u8 mnemonic; // RBT_OpMnemonic
+	u8 size;	 // RBT_OperandSize
+	u8 flags;	 // _OPINFO_*
+	u8 status;	 // RBT_ErrorCode reported by illegal encodings
+	RBT_OperandSpec aux;
+	RBT_OperandSpec src;
+	RBT_OperandSpec dst;
+} RBT_OpcodeInfo;
+
+// Table driven decoder, one lookup plus extension-word fetches
 RBT_ErrorCode _decode_instruction(RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr);
+
+// Walks the opcode groups by hand, the opcode table is generated from it
+RBT_ErrorCode _decode_instruction_reference(
+	RBT_MemoryBus *bus, u32 pc, RBT_Instruction *instr
+);
+
+// Decodes the instruction at `pc` as described by `info`
+RBT_ErrorCode _decode_instruction_with(
+	RBT_MemoryBus *bus, u32 pc, const RBT_OpcodeInfo *info, RBT_Instruction *instr
+);
+
+RBT_OpDecoder _decode_select(u16 opcode);
+
+// Whether both decode to the same instruction. Only what the operand modes use
+// is compared, the decoders leave the rest as they found it.
+[[nodiscard]] bool _decode_instruction_equal(
+	const RBT_Instruction *a, const RBT_Instruction *b
+);
@@ -28,7 +28,6 @@
 
 #include <assert.h>
 #include <stdint.h>
-#include <string.h>
 
 bool _indexext_from_word(u16 ext, RBT_IndexExtension *ix) {
 	assert(ix);
@@ -77,7 +76,8 @@ u32 _ea_decode(
 	assert(bus);
 	assert(ea);
 
-	memset(ea, 0, sizeof(RBT_EffectiveAddress));
+	// Only the union member of the decoded mode is written
+	ea->mode = RBT_EA_NONE;
 	ea->start_pc = pc;
 	ea->size = size;
 
@@ -109,7 +109,7 @@ u32 _ea_decode(
 	case 0b101: { // (d16, An)
 
 		u16 disp;
-		if (rbt_bus_read_word(bus, pc, &disp)) {
+		if (_bus_fetch_word(bus, pc, &disp)) {
 			goto decoding_error;
 		}
 		bytes = 2;
@@ -120,7 +120,7 @@ u32 _ea_decode(
 	} break;
 	case 0b110: { // (d8, Xi, An)
 		u16 ext;
-		if (rbt_bus_read_word(bus, pc, &ext)) {
+		if (_bus_fetch_word(bus, pc, &ext)) {
 			goto decoding_error;
 		}
 		bytes = 2;
@@ -135,7 +135,7 @@ u32 _ea_decode(
 		switch (reg) {
 		case 0b000: { // (xxx).w
 			u16 abs;
-			if (rbt_bus_read_word(bus, pc, &abs)) {
+			if (_bus_fetch_word(bus, pc, &abs)) {
 				goto decoding_error;
 			}
 			bytes = 2;
@@ -145,7 +145,7 @@ u32 _ea_decode(
 		} break;
 		case 0b001: { // (xxx).l
 			u32 abs;
-			if (rbt_bus_read_long(bus, pc, &abs)) {
+			if (_bus_fetch_long(bus, pc, &abs)) {
 				goto decoding_error;
 			}
 			bytes = 4;
@@ -155,7 +155,7 @@ u32 _ea_decode(
 		} break;
 		case 0b010: { // (d16, PC)
 			u16 disp;
-			if (rbt_bus_read_word(bus, pc, &disp)) {
+			if (_bus_fetch_word(bus, pc, &disp)) {
 				goto decoding_error;
 			}
 			bytes = 2;
@@ -165,7 +165,7 @@ u32 _ea_decode(
 		} break;
 		case 0b011: { // (d8, Xi, PC)
 			u16 ext;
-			if (rbt_bus_read_word(bus, pc, &ext)) {
+			if (_bus_fetch_word(bus, pc, &ext)) {
 				goto decoding_error;
 			}
 			bytes = 2;
@@ -191,50 +191,95 @@ u32 _ea_decode(
 	return ea->start_pc + bytes;
 
 decoding_error:
+	ea->mode = RBT_EA_NONE; // Its extension fields may be half written
 	_push_error(
 		RBT_ERR_DECODE_INVALID_EA, "Failed to decode effective address at: 0x%06x", pc
 	);
 	return UINT32_MAX;
 }
 
-u32 _ea_compute_address(const RBT_EffectiveAddress *ea, RBT_Cpu *cpu) {
+void _ea_pack(const RBT_EffectiveAddress *ea, RBT_PackedOperand *out) {
+	assert(ea);
+	assert(out);
+
+	*out = (RBT_PackedOperand) { 0 };
+	if (ea->mode == RBT_EA_NONE)
+		return;
+
+	// Packed modes follow the bit order of RBT_AddressMode
+	out->mode = (u8)(rbt_ctz_u32((u32)ea->mode) + 1);
+	assert(out->mode <= _EA_VBR && _packed_mode_bit(out->mode) == ea->mode);
+
+	const RBT_IndexExtension *ix = nullptr;
 	switch (ea->mode) {
-	case RBT_EA_INDIRECT: //
-		return cpu->state.gpr.addr[ea->indirect];
+	case RBT_EA_DIRECT_DATA:
+	case RBT_EA_DIRECT_ADDR: //
+		out->reg = ea->reg;
+		break;
+	case RBT_EA_INDIRECT:
+	case RBT_EA_INDIRECT_POSTINC:
+	case RBT_EA_INDIRECT_PREDEC: //
+		out->reg = ea->indirect;
+		break;
 	case RBT_EA_INDIRECT_DISPLACEMENT:
-		return cpu->state.gpr.addr[ea->ind_disp.areg] + ea->ind_disp.disp;
-	case RBT_EA_INDIRECT_INDEXED: {
-		const RBT_IndexExtension *ix = &ea->ind_idx.ix;
-		u32 xreg;
-		RBT_OperandSize ix_size = ix->is_long ? RBT_SIZE_LONG : RBT_SIZE_WORD;
-		if (ix->is_addr)
-			xreg = cpu->state.gpr.addr[ix->xreg];
-		else
-			xreg = cpu->state.gpr.data[ix->xreg];
-
-		return cpu->state.gpr.addr[ea->ind_idx.areg] //
-			 + ix->disp								 //
-			 + rbt_sign_extend(ix_size, xreg);
-	}
+		out->reg = ea->ind_disp.areg;
+		out->value = (u32)ea->ind_disp.disp;
+		break;
+	case RBT_EA_INDIRECT_INDEXED:
+		out->reg = ea->ind_idx.areg;
+		out->value = (u32)ea->ind_idx.ix.disp;
+		ix = &ea->ind_idx.ix;
+		break;
 	case RBT_EA_ABSOLUTE_SHORT: //
-		return rbt_sign_extend(RBT_SIZE_WORD, ea->absolute_short);
+		out->value = rbt_sign_extend(RBT_SIZE_WORD, ea->absolute_short);
+		break;
 	case RBT_EA_ABSOLUTE_LONG: //
-		return ea->absolute_long;
+		out->value = ea->absolute_long;
+		break;
 	case RBT_EA_PC_DISPLACEMENT: //
-		return ea->start_pc + ea->pc_disp;
-	case RBT_EA_PC_INDEXED: {
-		const RBT_IndexExtension *ix = &ea->pc_idx;
-		u32 xreg;
-		RBT_OperandSize ix_size = ix->is_long ? RBT_SIZE_LONG : RBT_SIZE_WORD;
-		if (ix->is_addr)
-			xreg = cpu->state.gpr.addr[ix->xreg];
-		else
-			xreg = cpu->state.gpr.data[ix->xreg];
+		out->value = ea->start_pc + ea->pc_disp;
+		break;
+	case RBT_EA_PC_INDEXED:
+		out->value = ea->start_pc + ea->pc_idx.disp;
+		ix = &ea->pc_idx;
+		break;
+	case RBT_EA_IMMEDIATE: //
+		out->value = ea->imm;
+		break;
+	case RBT_EA_DISPLACEMENT: //
+		out->value = (u32)ea->disp;
+		break;
+	default: //
+		break;
+	}
 
-		return ea->start_pc //
-			 + ix->disp		//
-			 + rbt_sign_extend(ix_size, xreg);
+	if (ix) {
+		out->index = (ix->is_addr ? 8 : 0) + ix->xreg;
+		out->index |= ix->is_long ? _EA_INDEX_LONG : 0;
 	}
+}
+
+[[nodiscard]] static inline u32 _ea_index(const RBT_PackedOperand *ea, RBT_Cpu *cpu) {
+	u32 xreg = cpu->state.gpr.flat[ea->index & _EA_INDEX_REG];
+	if (ea->index & _EA_INDEX_LONG)
+		return xreg;
+	return rbt_sign_extend(RBT_SIZE_WORD, xreg);
+}
+
+u32 _ea_compute_address(const RBT_PackedOperand *ea, RBT_Cpu *cpu) {
+	switch (ea->mode) {
+	case _EA_IND: //
+		return cpu->state.gpr.addr[ea->reg];
+	case _EA_IND_DISP: //
+		return cpu->state.gpr.addr[ea->reg] + ea->value;
+	case _EA_IND_INDEX: //
+		return cpu->state.gpr.addr[ea->reg] + ea->value + _ea_index(ea, cpu);
+	case _EA_ABS_W:
+	case _EA_ABS_L:
+	case _EA_PC_DISP: //
+		return ea->value;
+	case _EA_PC_INDEX: //
+		return ea->value + _ea_index(ea, cpu);
 	default: //
 		return 0;
 	}
@@ -243,83 +288,83 @@ u32 _ea_compute_address(const RBT_EffectiveAddress *ea, RBT_Cpu *cpu) {
 }
 
 RBT_ErrorCode _ea_read(
-	const RBT_EffectiveAddress *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 *out
+	const RBT_PackedOperand *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 *out
 ) {
 	assert(ea);
 	assert(cpu);
 	assert(out);
 
 	switch (ea->mode) {
-	case RBT_EA_DIRECT_DATA: //
+	case _EA_DN: //
 		*out = rbt_truncate(size, cpu->state.gpr.data[ea->reg]);
 		break;
-	case RBT_EA_DIRECT_ADDR: //
+	case _EA_AN: //
 		*out = cpu->state.gpr.addr[ea->reg];
 		break;
-	case RBT_EA_INDIRECT_POSTINC: {
-		u32 addr = cpu->state.gpr.addr[ea->indirect];
+	case _EA_POSTINC: {
+		u32 addr = cpu->state.gpr.addr[ea->reg];
 
 		u32 value;
-		RBT_ErrorCode err = rbt_bus_load(cpu->bus, size, addr, &value);
+		RBT_ErrorCode err = _bus_load(cpu->bus, size, addr, &value);
 		if (err)
 			return err;
 
 		*out = value;
 
-		if (ea->indirect == 7 && size == RBT_SIZE_BYTE)
-			cpu->state.gpr.addr[ea->indirect] += 2;
+		if (ea->reg == 7 && size == RBT_SIZE_BYTE)
+			cpu->state.gpr.addr[ea->reg] += 2;
 		else
-			cpu->state.gpr.addr[ea->indirect] += (u32)size;
+			cpu->state.gpr.addr[ea->reg] += (u32)size;
 	} break;
-	case RBT_EA_INDIRECT_PREDEC: {
-		if (ea->indirect == 7 && size == RBT_SIZE_BYTE)
-			cpu->state.gpr.addr[ea->indirect] -= 2;
+	case _EA_PREDEC: {
+		if (ea->reg == 7 && size == RBT_SIZE_BYTE)
+			cpu->state.gpr.addr[ea->reg] -= 2;
 		else
-			cpu->state.gpr.addr[ea->indirect] -= (u32)size;
+			cpu->state.gpr.addr[ea->reg] -= (u32)size;
 
-		u32 addr = cpu->state.gpr.addr[ea->indirect];
+		u32 addr = cpu->state.gpr.addr[ea->reg];
 		u32 value;
-		RBT_ErrorCode err = rbt_bus_load(cpu->bus, size, addr, &value);
+		RBT_ErrorCode err = _bus_load(cpu->bus, size, addr, &value);
 		if (err)
 			return err;
 
 		*out = value;
 	} break;
-	case RBT_EA_INDIRECT:
-	case RBT_EA_INDIRECT_DISPLACEMENT:
-	case RBT_EA_INDIRECT_INDEXED:
-	case RBT_EA_ABSOLUTE_SHORT:
-	case RBT_EA_ABSOLUTE_LONG:
-	case RBT_EA_PC_DISPLACEMENT:
-	case RBT_EA_PC_INDEXED:			   {
+	case _EA_IND:
+	case _EA_IND_DISP:
+	case _EA_IND_INDEX:
+	case _EA_ABS_W:
+	case _EA_ABS_L:
+	case _EA_PC_DISP:
+	case _EA_PC_INDEX:	 {
 		u32 addr = _ea_compute_address(ea, cpu);
-		RBT_ErrorCode err = rbt_bus_load(cpu->bus, size, addr, out);
+		RBT_ErrorCode err = _bus_load(cpu->bus, size, addr, out);
 		if (err)
 			return err;
 	} break;
-	case RBT_EA_IMMEDIATE: //
-		*out = ea->imm;
-		break;
-	case RBT_EA_DISPLACEMENT: //
-		*out = (u32)ea->disp;
+	case _EA_IMM:
+	case _EA_DISPLACEMENT: //
+		*out = ea->value;
 		break;
-	case RBT_EA_REGISTER_SR: //
-		*out = _pack_status_register(&cpu->state.sr);
+	case _EA_SR: //
+		_cpu_sync_ccr(cpu);
+		*out = cpu->state.sr;
 		break;
-	case RBT_EA_REGISTER_CCR: //
+	case _EA_CCR: //
 		// Only read lower byte from status register
-		*out = _pack_status_register(&cpu->state.sr) & 0xff;
+		_cpu_sync_ccr(cpu);
+		*out = cpu->state.sr & 0xff;
 		break;
-	case RBT_EA_REGISTER_USP: //
+	case _EA_USP: //
 		*out = cpu->state.usp;
 		break;
-	case RBT_EA_REGISTER_DFC: //
+	case _EA_DFC: //
 		*out = cpu->state.dfc;
 		break;
-	case RBT_EA_REGISTER_SFC: //
+	case _EA_SFC: //
 		*out = cpu->state.sfc;
 		break;
-	case RBT_EA_REGISTER_VBR: //
+	case _EA_VBR: //
 		*out = cpu->state.vbr;
 		break;
 	default: //
@@ -330,92 +375,90 @@ RBT_ErrorCode _ea_read(
 }
 
 RBT_ErrorCode _ea_write(
-	const RBT_EffectiveAddress *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 in
+	const RBT_PackedOperand *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 in
 ) {
 	assert(ea);
 	assert(cpu);
 
 	switch (ea->mode) {
-	case RBT_EA_DIRECT_DATA: {
+	case _EA_DN: {
 		u32 *dreg = &cpu->state.gpr.data[ea->reg];
 		*dreg = rbt_store_sized(size, *dreg, in);
 	} break;
-	case RBT_EA_DIRECT_ADDR: //
+	case _EA_AN: //
 		cpu->state.gpr.addr[ea->reg] = in;
 		break;
-	case RBT_EA_INDIRECT_POSTINC: {
-		u32 addr = cpu->state.gpr.addr[ea->indirect];
+	case _EA_POSTINC: {
+		u32 addr = cpu->state.gpr.addr[ea->reg];
 
-		RBT_ErrorCode err = rbt_bus_store(cpu->bus, size, addr, in);
+		RBT_ErrorCode err = _bus_store(cpu->bus, size, addr, in);
 		if (err)
 			return err;
 
-		if (ea->indirect == 7 && size == RBT_SIZE_BYTE)
-			cpu->state.gpr.addr[ea->indirect] += 2;
+		if (ea->reg == 7 && size == RBT_SIZE_BYTE)
+			cpu->state.gpr.addr[ea->reg] += 2;
 		else
-			cpu->state.gpr.addr[ea->indirect] += (u32)size;
+			cpu->state.gpr.addr[ea->reg] += (u32)size;
 	} break;
-	case RBT_EA_INDIRECT_PREDEC: {
-		if (ea->indirect == 7 && size == RBT_SIZE_BYTE)
-			cpu->state.gpr.addr[ea->indirect] -= 2;
+	case _EA_PREDEC: {
+		if (ea->reg == 7 && size == RBT_SIZE_BYTE)
+			cpu->state.gpr.addr[ea->reg] -= 2;
 		else
-			cpu->state.gpr.addr[ea->indirect] -= (u32)size;
+			cpu->state.gpr.addr[ea->reg] -= (u32)size;
 
-		u32 addr = cpu->state.gpr.addr[ea->indirect];
-		RBT_ErrorCode err = rbt_bus_store(cpu->bus, size, addr, in);
+		u32 addr = cpu->state.gpr.addr[ea->reg];
+		RBT_ErrorCode err = _bus_store(cpu->bus, size, addr, in);
 		if (err)
 			return err;
 	} break;
-	case RBT_EA_INDIRECT:
-	case RBT_EA_INDIRECT_DISPLACEMENT:
-	case RBT_EA_INDIRECT_INDEXED:	   {
+	case _EA_IND:
+	case _EA_IND_DISP:
+	case _EA_IND_INDEX: {
 		u32 addr = _ea_compute_address(ea, cpu);
-		RBT_ErrorCode err = rbt_bus_store(cpu->bus, size, addr, in);
+		RBT_ErrorCode err = _bus_store(cpu->bus, size, addr, in);
 		if (err)
 			return err;
 	} break;
-	case RBT_EA_ABSOLUTE_SHORT:
-	case RBT_EA_ABSOLUTE_LONG:
+	case _EA_ABS_W:
+	case _EA_ABS_L:
 		_push_error(
-			RBT_ERR_DECODE_ILLEGAL_EA,
-			"EA: Absolute address is not alterable, at: 0x%06x", ea->start_pc
+			RBT_ERR_DECODE_ILLEGAL_EA, "EA: Absolute address is not alterable: 0x%06x",
+			ea->value
 		);
 		return RBT_ERR_DECODE_ILLEGAL_EA;
-	case RBT_EA_PC_DISPLACEMENT:
-	case RBT_EA_PC_INDEXED:
+	case _EA_PC_DISP:
+	case _EA_PC_INDEX:
 		_push_error(
-			RBT_ERR_DECODE_ILLEGAL_EA, "EA: PC-relative is not alterable, at: 0x%06x",
-			ea->start_pc
+			RBT_ERR_DECODE_ILLEGAL_EA, "EA: PC-relative is not alterable, from: 0x%06x",
+			ea->value
 		);
 		return RBT_ERR_DECODE_ILLEGAL_EA;
-	case RBT_EA_IMMEDIATE: //
-		_push_error(
-			RBT_ERR_DECODE_ILLEGAL_EA, "EA: Immediate is not alterable, at: 0x%06x",
-			ea->start_pc
-		);
+	case _EA_IMM: //
+		_push_error(RBT_ERR_DECODE_ILLEGAL_EA, "EA: Immediate is not alterable");
 		return RBT_ERR_DECODE_ILLEGAL_EA;
-	case RBT_EA_DISPLACEMENT: //
+	case _EA_DISPLACEMENT: //
 		return RBT_ERR_DECODE_ILLEGAL_EA;
-	case RBT_EA_REGISTER_SR: //
-		_unpack_status_register(&cpu->state.sr, (u16)in);
+	case _EA_SR: //
+		_cpu_write_sr(cpu, (u16)in);
 		break;
-	case RBT_EA_REGISTER_CCR: {
+	case _EA_CCR: {
 		// Keep high byte from status register, only modify lower byte
-		u16 sr = _pack_status_register(&cpu->state.sr) & 0xff00;
-		u16 ccr = in & 0x00ff;
+		_cpu_sync_ccr(cpu);
+		u16 sr = cpu->state.sr & 0xff00;
+		u16 ccr = in & RBT_SR_CCR;
 
-		_unpack_status_register(&cpu->state.sr, sr | ccr);
+		cpu->state.sr = sr | ccr;
 	} break;
-	case RBT_EA_REGISTER_USP: //
+	case _EA_USP: //
 		cpu->state.usp = in;
 		break;
-	case RBT_EA_REGISTER_DFC: //
+	case _EA_DFC: //
 		cpu->state.dfc = in;
 		break;
-	case RBT_EA_REGISTER_SFC: //
+	case _EA_SFC: //
 		cpu->state.sfc = in;
 		break;
-	case RBT_EA_REGISTER_VBR: //
+	case _EA_VBR: //
 		cpu->state.vbr = in;
 		break;
 	default: //
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "cpu/packed_instr.h"
 #include "rbt/basic_types.h"
 #include "rbt/cpu/bus.h"
 #include "rbt/cpu/cpu.h"
@@ -36,11 +37,14 @@ u32 _ea_decode(
 	RBT_EffectiveAddress *ea
 );
 
-u32 _ea_compute_address(const RBT_EffectiveAddress *ea, RBT_Cpu *cpu);
+// Resolves what can be resolved of `ea` without the CPU state
+void _ea_pack(const RBT_EffectiveAddress *ea, RBT_PackedOperand *out);
+
+u32 _ea_compute_address(const RBT_PackedOperand *ea, RBT_Cpu *cpu);
 
 RBT_ErrorCode _ea_read(
-	const RBT_EffectiveAddress *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 *out
+	const RBT_PackedOperand *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 *out
 );
 RBT_ErrorCode _ea_write(
-	const RBT_EffectiveAddress *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 in
+	const RBT_PackedOperand *ea, RBT_OperandSize size, RBT_Cpu *cpu, u32 in
 );
@@ -0,0 +1,165 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "rbt/cpu/irq.h"
+
+#include "cpu/cpu_internal.h"
+#include "cpu/irq_internal.h"
+#include "error.h"
+#include "rbt/basic_types.h"
+#include "rbt/error_codes.h"
+#include "rbt/helpers.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const u8 _irq_default_levels[RBT_IRQ_SOURCE_COUNT] = {
+	[RBT_IRQ_VDP_HBLANK] = 6,
+	[RBT_IRQ_VDP_LINE] = 6,
+	[RBT_IRQ_VDP_VBLANK] = 5,
+	[RBT_IRQ_VDP_BLITTER] = 4,
+	[RBT_IRQ_IO_SNES] = 3,
+	[RBT_IRQ_IO_PS2] = 3,
+	[RBT_IRQ_EXT0] = 2,
+	[RBT_IRQ_EXT1] = 2,
+	[RBT_IRQ_EXT2] = 2,
+	[RBT_IRQ_EXT3] = 2,
+};
+
+RBT_IrqController *rbt_create_irq_controller(void) {
+	RBT_IrqController *irq = malloc(sizeof(RBT_IrqController));
+	if (!irq) {
+		_push_fatal(
+			RBT_ERR_SYS_OUT_OF_MEMORY,
+			"Failed to allocate memory for interrupt controller object"
+		);
+		return nullptr;
+	}
+	_irq_setup(irq);
+
+	return irq;
+}
+
+void _irq_setup(RBT_IrqController *irq) {
+	assert(irq);
+
+	memset(irq, 0, sizeof(RBT_IrqController));
+	for (u32 source = 0; source < RBT_IRQ_SOURCE_COUNT; source += 1) {
+		u8 level = _irq_default_levels[source];
+		irq->levels[source] = level;
+		irq->level_sources[level] |= 1u << source;
+	}
+}
+
+void rbt_destroy_irq_controller(RBT_IrqController *irq) {
+	if (!irq)
+		return;
+	if (irq->cpu)
+		rbt_cpu_attach_irq_controller(irq->cpu, nullptr);
+	free(irq);
+}
+
+void rbt_irq_set_level(RBT_IrqController *irq, RBT_IrqSource source, u8 level) {
+	assert(irq);
+	assert(source < RBT_IRQ_SOURCE_COUNT);
+	assert(level < _IRQ_LEVEL_COUNT);
+
+	irq->level_sources[irq->levels[source]] &= ~(1u << source);
+	irq->level_sources[level] |= 1u << source;
+	irq->levels[source] = level;
+	_irq_update_lines(irq);
+}
+
+u8 rbt_irq_level(const RBT_IrqController *irq, RBT_IrqSource source) {
+	assert(irq);
+	assert(source < RBT_IRQ_SOURCE_COUNT);
+	return irq->levels[source];
+}
+
+void rbt_irq_set_ack_callback(
+	RBT_IrqController *irq, RBT_IrqSource source, RBT_IrqAckCallback callback,
+	void *userdata
+) {
+	assert(irq);
+	assert(source < RBT_IRQ_SOURCE_COUNT);
+	irq->handlers[source] = (RBT_IrqHandler) { callback, userdata };
+}
+
+void rbt_irq_raise(RBT_IrqController *irq, RBT_IrqSource source) {
+	assert(irq);
+	assert(source < RBT_IRQ_SOURCE_COUNT);
+
+	irq->raised |= 1u << source;
+	_irq_update_lines(irq);
+}
+
+void rbt_irq_lower(RBT_IrqController *irq, RBT_IrqSource source) {
+	assert(irq);
+	assert(source < RBT_IRQ_SOURCE_COUNT);
+
+	irq->raised &= ~(1u << source);
+	_irq_update_lines(irq);
+}
+
+bool rbt_irq_is_raised(const RBT_IrqController *irq, RBT_IrqSource source) {
+	assert(irq);
+	assert(source < RBT_IRQ_SOURCE_COUNT);
+	return (irq->raised >> source) & 1u;
+}
+
+void _irq_update_lines(RBT_IrqController *irq) {
+	assert(irq);
+
+	u8 lines = 0;
+	for (u32 level = 1; level < _IRQ_LEVEL_COUNT; level += 1) {
+		if (irq->raised & irq->level_sources[level])
+			lines |= 1u << level;
+	}
+
+	// Most updates don't change any line, skip the atomic then
+	if (lines == irq->lines || !irq->cpu)
+		return;
+
+	irq->lines = lines;
+	_cpu_drive_irq_lines(
+		irq->cpu, (u32)_CPU_IRQ_LEVEL_MASK << _CPU_IRQ_CTRL_SHIFT,
+		(u32)lines << _CPU_IRQ_CTRL_SHIFT
+	);
+}
+
+u8 _irq_acknowledge(RBT_IrqController *irq, u8 level) {
+	assert(irq);
+	assert(level >= 1 && level < _IRQ_LEVEL_COUNT);
+
+	// The source went away before the IACK cycle
+	u32 sources = irq->raised & irq->level_sources[level];
+	if (!sources)
+		return _VEC_SPURIOUS;
+
+	RBT_IrqSource source = (RBT_IrqSource)rbt_ctz_u32(sources);
+	const RBT_IrqHandler *handler = &irq->handlers[source];
+	if (!handler->callback)
+		return _VEC_AUTOVEC_L1 + (level - 1);
+
+	u16 vector = handler->callback(handler->userdata, source);
+	if (vector == RBT_IRQ_AUTOVECTOR)
+		return _VEC_AUTOVEC_L1 + (level - 1);
+
+	assert(vector <= _VEC_USER_LAST);
+	return (u8)vector;
+}
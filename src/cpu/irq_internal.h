@@ -0,0 +1,51 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "rbt/basic_types.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/irq.h"
+
+enum {
+	_IRQ_LEVEL_COUNT = 8, // Level 0 means no interrupt
+};
+
+typedef struct RBT_IrqHandler {
+	RBT_IrqAckCallback callback;
+	void *userdata;
+} RBT_IrqHandler;
+
+typedef struct RBT_IrqController {
+	RBT_Cpu *cpu; // Receives the IPL lines, may be null
+
+	u32 raised;							 // Bit per RBT_IrqSource
+	u32 level_sources[_IRQ_LEVEL_COUNT]; // Sources wired to each level
+	u8 levels[RBT_IRQ_SOURCE_COUNT];
+	u8 lines; // Bit per level, as last driven into the CPU
+	RBT_IrqHandler handlers[RBT_IRQ_SOURCE_COUNT];
+} RBT_IrqController;
+
+// Initializes a controller living in memory the caller owns
+void _irq_setup(RBT_IrqController *irq);
+
+// Drives the controller's lines into the attached CPU
+void _irq_update_lines(RBT_IrqController *irq);
+
+// Runs the IACK cycle for `level`: picks the first raised source wired to it
+// and returns the vector number the CPU has to take.
+[[nodiscard]] u8 _irq_acknowledge(RBT_IrqController *irq, u8 level);
@@ -0,0 +1,191 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "rbt/cpu/machine.h"
+
+#include "cpu/bus_internal.h"
+#include "cpu/cpu_internal.h"
+#include "cpu/irq_internal.h"
+#include "cpu/scheduler_internal.h"
+#include "error.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/error_codes.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#	include <sys/mman.h>
+#endif
+
+enum {
+	_MACHINE_CACHE_LINE = 64,
+	_MACHINE_PAGE = 4 * 1024,			  // RAM starts on its own page
+	_MACHINE_HUGE_PAGE = 2 * 1024 * 1024, // x86-64 and AArch64 with 4KB pages
+};
+
+typedef struct RBT_Machine {
+	RBT_Cpu *cpu;
+	RBT_MemoryBus *bus;
+	RBT_IrqController *irq;
+	RBT_Scheduler *sched;
+
+	RBT_Allocator allocator;
+	usize size; // Of the whole block, the machine included
+} RBT_Machine;
+
+// Offsets of each part in the block
+typedef struct RBT_MachineLayout {
+	usize cpu;
+	usize bus;
+	usize irq;
+	usize sched;
+	usize ram;
+	usize rom;
+	usize size;
+} RBT_MachineLayout;
+
+[[nodiscard]] static inline usize _machine_align(usize offset, usize alignment) {
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+// Appends `size` bytes at the next multiple of `alignment`, returns their offset
+static usize _machine_place(usize *offset, usize size, usize alignment) {
+	usize at = _machine_align(*offset, alignment);
+	*offset = at + size;
+	return at;
+}
+
+// The hot structures go first, the CPU right after the machine header. The size
+// is rounded up to `alignment`, as aligned_alloc() wants.
+static RBT_MachineLayout _machine_layout(usize ram_size, usize alignment) {
+	RBT_MachineLayout layout;
+	usize offset = sizeof(RBT_Machine);
+
+	layout.cpu = _machine_place(&offset, sizeof(RBT_Cpu), _MACHINE_CACHE_LINE);
+	layout.bus = _machine_place(&offset, sizeof(RBT_MemoryBus), _MACHINE_CACHE_LINE);
+	layout.irq = _machine_place(&offset, sizeof(RBT_IrqController), _MACHINE_CACHE_LINE);
+	layout.sched = _machine_place(&offset, sizeof(RBT_Scheduler), _MACHINE_CACHE_LINE);
+	layout.ram = _machine_place(&offset, ram_size, _MACHINE_PAGE);
+	layout.rom = _machine_place(&offset, _BUS_ROM_SIZE, _MACHINE_PAGE);
+	layout.size = _machine_align(offset, alignment);
+
+	return layout;
+}
+
+static void *_machine_default_alloc(void *userdata, usize size, usize alignment) {
+	(void)userdata;
+#ifdef _MSC_VER
+	return _aligned_malloc(size, alignment);
+#else
+	return aligned_alloc(alignment, size);
+#endif
+}
+
+static void _machine_default_free(void *userdata, void *block, usize size) {
+	(void)userdata;
+	(void)size;
+#ifdef _MSC_VER
+	_aligned_free(block);
+#else
+	free(block);
+#endif
+}
+
+static const RBT_Allocator _machine_default_allocator = {
+	.alloc = _machine_default_alloc,
+	.free = _machine_default_free,
+};
+
+RBT_Machine *rbt_create_machine(const RBT_MachineConfig *cfg) {
+	assert(cfg);
+
+	const RBT_Allocator *allocator = cfg->allocator;
+	if (!allocator)
+		allocator = &_machine_default_allocator;
+	assert(allocator->alloc && allocator->free);
+
+	usize ram_size = _bus_ram_size(&cfg->bus);
+	if (ram_size == 0)
+		return nullptr;
+
+	usize alignment = cfg->huge_pages ? _MACHINE_HUGE_PAGE : _MACHINE_PAGE;
+	RBT_MachineLayout layout = _machine_layout(ram_size, alignment);
+	u8 *block = allocator->alloc(allocator->userdata, layout.size, alignment);
+	if (!block) {
+		_push_fatal(RBT_ERR_SYS_OUT_OF_MEMORY, "Failed to allocate RBT_Machine");
+		return nullptr;
+	}
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	// Only a hint, the block still works with regular pages
+	if (cfg->huge_pages)
+		madvise(block, layout.size, MADV_HUGEPAGE);
+#endif
+
+	RBT_Machine *machine = (RBT_Machine *)block;
+	*machine = (RBT_Machine) {
+		.cpu = (RBT_Cpu *)(block + layout.cpu),
+		.bus = (RBT_MemoryBus *)(block + layout.bus),
+		.irq = (RBT_IrqController *)(block + layout.irq),
+		.sched = (RBT_Scheduler *)(block + layout.sched),
+		.allocator = *allocator,
+		.size = layout.size,
+	};
+
+	_cpu_setup(machine->cpu, &cfg->cpu);
+	_bus_setup(machine->bus, &cfg->bus, block + layout.ram, block + layout.rom);
+	_irq_setup(machine->irq);
+	_sched_setup(machine->sched);
+
+	rbt_cpu_attach_bus(machine->cpu, machine->bus);
+	rbt_cpu_attach_irq_controller(machine->cpu, machine->irq);
+	return machine;
+}
+
+void rbt_destroy_machine(RBT_Machine *machine) {
+	if (!machine)
+		return;
+
+	_cpu_teardown(machine->cpu);
+	_bus_teardown(machine->bus);
+
+	RBT_Allocator allocator = machine->allocator;
+	allocator.free(allocator.userdata, machine, machine->size);
+}
+
+RBT_Cpu *rbt_machine_cpu(RBT_Machine *machine) {
+	assert(machine);
+	return machine->cpu;
+}
+
+RBT_MemoryBus *rbt_machine_bus(RBT_Machine *machine) {
+	assert(machine);
+	return machine->bus;
+}
+
+RBT_IrqController *rbt_machine_irq(RBT_Machine *machine) {
+	assert(machine);
+	return machine->irq;
+}
+
+RBT_Scheduler *rbt_machine_scheduler(RBT_Machine *machine) {
+	assert(machine);
+	return machine->sched;
+}
@@ -0,0 +1,79 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "rbt/basic_types.h"
+#include "rbt/cpu/types.h"
+
+// Executable form of an RBT_Instruction, as kept in the decode cache. Operands
+// are resolved as far as they can be without the CPU state: PC-relative modes
+// hold their base address and branch targets their displacement. The decoder's
+// RBT_Instruction remains the view for debug hooks and the disassembler.
+
+// Address mode of a packed operand: the bit index of its RBT_AddressMode plus one
+typedef enum RBT_PackedMode {
+	_EA_NONE,
+	_EA_DN,
+	_EA_AN,
+	_EA_IND,
+	_EA_POSTINC,
+	_EA_PREDEC,
+	_EA_IND_DISP,
+	_EA_IND_INDEX,
+	_EA_ABS_W,
+	_EA_ABS_L,
+	_EA_PC_DISP,
+	_EA_PC_INDEX,
+	_EA_IMM,
+	_EA_DISPLACEMENT,
+	_EA_CCR,
+	_EA_SR,
+	_EA_USP,
+	_EA_DFC,
+	_EA_SFC,
+	_EA_VBR,
+} RBT_PackedMode;
+
+enum {
+	_EA_INDEX_REG = 0x0f,  // Index register, as an index into `gpr.flat`
+	_EA_INDEX_LONG = 0x10, // Index register is used as a long
+};
+
+typedef struct RBT_PackedOperand {
+	u32 value; // Displacement, absolute or base address, immediate
+	u8 mode;   // RBT_PackedMode
+	u8 reg;	   // Dn/An, or An of the indirect modes
+	u8 index;  // Indexed modes, see _EA_INDEX_*
+} RBT_PackedOperand;
+
+typedef struct RBT_PackedInstr {
+	u32 start_pc;
+	u16 opcode;
+	u16 aux; // Condition, register list or extension word
+	u8 mnemonic;
+	u8 size;
+	u8 len;
+	u8 ea_cycles; // Time selected by the operands, see _timing_ea_cycles()
+	RBT_PackedOperand src;
+	RBT_PackedOperand dst;
+} RBT_PackedInstr;
+
+// The mode bit of RBT_AddressMode a packed mode stands for
+[[nodiscard]] static inline u32 _packed_mode_bit(u8 mode) {
+	return (1u << mode) >> 1;
+}
@@ -0,0 +1,212 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "cpu/rom_image.h"
+
+#include "cpu/bus_internal.h"
+#include "error.h"
+#include "rbt/basic_types.h"
+#include "rbt/error_codes.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+
+typedef struct RBT_RomImage {
+	struct RBT_RomImage *next;
+	u32 refs;
+
+	// Identifies the file, a rewritten one gets a mapping of its own
+	u64 dev;
+	u64 ino;
+	i64 size;
+	i64 mtime;
+
+	u8 *data; // _BUS_ROM_SIZE bytes
+} RBT_RomImage;
+
+// Only held to walk and relink the list, never across system calls or allocations,
+// a spinlock is enough
+static atomic_flag _rom_images_lock = ATOMIC_FLAG_INIT;
+static RBT_RomImage *_rom_images;
+
+static void _rom_images_acquire_lock(void) {
+	while (atomic_flag_test_and_set_explicit(&_rom_images_lock, memory_order_acquire)) {
+	}
+}
+
+static void _rom_images_release_lock(void) {
+	atomic_flag_clear_explicit(&_rom_images_lock, memory_order_release);
+}
+
+static RBT_RomImage *_rom_image_find(const struct stat *st) {
+	for (RBT_RomImage *image = _rom_images; image; image = image->next) {
+		if (image->dev == (u64)st->st_dev && image->ino == (u64)st->st_ino
+			&& image->size == (i64)st->st_size && image->mtime == (i64)st->st_mtime) {
+			return image;
+		}
+	}
+
+	return nullptr;
+}
+
+// Zero-filled reservation for the whole ROM with the file mapped over its start,
+// so reads past the end of a short file don't fault
+static u8 *_rom_image_map(int fd, usize size) {
+	u8 *data = mmap(
+		nullptr, _BUS_ROM_SIZE, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+	);
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	if (mmap(data, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(data, _BUS_ROM_SIZE);
+		return nullptr;
+	}
+
+	return data;
+}
+
+RBT_ErrorCode _rom_image_acquire(const char *filename, RBT_RomImage **out) {
+	assert(filename);
+	assert(out);
+
+	int fd = open(filename, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		_push_error(RBT_ERR_SYS_IO, "Failed to open ROM file at: %s", filename);
+		return RBT_ERR_SYS_IO;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		_push_error(RBT_ERR_SYS_IO, "Unable to read ROM file: %s", filename);
+		close(fd);
+		return RBT_ERR_SYS_IO;
+	}
+
+	_rom_images_acquire_lock();
+	RBT_RomImage *shared = _rom_image_find(&st);
+	if (shared)
+		shared->refs += 1;
+	_rom_images_release_lock();
+
+	if (shared) {
+		close(fd);
+		*out = shared;
+		return RBT_ERR_SUCCESS;
+	}
+
+	usize size = (usize)st.st_size;
+	if (size > _BUS_ROM_SIZE) {
+		_push_warn("ROM truncated: size %zu exceeds max %u", size, _BUS_ROM_SIZE);
+		size = _BUS_ROM_SIZE;
+	}
+
+	RBT_RomImage *image = malloc(sizeof(RBT_RomImage));
+	u8 *data = image ? _rom_image_map(fd, size) : nullptr;
+	close(fd); // The mapping keeps the file alive
+	if (!image) {
+		_push_fatal(RBT_ERR_SYS_OUT_OF_MEMORY, "Failed to allocate RBT_RomImage");
+		return RBT_ERR_SYS_OUT_OF_MEMORY;
+	}
+	if (!data) {
+		_push_error(RBT_ERR_SYS_IO, "Unable to map ROM file: %s", filename);
+		free(image);
+		return RBT_ERR_SYS_IO;
+	}
+
+	*image = (RBT_RomImage) {
+		.refs = 1,
+		.dev = (u64)st.st_dev,
+		.ino = (u64)st.st_ino,
+		.size = (i64)st.st_size,
+		.mtime = (i64)st.st_mtime,
+		.data = data,
+	};
+
+	// Another bus may have mapped the same file in the meantime, keep its image
+	_rom_images_acquire_lock();
+	shared = _rom_image_find(&st);
+	if (shared) {
+		shared->refs += 1;
+	} else {
+		image->next = _rom_images;
+		_rom_images = image;
+	}
+	_rom_images_release_lock();
+
+	if (shared) {
+		munmap(data, _BUS_ROM_SIZE);
+		free(image);
+		image = shared;
+	}
+
+	*out = image;
+	return RBT_ERR_SUCCESS;
+}
+
+void _rom_image_release(RBT_RomImage *image) {
+	if (!image)
+		return;
+
+	_rom_images_acquire_lock();
+
+	assert(image->refs > 0);
+	image->refs -= 1;
+	bool is_unused = image->refs == 0;
+	if (is_unused) {
+		RBT_RomImage **link = &_rom_images;
+		while (*link != image) {
+			link = &(*link)->next;
+		}
+		*link = image->next;
+	}
+
+	_rom_images_release_lock();
+
+	if (is_unused) {
+		munmap(image->data, _BUS_ROM_SIZE);
+		free(image);
+	}
+}
+
+const u8 *_rom_image_data(const RBT_RomImage *image) {
+	assert(image);
+	return image->data;
+}
+#else
+RBT_ErrorCode _rom_image_acquire(const char *filename, RBT_RomImage **out) {
+	(void)filename;
+	(void)out;
+	return RBT_ERR_UNIMPLEMENTED;
+}
+
+void _rom_image_release(RBT_RomImage *image) {
+	assert(!image);
+}
+
+const u8 *_rom_image_data(const RBT_RomImage *image) {
+	(void)image;
+	unreachable();
+}
+#endif
@@ -0,0 +1,33 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "rbt/basic_types.h"
+#include "rbt/error_codes.h"
+
+// Read-only, private mapping of a ROM file, shared by every bus of the process
+// that loaded the same file
+typedef struct RBT_RomImage RBT_RomImage;
+
+// Maps `filename` or takes another reference to its existing mapping. The image
+// exposes _BUS_ROM_SIZE bytes, zero past the end of the file. Returns
+// RBT_ERR_UNIMPLEMENTED without reporting anything where files can't be mapped.
+RBT_ErrorCode _rom_image_acquire(const char *filename, RBT_RomImage **out);
+void _rom_image_release(RBT_RomImage *image);
+
+[[nodiscard]] const u8 *_rom_image_data(const RBT_RomImage *image);
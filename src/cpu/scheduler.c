@@ -0,0 +1,192 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+#include "rbt/cpu/scheduler.h"
+
+#include "cpu/scheduler_internal.h"
+#include "error.h"
+#include "rbt/basic_types.h"
+#include "rbt/error_codes.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+[[nodiscard]] static inline bool _event_before(const RBT_Event *a, const RBT_Event *b) {
+	if (a->cycle != b->cycle)
+		return a->cycle < b->cycle;
+	return (i32)(a->seq - b->seq) < 0; // Wrap-around safe
+}
+
+static void _sched_sift_up(RBT_Scheduler *sched, usize index) {
+	RBT_Event event = sched->heap[index];
+
+	while (index > 0) {
+		usize parent = (index - 1) / 2;
+		if (!_event_before(&event, &sched->heap[parent]))
+			break;
+
+		sched->heap[index] = sched->heap[parent];
+		index = parent;
+	}
+
+	sched->heap[index] = event;
+}
+
+static void _sched_sift_down(RBT_Scheduler *sched, usize index) {
+	RBT_Event event = sched->heap[index];
+
+	for (;;) {
+		usize child = (index * 2) + 1;
+		if (child >= sched->count)
+			break;
+
+		if (child + 1 < sched->count
+			&& _event_before(&sched->heap[child + 1], &sched->heap[child])) {
+			child += 1;
+		}
+		if (!_event_before(&sched->heap[child], &event))
+			break;
+
+		sched->heap[index] = sched->heap[child];
+		index = child;
+	}
+
+	sched->heap[index] = event;
+}
+
+static void _sched_remove_at(RBT_Scheduler *sched, usize index) {
+	sched->count -= 1;
+	if (index == sched->count)
+		return;
+
+	sched->heap[index] = sched->heap[sched->count];
+	if (index > 0 && _event_before(&sched->heap[index], &sched->heap[(index - 1) / 2]))
+		_sched_sift_up(sched, index);
+	else
+		_sched_sift_down(sched, index);
+}
+
+[[nodiscard]] RBT_Scheduler *rbt_create_scheduler(void) {
+	RBT_Scheduler *sched = malloc(sizeof(RBT_Scheduler));
+	if (!sched) {
+		_push_fatal(RBT_ERR_SYS_OUT_OF_MEMORY, "Failed to allocate RBT_Scheduler");
+		return nullptr;
+	}
+	_sched_setup(sched);
+
+	return sched;
+}
+
+void _sched_setup(RBT_Scheduler *sched) {
+	assert(sched);
+
+	memset(sched, 0, sizeof(RBT_Scheduler));
+	sched->next_id = RBT_EVENT_NONE + 1;
+}
+
+void rbt_destroy_scheduler(RBT_Scheduler *sched) {
+	if (!sched)
+		return;
+	free(sched);
+}
+
+u64 rbt_sched_now(const RBT_Scheduler *sched) {
+	assert(sched);
+	return sched->now;
+}
+
+u64 rbt_sched_until_next(const RBT_Scheduler *sched) {
+	assert(sched);
+
+	if (sched->count == 0)
+		return UINT64_MAX;
+
+	u64 cycle = sched->heap[0].cycle;
+	return cycle > sched->now ? cycle - sched->now : 0;
+}
+
+RBT_EventId rbt_sched_at(
+	RBT_Scheduler *sched, u64 cycle, RBT_EventCallback callback, void *userdata
+) {
+	assert(sched);
+	assert(callback);
+
+	if (sched->count >= _SCHED_MAX_EVENTS) {
+		_push_error(
+			RBT_ERR_SYS_OUT_OF_MEMORY, "Scheduler is full: %u events pending",
+			_SCHED_MAX_EVENTS
+		);
+		return RBT_EVENT_NONE;
+	}
+
+	RBT_EventId id = sched->next_id;
+	sched->next_id += 1;
+	if (sched->next_id == RBT_EVENT_NONE)
+		sched->next_id += 1;
+
+	sched->heap[sched->count] = (RBT_Event) {
+		.cycle = cycle,
+		.seq = sched->next_seq,
+		.id = id,
+		.callback = callback,
+		.userdata = userdata,
+	};
+	sched->next_seq += 1;
+	sched->count += 1;
+	_sched_sift_up(sched, sched->count - 1);
+
+	return id;
+}
+
+RBT_EventId rbt_sched_in(
+	RBT_Scheduler *sched, u64 delay, RBT_EventCallback callback, void *userdata
+) {
+	assert(sched);
+	return rbt_sched_at(sched, sched->now + delay, callback, userdata);
+}
+
+bool rbt_sched_cancel(RBT_Scheduler *sched, RBT_EventId id) {
+	assert(sched);
+
+	for (usize i = 0; i < sched->count; i += 1) {
+		if (sched->heap[i].id == id) {
+			_sched_remove_at(sched, i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+RBT_ErrorCode rbt_sched_advance(RBT_Scheduler *sched, u64 cycles) {
+	assert(sched);
+
+	sched->now += cycles;
+
+	while (sched->count > 0 && sched->heap[0].cycle <= sched->now) {
+		// Taken off the heap first, the callback may schedule into it
+		RBT_Event event = sched->heap[0];
+		_sched_remove_at(sched, 0);
+
+		RBT_ErrorCode err = event.callback(event.userdata, event.cycle);
+		if (err)
+			return err;
+	}
+
+	return RBT_ERR_SUCCESS;
+}
@@ -0,0 +1,45 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "rbt/basic_types.h"
+#include "rbt/cpu/scheduler.h"
+
+enum {
+	_SCHED_MAX_EVENTS = 64,
+};
+
+typedef struct RBT_Event {
+	u64 cycle;
+	u32 seq; // Keeps events on the same cycle in scheduling order
+	RBT_EventId id;
+	RBT_EventCallback callback;
+	void *userdata;
+} RBT_Event;
+
+// Binary min-heap ordered by (cycle, seq)
+typedef struct RBT_Scheduler {
+	u64 now;
+	u32 next_seq;
+	RBT_EventId next_id;
+	usize count;
+	RBT_Event heap[_SCHED_MAX_EVENTS];
+} RBT_Scheduler;
+
+// Initializes a scheduler living in memory the caller owns
+void _sched_setup(RBT_Scheduler *sched);
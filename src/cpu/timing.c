@@ -19,22 +19,159 @@
 
 #include "rbt/basic_types.h"
 #include "rbt/cpu/types.h"
+#include "rbt/helpers.h"
 
 #include <assert.h>
 
-// NOTE: For now, I won't encode cycle accurate fetching. Always assume
-// worst case scenario when calculating cycles. There's no need to be
-// accurate here, but for the future...
-// TODO: Improve cycle timing accuracy.
+// NOTE: Cycle counts come from the tables in docs/m68010_cycles.txt, which
+// don't model prefetch or bus contention. Data dependent timings (MULU/MULS,
+// DIVU/DIVS, bit numbers) always take the worst case.
+
+// source-inline-begin
+#include "cpu/timing.inc" // Generated at build time by tools/gen_timing.c
+// source-inline-end
+
+// How the operands of a mnemonic select a cell of its row
+typedef enum RBT_TimingKey {
+	_TIMING_KEY_SRC,  // Source EA; also for instructions without one
+	_TIMING_KEY_DST,  // Destination EA
+	_TIMING_KEY_DIR,  // Source EA if the destination is a register or list
+	_TIMING_KEY_BIT,  // Destination EA, static forms under the source form
+	_TIMING_KEY_MOVE, // Move grids, special registers in the row
+} RBT_TimingKey;
+
+// clang-format off
+static const u8 _timing_keys[_TIMING_OP_COUNT] = {
+	[RBT_OP_ADD] = _TIMING_KEY_DIR,   [RBT_OP_ADDI] = _TIMING_KEY_DST,
+	[RBT_OP_ADDQ] = _TIMING_KEY_DST,  [RBT_OP_AND] = _TIMING_KEY_DIR,
+	[RBT_OP_ANDI] = _TIMING_KEY_DST,  [RBT_OP_ASL] = _TIMING_KEY_DST,
+	[RBT_OP_ASR] = _TIMING_KEY_DST,   [RBT_OP_BCHG] = _TIMING_KEY_BIT,
+	[RBT_OP_BCLR] = _TIMING_KEY_BIT,  [RBT_OP_BSET] = _TIMING_KEY_BIT,
+	[RBT_OP_BTST] = _TIMING_KEY_BIT,  [RBT_OP_CLR] = _TIMING_KEY_DST,
+	[RBT_OP_CMPI] = _TIMING_KEY_DST,  [RBT_OP_EOR] = _TIMING_KEY_DST,
+	[RBT_OP_EORI] = _TIMING_KEY_DST,  [RBT_OP_JMP] = _TIMING_KEY_DST,
+	[RBT_OP_JSR] = _TIMING_KEY_DST,   [RBT_OP_LSL] = _TIMING_KEY_DST,
+	[RBT_OP_LSR] = _TIMING_KEY_DST,   [RBT_OP_MOVE] = _TIMING_KEY_MOVE,
+	[RBT_OP_MOVEA] = _TIMING_KEY_MOVE, [RBT_OP_MOVEM] = _TIMING_KEY_DIR,
+	[RBT_OP_MOVEQ] = _TIMING_KEY_DST, [RBT_OP_NBCD] = _TIMING_KEY_DST,
+	[RBT_OP_NEG] = _TIMING_KEY_DST,   [RBT_OP_NEGX] = _TIMING_KEY_DST,
+	[RBT_OP_NOT] = _TIMING_KEY_DST,   [RBT_OP_OR] = _TIMING_KEY_DIR,
+	[RBT_OP_ORI] = _TIMING_KEY_DST,   [RBT_OP_ROL] = _TIMING_KEY_DST,
+	[RBT_OP_ROR] = _TIMING_KEY_DST,   [RBT_OP_ROXL] = _TIMING_KEY_DST,
+	[RBT_OP_ROXR] = _TIMING_KEY_DST,  [RBT_OP_Scc] = _TIMING_KEY_DST,
+	[RBT_OP_SUB] = _TIMING_KEY_DIR,   [RBT_OP_SUBI] = _TIMING_KEY_DST,
+	[RBT_OP_SUBQ] = _TIMING_KEY_DST,  [RBT_OP_TAS] = _TIMING_KEY_DST,
+	[RBT_OP_TST] = _TIMING_KEY_DST,   [RBT_OP_MOVEC] = _TIMING_KEY_DIR,
+	[RBT_OP_MOVES] = _TIMING_KEY_DIR,
+};
+
+// Column of each RBT_AddressMode bit, the last entry is RBT_EA_NONE
+static const u8 _timing_columns[20] = {
+	_TIMING_COL_DN,      _TIMING_COL_AN,       _TIMING_COL_IND,   _TIMING_COL_POSTINC,
+	_TIMING_COL_PREDEC,  _TIMING_COL_DISP,     _TIMING_COL_INDEX, _TIMING_COL_ABS_W,
+	_TIMING_COL_ABS_L,   _TIMING_COL_PC_DISP,  _TIMING_COL_PC_INDEX, _TIMING_COL_IMM,
+	_TIMING_COL_DN,      _TIMING_COL_CCR,      _TIMING_COL_SR,    _TIMING_COL_USP,
+	_TIMING_COL_CTRL,    _TIMING_COL_CTRL,     _TIMING_COL_CTRL,  _TIMING_COL_DN,
+};
+
+// Row index of each RBT_OperandSize, unsized instructions use the word row
+static const u8 _timing_sizes[RBT_SIZE_LONG + 1] = { 1, 0, 1, 1, 2 };
+// clang-format on
+
+[[nodiscard]] static inline u32 _timing_column(RBT_AddressMode mode) {
+	return _timing_columns[rbt_ctz_u32((u32)mode | (1u << 19))];
+}
+
+u8 _timing_ea_cycles(const RBT_Instruction *instr, RBT_CpuModel cpu_model) {
+	assert(instr);
+	assert(cpu_model == RBT_CPU_M68000 || cpu_model == RBT_CPU_M68010);
+	assert(instr->mnemonic <= RBT_OP_LINEF && instr->size <= RBT_SIZE_LONG);
+
+	u32 model = cpu_model >> 1;
+	u32 size = _timing_sizes[instr->size];
+	u32 src = _timing_column(instr->src.mode);
+	u32 dst = _timing_column(instr->dst.mode);
+	const RBT_TimingRow *row = &_timing_rows[model][instr->mnemonic][size];
+
+	switch ((RBT_TimingKey)_timing_keys[instr->mnemonic]) {
+	case _TIMING_KEY_SRC: return row->ea[_TIMING_FORM_SRC][src];
+	case _TIMING_KEY_DST: return row->ea[_TIMING_FORM_DST][dst];
+	case _TIMING_KEY_DIR:
+		if (instr->dst.mode & (RBT_EA_GROUP_REG | RBT_EA_IMMEDIATE))
+			return row->ea[_TIMING_FORM_SRC][src];
+		return row->ea[_TIMING_FORM_DST][dst];
+	case _TIMING_KEY_BIT:
+		if (instr->src.mode == RBT_EA_IMMEDIATE)
+			return row->ea[_TIMING_FORM_SRC][dst];
+		return row->ea[_TIMING_FORM_DST][dst];
+	case _TIMING_KEY_MOVE:
+		if (dst >= _TIMING_COL_CCR)
+			return row->ea[_TIMING_FORM_SRC][src];
+		if (src >= _TIMING_COL_CCR)
+			return row->ea[_TIMING_FORM_DST][dst];
+
+		assert(dst < _TIMING_MOVE_DST_COUNT);
+		return _timing_move[model][size][src][dst];
+	}
+
+	unreachable();
+}
+
+u16 _timing_step_cycles(
+	u8 mnemonic, RBT_OperandSize size, u8 ea_cycles, RBT_TimingCtx *ctx,
+	RBT_CpuModel cpu_model
+) {
+	assert(ctx);
+	assert(cpu_model == RBT_CPU_M68000 || cpu_model == RBT_CPU_M68010);
+	assert(mnemonic <= RBT_OP_LINEF && size <= RBT_SIZE_LONG);
+
+	// Only branches and exceptions write the context, most steps leave it clear
+	u32 cycles = ctx->exception_cycles;
+	if (ctx->trapped) {
+		*ctx = (RBT_TimingCtx) { 0 };
+		return (u16)cycles;
+	}
+	ctx->exception_cycles = 0;
+
+	const RBT_TimingRow *row =
+		&_timing_rows[cpu_model >> 1][mnemonic][_timing_sizes[size]];
+	cycles += ea_cycles;
+
+	if (ctx->branch_taken | ctx->counter_expired) {
+		RBT_TimingBranch outcome = ctx->counter_expired ? _TIMING_BRANCH_EXPIRED
+														: _TIMING_BRANCH_TAKEN;
+		cycles += row->branch[outcome];
+		ctx->branch_taken = false;
+		ctx->counter_expired = false;
+	} else {
+		cycles += row->branch[_TIMING_BRANCH_NOT_TAKEN];
+	}
+
+	if (ctx->shift_n | ctx->movem_n) {
+		cycles += row->per_n * (u32)(ctx->shift_n + ctx->movem_n);
+		ctx->shift_n = 0;
+		ctx->movem_n = 0;
+	}
+
+	return (u16)cycles;
+}
 
 u16 _calculate_timing(
 	const RBT_Instruction *instr, const RBT_TimingCtx *ctx, RBT_CpuModel cpu_model
 ) {
 	assert(instr);
-	(void)ctx;
-	(void)cpu_model;
+	assert(ctx);
+
+	if (ctx->trapped)
+		return ctx->exception_cycles;
 
-	u16 cycles = 4; // TODO: Calculate instruction cycles timing
+	RBT_TimingCtx step = *ctx;
+	u8 ea_cycles = _timing_ea_cycles(instr, cpu_model);
+	return _timing_step_cycles(instr->mnemonic, instr->size, ea_cycles, &step, cpu_model);
+}
 
-	return cycles;
+u16 _exception_timing(RBT_TimingException kind, RBT_CpuModel cpu_model) {
+	assert(kind < _TIMING_EXC_COUNT);
+	assert(cpu_model == RBT_CPU_M68000 || cpu_model == RBT_CPU_M68010);
+	return _timing_exceptions[cpu_model >> 1][kind];
 }
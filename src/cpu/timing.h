@@ -21,13 +21,94 @@
 #include "rbt/cpu/types.h"
 
 typedef struct RBT_TimingCtx {
-	bool branch_taken; // for Bcc, DBcc
-	u8 shift_n;		   // for 6+2n
-	u8 movem_n;		   // Popcount (mask)
+	bool branch_taken;	  // for Bcc, DBcc
+	bool counter_expired; // DBcc fell through with the counter at -1
+	bool trapped;		  // Ended in an exception whose time covers the instruction
+	u8 shift_n;			  // for 6+2n
+	u8 movem_n;			  // Popcount (mask)
+	u16 exception_cycles; // Exception processing started during the step
 } RBT_TimingCtx;
 
+// Layout of the tables generated by tools/gen_timing.c into cpu/timing.inc
+enum {
+	_TIMING_MODEL_COUNT = 2,		  // MC68000, MC68010
+	_TIMING_OP_COUNT = RBT_OP_LINEF + 1, // Line A/F take the illegal instruction time
+	_TIMING_SIZE_COUNT = 3,			  // Byte, word, long
+	_TIMING_FORM_COUNT = 2,
+	_TIMING_COL_COUNT = 16,
+	_TIMING_MOVE_SRC_COUNT = 12, // Dn to #imm
+	_TIMING_MOVE_DST_COUNT = 9,	 // Dn to (xxx).l
+};
+
+// Which operand selects the column of a row
+typedef enum RBT_TimingForm {
+	_TIMING_FORM_SRC, // <ea>,Rn; static bit operations
+	_TIMING_FORM_DST, // Rn,<ea>, #imm,<ea> and single operand forms
+} RBT_TimingForm;
+
+// Columns follow the bit order of RBT_AddressMode up to RBT_EA_IMMEDIATE
+typedef enum RBT_TimingColumn {
+	_TIMING_COL_DN,
+	_TIMING_COL_AN,
+	_TIMING_COL_IND,
+	_TIMING_COL_POSTINC,
+	_TIMING_COL_PREDEC,
+	_TIMING_COL_DISP,
+	_TIMING_COL_INDEX,
+	_TIMING_COL_ABS_W,
+	_TIMING_COL_ABS_L,
+	_TIMING_COL_PC_DISP,
+	_TIMING_COL_PC_INDEX,
+	_TIMING_COL_IMM,
+	_TIMING_COL_CCR,
+	_TIMING_COL_SR,
+	_TIMING_COL_USP,
+	_TIMING_COL_CTRL, // DFC, SFC, VBR
+} RBT_TimingColumn;
+
+// Rows of table 9-19 (8-15 on the MC68000)
+typedef enum RBT_TimingException {
+	_TIMING_EXC_ADDR_ERROR,
+	_TIMING_EXC_BUS_ERROR,
+	_TIMING_EXC_CHK,	  // Without the EA time
+	_TIMING_EXC_ZERO_DIV, // Without the EA time
+	_TIMING_EXC_ILLEGAL,
+	_TIMING_EXC_INTERRUPT,
+	_TIMING_EXC_PRIVILEGE,
+	_TIMING_EXC_FMT_ERROR,
+	_TIMING_EXC_TRACE,
+	_TIMING_EXC_TRAP,
+	_TIMING_EXC_TRAPV,
+	_TIMING_EXC_COUNT,
+} RBT_TimingException;
+
+typedef enum RBT_TimingBranch {
+	_TIMING_BRANCH_NOT_TAKEN,
+	_TIMING_BRANCH_TAKEN,
+	_TIMING_BRANCH_EXPIRED, // DBcc counter ran out
+	_TIMING_BRANCH_COUNT,
+} RBT_TimingBranch;
+
+// Total cycles of one mnemonic and size. Cells the instruction can't
+// encode are 0.
+typedef struct RBT_TimingRow {
+	u8 ea[_TIMING_FORM_COUNT][_TIMING_COL_COUNT];
+	u8 per_n;						 // Added per shifted bit or MOVEM register
+	u8 branch[_TIMING_BRANCH_COUNT]; // Bcc, DBcc, BRA, BSR by outcome
+} RBT_TimingRow;
+
 typedef struct RBT_Instruction RBT_Instruction;
 
 u16 _calculate_timing(
 	const RBT_Instruction *instr, const RBT_TimingCtx *ctx, RBT_CpuModel cpu_model
 );
+
+// _calculate_timing() in two halves: the cycles selected by the operands, known
+// at decode time, and the total once the instruction has run. The latter also
+// clears what the step wrote to `ctx`, ready for the next one.
+[[nodiscard]] u8 _timing_ea_cycles(const RBT_Instruction *instr, RBT_CpuModel cpu_model);
+[[nodiscard]] u16 _timing_step_cycles(
+	u8 mnemonic, RBT_OperandSize size, u8 ea_cycles, RBT_TimingCtx *ctx,
+	RBT_CpuModel cpu_model
+);
+[[nodiscard]] u16 _exception_timing(RBT_TimingException kind, RBT_CpuModel cpu_model);
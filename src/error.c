@@ -30,15 +30,41 @@
 #	define __FILE_NAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
 #endif
 
+typedef struct RBT_ErrorRecord {
+	const char *func;
+	const char *file;
+	RBT_ErrorCode code;
+	u32 line;
+	u32 pc;
+	u32 addr;
+	u8 severity; // RBT_ErrorSeverity
+	u8 format;	 // RBT_ErrorFormat
+	bool has_pc;
+	time_t timestamp;			   // _ERR_FMT_MESSAGE only
+	char msg[RBT_ERR_MESSAGE_MAX]; // _ERR_FMT_MESSAGE only
+} RBT_ErrorRecord;
+
+// Ring buffer, the oldest records are overwritten once it's full
 typedef struct RBT_ErrorContext {
-	usize stack_top;
-	RBT_ErrorEntry stack[RBT_ERR_STACK_MAX];
+	usize head; // Next record to write
+	usize count;
+	usize dropped;
+	RBT_ErrorRecord ring[RBT_ERR_STACK_MAX];
+	RBT_ErrorEntry last; // Storage for rbt_query_last_error()
+	const u32 *pc;
 	FILE *stream;
 } RBT_ErrorContext;
 
 static RBT_ErrorSeverity _min_severity = RBT_SEVERITY_INFO;
 static _Thread_local struct RBT_ErrorContext _err_ctx = {};
 
+static const char *const _format_text[_ERR_FMT_COUNT] = {
+	[_ERR_FMT_BUS_ERROR] = "Tried to access invalid address at: 0x%06x",
+	[_ERR_FMT_UNALIGNED] = "Unaligned memory access at: 0x%06x",
+	[_ERR_FMT_ROM_WRITE] = "Write attempt on ROM at: 0x%06x",
+	[_ERR_FMT_UNMAPPED] = "Memory isn't mapped at: 0x%06x",
+};
+
 static const char *const _severity_name[] = {
 	"INFO",
 	"WARN",
@@ -53,6 +79,59 @@ static const char *const _severity_color[] = {
 	"\x1b[35m",
 };
 
+static RBT_ErrorRecord *_err_next_record(
+	RBT_ErrorSeverity severity,
+	RBT_ErrorCode code,
+	const char *func,
+	const char *file,
+	u32 line
+) {
+	RBT_ErrorRecord *record = &_err_ctx.ring[_err_ctx.head];
+	_err_ctx.head = (_err_ctx.head + 1) % RBT_ERR_STACK_MAX;
+
+	if (_err_ctx.count < RBT_ERR_STACK_MAX)
+		_err_ctx.count += 1;
+	else
+		_err_ctx.dropped += 1;
+
+	record->severity = severity;
+	record->code = code;
+	record->func = func;
+	record->file = file;
+	record->line = line;
+	record->has_pc = _err_ctx.pc != nullptr;
+	record->pc = _err_ctx.pc ? *_err_ctx.pc : 0;
+	return record;
+}
+
+static const RBT_ErrorRecord *_err_record_at(usize age) {
+	usize index = (_err_ctx.head + RBT_ERR_STACK_MAX - 1 - age) % RBT_ERR_STACK_MAX;
+	return &_err_ctx.ring[index];
+}
+
+static void _err_format(const RBT_ErrorRecord *record, RBT_ErrorEntry *entry) {
+	entry->severity = record->severity;
+	entry->code = record->code;
+	entry->func = record->func;
+	entry->file = record->file;
+	entry->line = record->line;
+	entry->timestamp = record->timestamp;
+
+	if (record->format == _ERR_FMT_MESSAGE) {
+		memcpy(entry->msg, record->msg, RBT_ERR_MESSAGE_MAX);
+		return;
+	}
+
+	i32 len = snprintf(
+		entry->msg, RBT_ERR_MESSAGE_MAX, _format_text[record->format], record->addr
+	);
+	if (record->has_pc && len > 0 && len < RBT_ERR_MESSAGE_MAX) {
+		snprintf(
+			entry->msg + len, RBT_ERR_MESSAGE_MAX - len, " (pc 0x%06x)", record->pc
+		);
+	}
+}
+
 void _err_push(
 	RBT_ErrorSeverity severity,
 	RBT_ErrorCode code,
@@ -70,28 +149,46 @@ void _err_push(
 		return; // Skip storing errors below severity
 	}
 
-	if (_err_ctx.stack_top >= RBT_ERR_STACK_MAX) {
-		rbt_err_flush();
-	}
-
-	RBT_ErrorEntry *entry = &_err_ctx.stack[_err_ctx.stack_top];
-	_err_ctx.stack_top += 1;
-
-	entry->severity = severity;
-	entry->code = code;
-	entry->func = func;
-	entry->file = file;
-	entry->line = line;
-	entry->timestamp = time(nullptr);
+	RBT_ErrorRecord *record = _err_next_record(severity, code, func, file, line);
+	record->format = _ERR_FMT_MESSAGE;
+	record->addr = 0;
+	record->timestamp = time(nullptr);
 
 	va_list args;
 	va_start(args, fmt);
-	vsnprintf(entry->msg, RBT_ERR_MESSAGE_MAX, fmt, args);
+	vsnprintf(record->msg, RBT_ERR_MESSAGE_MAX, fmt, args);
 	va_end(args);
 }
 
+void _err_record(
+	RBT_ErrorSeverity severity,
+	RBT_ErrorCode code,
+	RBT_ErrorFormat format,
+	u32 addr,
+	const char *func,
+	const char *file,
+	u32 line
+) {
+	assert(format > _ERR_FMT_MESSAGE && format < _ERR_FMT_COUNT);
+
+	if (severity < _min_severity) {
+		return; // Skip storing errors below severity
+	}
+
+	RBT_ErrorRecord *record = _err_next_record(severity, code, func, file, line);
+	record->format = format;
+	record->addr = addr;
+	record->timestamp = 0;
+}
+
+const u32 *_err_set_pc_source(const u32 *pc) {
+	const u32 *previous = _err_ctx.pc;
+	_err_ctx.pc = pc;
+	return previous;
+}
+
 void rbt_err_flush(void) {
-	if (_err_ctx.stack_top == 0) {
+	if (_err_ctx.count == 0) {
 		return;
 	}
 
@@ -99,13 +196,19 @@ void rbt_err_flush(void) {
 
 	fprintf(out, "\n[RBT] > Error Stack Dump:\n");
 	fprintf(out, "=========================\n");
+	if (_err_ctx.dropped) {
+		fprintf(out, "    (%zu older entries dropped)\n", _err_ctx.dropped);
+	}
 
-	for (usize i = 0; i < _err_ctx.stack_top; i += 1) {
-		RBT_ErrorEntry *entry = &_err_ctx.stack[i];
+	for (usize i = 0; i < _err_ctx.count; i += 1) {
+		RBT_ErrorEntry *entry = &_err_ctx.last;
+		_err_format(_err_record_at(_err_ctx.count - 1 - i), entry);
 
-		struct tm *ltime = localtime(&entry->timestamp);
 		char timestamp_buf[16] = {};
-		timestamp_buf[strftime(timestamp_buf, 16, "%T", ltime)] = '\0';
+		if (entry->timestamp) {
+			struct tm *ltime = localtime(&entry->timestamp);
+			timestamp_buf[strftime(timestamp_buf, 16, "%T", ltime)] = '\0';
+		}
 
 		const char *sev_name = _severity_name[entry->severity];
 		const char *sev_color = _severity_color[entry->severity];
@@ -123,17 +226,25 @@ void rbt_err_flush(void) {
 	fprintf(out, "    ---\n");
 
 	fflush(out);
-	_err_ctx.stack_top = 0;
+	_err_ctx.count = 0;
+	_err_ctx.dropped = 0;
+}
+
+void rbt_set_err_min_severity(RBT_ErrorSeverity min_level) {
+	_min_severity = min_level;
 }
 
 void rbt_set_err_stream(FILE *stream) {
+	const u32 *pc = _err_ctx.pc;
 	memset(&_err_ctx, 0, sizeof(struct RBT_ErrorContext));
+	_err_ctx.pc = pc;
 	_err_ctx.stream = stream;
 }
 
 const RBT_ErrorEntry *rbt_query_last_error(void) {
-	if (_err_ctx.stack_top == 0)
+	if (_err_ctx.count == 0)
 		return nullptr;
 
-	return &_err_ctx.stack[_err_ctx.stack_top - 1];
+	_err_format(_err_record_at(0), &_err_ctx.last);
+	return &_err_ctx.last;
 }
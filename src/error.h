@@ -24,20 +24,68 @@ enum {
 	RBT_ERR_STACK_MAX = 64,
 };
 
-#define _push_info(...)                                                        \
-	_err_push(                                                                 \
-		RBT_SEVERITY_INFO, RBT_ERR_SUCCESS, __func__, __FILE_NAME__, __LINE__, \
-		__VA_ARGS__                                                            \
-	)
-#define _push_warn(...)                                                        \
-	_err_push(                                                                 \
-		RBT_SEVERITY_WARN, RBT_ERR_SUCCESS, __func__, __FILE_NAME__, __LINE__, \
-		__VA_ARGS__                                                            \
-	)
-#define _push_error(code, ...)                                                          \
-	_err_push(RBT_SEVERITY_ERROR, code, __func__, __FILE_NAME__, __LINE__, __VA_ARGS__)
-#define _push_fatal(code, ...)                                                          \
-	_err_push(RBT_SEVERITY_FATAL, code, __func__, __FILE_NAME__, __LINE__, __VA_ARGS__)
+// Pushes below this severity are compiled out. Release builds only keep
+// errors, rbt_set_err_min_severity() can't bring warnings back there.
+#ifndef RBT_ERR_MIN_SEVERITY
+#	ifdef NDEBUG
+#		define RBT_ERR_MIN_SEVERITY RBT_SEVERITY_ERROR
+#	else
+#		define RBT_ERR_MIN_SEVERITY RBT_SEVERITY_INFO
+#	endif
+#endif
+
+// Messages reported from hot paths. Only the format and the address are
+// recorded, the text is built when the entry is flushed or queried.
+typedef enum RBT_ErrorFormat {
+	_ERR_FMT_MESSAGE, // Free-form, formatted when pushed
+	_ERR_FMT_BUS_ERROR,
+	_ERR_FMT_UNALIGNED,
+	_ERR_FMT_ROM_WRITE,
+	_ERR_FMT_UNMAPPED,
+	_ERR_FMT_COUNT,
+} RBT_ErrorFormat;
+
+#define _err_enabled(severity) ((severity) >= RBT_ERR_MIN_SEVERITY)
+
+#define _push_info(...)                                                                \
+	do {                                                                               \
+		if (_err_enabled(RBT_SEVERITY_INFO))                                           \
+			_err_push(                                                                 \
+				RBT_SEVERITY_INFO, RBT_ERR_SUCCESS, __func__, __FILE_NAME__, __LINE__, \
+				__VA_ARGS__                                                            \
+			);                                                                         \
+	} while (0)
+#define _push_warn(...)                                                                \
+	do {                                                                               \
+		if (_err_enabled(RBT_SEVERITY_WARN))                                           \
+			_err_push(                                                                 \
+				RBT_SEVERITY_WARN, RBT_ERR_SUCCESS, __func__, __FILE_NAME__, __LINE__, \
+				__VA_ARGS__                                                            \
+			);                                                                         \
+	} while (0)
+#define _push_error(code, ...)                                                           \
+	do {                                                                                 \
+		if (_err_enabled(RBT_SEVERITY_ERROR))                                            \
+			_err_push(                                                                   \
+				RBT_SEVERITY_ERROR, code, __func__, __FILE_NAME__, __LINE__, __VA_ARGS__ \
+			);                                                                           \
+	} while (0)
+#define _push_fatal(code, ...)                                                           \
+	do {                                                                                 \
+		if (_err_enabled(RBT_SEVERITY_FATAL))                                            \
+			_err_push(                                                                   \
+				RBT_SEVERITY_FATAL, code, __func__, __FILE_NAME__, __LINE__, __VA_ARGS__ \
+			);                                                                           \
+	} while (0)
+
+// Records a preformatted message about `addr`, without formatting anything
+#define _push_event(severity, code, format, addr)                               \
+	do {                                                                        \
+		if (_err_enabled(severity))                                             \
+			_err_record(                                                        \
+				severity, code, format, addr, __func__, __FILE_NAME__, __LINE__ \
+			);                                                                  \
+	} while (0)
 
 void _err_push(
 	RBT_ErrorSeverity severity,
@@ -48,3 +96,18 @@ void _err_push(
 	const char *fmt,
 	...
 );
+
+void _err_record(
+	RBT_ErrorSeverity severity,
+	RBT_ErrorCode code,
+	RBT_ErrorFormat format,
+	u32 addr,
+	const char *func,
+	const char *file,
+	u32 line
+);
+
+// Entries recorded on this thread carry `*pc` at the time they're pushed, until
+// the source is replaced. Returns the previous source, for the caller to put
+// back once `pc` may no longer be read.
+const u32 *_err_set_pc_source(const u32 *pc);
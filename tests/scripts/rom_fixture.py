@@ -0,0 +1,85 @@
+#!/usr/bin/python3
+
+# Copyright (c) 2026-today aCube
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+# pyright: strict, reportAny=false
+
+# Writes the small ROM image test_rom_blocks runs rbt-rom-blocks on. It's mapped at
+# $f00000, with the reset vector pointing at the code below.
+
+import argparse
+from pathlib import Path
+
+_ROM_ADDR = 0xf0_0000
+
+# Words placed at each ROM address, the rest of the image is zero
+_CODE: dict[int, list[int]] = {
+	0xf0_0000: [0x0000, 0x8000, 0x00f0, 0x0100],   # Initial SSP, initial PC
+
+	0xf0_0100: [0x7000],                           # MOVEQ   #0, D0
+	0xf0_0102: [0x7205],                           # MOVEQ   #5, D1
+	0xf0_0104: [0x5280],                           # ADDQ.l  #1, D0
+	0xf0_0106: [0xb081],                           # CMP.l   D1, D0
+	0xf0_0108: [0x66fa],                           # BNE.s   $f00104
+	0xf0_010a: [0x4e72, 0x2700],                   # STOP    #$2700
+	0xf0_010e: [0x4eb9, 0x00f0, 0x0200],           # JSR     $f00200
+	0xf0_0114: [0x4ed0],                           # JMP     (A0)
+	0xf0_0116: [0xffff, 0xffff],                   # Data, never walked
+
+	0xf0_0200: [0x6000, 0x0dfa],                   # BRA.w   $f00ffc
+
+	0xf0_0300: [0x7e07],                           # MOVEQ   #7, D7
+	0xf0_0302: [0x4e75],                           # RTS
+
+	0xf0_0ffc: [0x7401],                           # MOVEQ   #1, D2
+	0xf0_0ffe: [0x263c, 0x1234, 0x5678],           # MOVE.l  #$12345678, D3
+	0xf0_1004: [0x4e75],                           # RTS
+}
+
+
+def _parse_args() -> argparse.Namespace:
+	parser = argparse.ArgumentParser(
+		description="Write the ROM image test_rom_blocks lists the blocks of"
+	)
+	_ = parser.add_argument(
+		"output",
+		type=Path,
+		help="ROM image to write"
+	)
+
+	return parser.parse_args()
+
+
+def main() -> None:
+	args = _parse_args()
+
+	end = max(addr + (len(words) * 2) for addr, words in _CODE.items())
+	rom = bytearray(end - _ROM_ADDR)
+	for addr, words in _CODE.items():
+		for i, word in enumerate(words):
+			offset = addr - _ROM_ADDR + (i * 2)
+			rom[offset:offset + 2] = word.to_bytes(2, "big")
+
+	_ = args.output.write_bytes(bytes(rom))
+
+
+if __name__ == "__main__":
+	main()
@@ -16,6 +16,7 @@
 // <https://www.gnu.org/licenses/>.
 
 #include "cpu/bus_internal.h"
+#include "error.h"
 #include "rbt/basic_types.h"
 #include "rbt/cpu/bus.h"
 #include "rbt/error_codes.h"
@@ -150,6 +151,26 @@ static void test_ram_unpopulated_slot_mirrors_slot0(void) {
 	rbt_destroy_bus(bus);
 }
 
+static void test_ram_mixed_slots_mirror_own_module(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_512KB, RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	rbt_bus_write_byte(bus, 0x000010, 0x33);
+	rbt_bus_write_byte(bus, 0x10'0004, 0x44);
+
+	u8 out;
+	// Slot 1 wraps at its own 256KB module
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_byte(bus, 0x14'0004, &out));
+	TEST_ASSERT_EQUAL_UINT8(0x44, out);
+
+	// Slot 2 is unpopulated — mirrors into slot 0, wrapping at 512KB
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_byte(bus, 0x28'0010, &out));
+	TEST_ASSERT_EQUAL_UINT8(0x33, out);
+
+	rbt_destroy_bus(bus);
+}
+
 static void test_ram_populated_slot_does_not_mirror(void) {
 	RBT_MemoryBus *bus = _make_bus(
 		RBT_RAM_256KB, RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE
@@ -168,6 +189,61 @@ static void test_ram_populated_slot_does_not_mirror(void) {
 	rbt_destroy_bus(bus);
 }
 
+static void test_ram_starts_zeroed(void) {
+	RBT_MemoryBus *bus = _make_bus(RBT_RAM_1MB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE);
+
+	u32 out = 1;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus, 0x08'0000, &out));
+	TEST_ASSERT_EQUAL_HEX32(0, out);
+
+	rbt_destroy_bus(bus);
+}
+
+// Words written through slot 0 and its mirror, then reset
+static void test_reset_clears_written_pages(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	rbt_bus_write_word(bus, 0x00'1000, 0x1234);
+	rbt_bus_write_long(bus, 0x13'fffc, 0x5678'9abc);
+	u32 untouched = bus->code_gen[0x20];
+	rbt_bus_reset(bus);
+
+	u16 word = 1;
+	u32 long_ = 1;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_word(bus, 0x00'1000, &word));
+	TEST_ASSERT_EQUAL_HEX16(0, word);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus, 0x03'fffc, &long_));
+	TEST_ASSERT_EQUAL_HEX32(0, long_);
+
+	// Pages nobody wrote to are left alone
+	TEST_ASSERT_EQUAL_UINT32(untouched, bus->code_gen[0x20]);
+	for (usize i = 0; i < sizeof(bus->ram.dirty) / sizeof(bus->ram.dirty[0]); i += 1) {
+		TEST_ASSERT_EQUAL_UINT64(0, bus->ram.dirty[i]);
+	}
+
+	rbt_destroy_bus(bus);
+}
+
+// Enough dirty pages to give the whole RAM back at once
+static void test_reset_clears_many_pages(void) {
+	RBT_MemoryBus *bus = _make_bus(RBT_RAM_1MB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE);
+
+	for (u32 addr = 0; addr < 1024 * 1024; addr += 4096) {
+		rbt_bus_write_long(bus, addr + 8, addr | 1);
+	}
+	rbt_bus_reset(bus);
+
+	for (u32 addr = 0; addr < 1024 * 1024; addr += 4096) {
+		u32 out = 1;
+		TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus, addr + 8, &out));
+		TEST_ASSERT_EQUAL_HEX32(0, out);
+	}
+
+	rbt_destroy_bus(bus);
+}
+
 static void test_rom_init_and_read(void) {
 	RBT_MemoryBus *bus = _make_bus(
 		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
@@ -244,6 +320,132 @@ static void test_rom_init_from_file(void) {
 	rbt_destroy_bus(bus);
 }
 
+static void test_rom_map_file_shared(void) {
+	RBT_MemoryBus *bus_a = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+	RBT_MemoryBus *bus_b = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	FILE *f = fopen("test.rom", "wb");
+	TEST_ASSERT_NOT_NULL(f);
+	u8 data[] = { 0x11, 0x22, 0x33, 0x44 };
+	fwrite(data, 1, sizeof(data), f);
+	fclose(f);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_map_rom_file(bus_a, "test.rom"));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_map_rom_file(bus_b, "test.rom"));
+	TEST_ASSERT_TRUE(bus_a->rom == bus_b->rom);
+
+	u32 out;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus_b, _BUS_ROM_ADDR, &out));
+	TEST_ASSERT_EQUAL_HEX32(0x11223344, out);
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_read_long(bus_b, _BUS_ROM_MIRROR_ADDR, &out)
+	);
+	TEST_ASSERT_EQUAL_HEX32(0x11223344, out);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus_b, 0x000000, &out));
+	TEST_ASSERT_EQUAL_HEX32(0x11223344, out); // Vector table mirrored into RAM
+
+	// Past the end of the file
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_read_long(bus_b, _BUS_ROM_ADDR + 0x1'0000, &out)
+	);
+	TEST_ASSERT_EQUAL_HEX32(0, out);
+
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_READONLY, rbt_bus_write_byte(bus_a, _BUS_ROM_ADDR, 0xaa)
+	);
+
+	// The mapping outlives the first bus and the file itself
+	rbt_destroy_bus(bus_a);
+	remove("test.rom");
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus_b, _BUS_ROM_ADDR, &out));
+	TEST_ASSERT_EQUAL_HEX32(0x11223344, out);
+
+	rbt_destroy_bus(bus_b);
+}
+
+static void test_rom_init_after_map_file(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	FILE *f = fopen("test.rom", "wb");
+	TEST_ASSERT_NOT_NULL(f);
+	u8 data[] = { 0x11, 0x22, 0x33, 0x44 };
+	fwrite(data, 1, sizeof(data), f);
+	fclose(f);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_map_rom_file(bus, "test.rom"));
+	remove("test.rom");
+
+	u8 rom[] = { 0xaa, 0xbb };
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_init(bus, sizeof(rom), rom));
+
+	u16 out;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_word(bus, _BUS_ROM_ADDR, &out));
+	TEST_ASSERT_EQUAL_HEX16(0xaabb, out);
+
+	rbt_destroy_bus(bus);
+}
+
+static void test_rom_map_missing_file(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SYS_IO, rbt_bus_map_rom_file(bus, "missing.rom"));
+
+	rbt_destroy_bus(bus);
+}
+
+static void test_fetch_window(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	u16 word;
+	u32 long_;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, 0x1000, 0x4e71));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, _bus_fetch_word(bus, 0x1000, &word));
+	TEST_ASSERT_EQUAL_HEX16(0x4e71, word);
+
+	// Writes go to the memory behind the window
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, 0x1000, 0x7001));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, _bus_fetch_word(bus, 0x1000, &word));
+	TEST_ASSERT_EQUAL_HEX16(0x7001, word);
+
+	// Longs crossing the page take the full bus path
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_long(bus, 0x1ffe, 0x11223344));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, _bus_fetch_long(bus, 0x1ffe, &long_));
+	TEST_ASSERT_EQUAL_HEX32(0x11223344, long_);
+	TEST_ASSERT_EQUAL(RBT_ERR_MEM_ADDR_ERROR, _bus_fetch_word(bus, 0x1001, &word));
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_BUS_ERROR, _bus_fetch_word(bus, _BUS_RESERVED_BERR_ADDR, &word)
+	);
+
+	// Remapping the ROM moves the window off the old image
+	FILE *f = fopen("test.rom", "wb");
+	TEST_ASSERT_NOT_NULL(f);
+	u8 data[] = { 0x11, 0x22, 0x33, 0x44 };
+	fwrite(data, 1, sizeof(data), f);
+	fclose(f);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_map_rom_file(bus, "test.rom"));
+	remove("test.rom");
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, _bus_fetch_word(bus, _BUS_ROM_ADDR, &word));
+	TEST_ASSERT_EQUAL_HEX16(0x1122, word);
+
+	u8 rom[] = { 0xaa, 0xbb };
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_init(bus, sizeof(rom), rom));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, _bus_fetch_word(bus, _BUS_ROM_ADDR, &word));
+	TEST_ASSERT_EQUAL_HEX16(0xaabb, word);
+
+	rbt_destroy_bus(bus);
+}
+
 static void test_unaligned_word_access(void) {
 	RBT_MemoryBus *bus = _make_bus(
 		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
@@ -272,6 +474,66 @@ static void test_berr_region(void) {
 	rbt_destroy_bus(bus);
 }
 
+static void test_bus_error_formatted_on_query(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	u8 out;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_BUS_ERROR, rbt_bus_read_byte(bus, _BUS_RESERVED_BERR_ADDR, &out)
+	);
+
+	const RBT_ErrorEntry *last = rbt_query_last_error();
+	TEST_ASSERT_NOT_NULL(last);
+	TEST_ASSERT_EQUAL(RBT_ERR_MEM_BUS_ERROR, last->code);
+	TEST_ASSERT_EQUAL_STRING("Tried to access invalid address at: 0x400000", last->msg);
+
+	rbt_err_flush();
+	TEST_ASSERT_NULL(rbt_query_last_error());
+
+	rbt_destroy_bus(bus);
+}
+
+static void test_bus_error_ring_keeps_newest(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	// Overflowing the ring drops the oldest entries without flushing
+	u8 out;
+	for (u32 i = 0; i < RBT_ERR_STACK_MAX + 8; i += 1) {
+		(void)rbt_bus_read_byte(bus, _BUS_RESERVED_BERR_ADDR + i, &out);
+	}
+
+	const RBT_ErrorEntry *last = rbt_query_last_error();
+	TEST_ASSERT_NOT_NULL(last);
+	TEST_ASSERT_EQUAL_STRING("Tried to access invalid address at: 0x400047", last->msg);
+
+	rbt_err_flush();
+	rbt_destroy_bus(bus);
+}
+
+static void test_bus_results_ignore_err_severity(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	// Nothing is recorded, the return codes must not change
+	rbt_err_flush();
+	rbt_set_err_min_severity(RBT_SEVERITY_FATAL);
+
+	u16 word;
+	TEST_ASSERT_EQUAL(RBT_ERR_MEM_ADDR_ERROR, rbt_bus_read_word(bus, 0x000001, &word));
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_BUS_ERROR, rbt_bus_read_word(bus, _BUS_RESERVED_BERR_ADDR, &word)
+	);
+	TEST_ASSERT_NULL(rbt_query_last_error());
+
+	rbt_set_err_min_severity(RBT_SEVERITY_INFO);
+	rbt_destroy_bus(bus);
+}
+
 static void test_dtack_region(void) {
 	// DTACK region does nothing — reads/writes silently succeed
 	RBT_MemoryBus *bus = _make_bus(
@@ -306,6 +568,243 @@ static void test_disabled_ext_card_berr(void) {
 	rbt_destroy_bus(bus);
 }
 
+// Fake device: reads return the low byte of the offset, writes record it
+typedef struct RBT_FakeDevice {
+	u32 last_offset;
+	u8 last_byte;
+} RBT_FakeDevice;
+
+static RBT_ErrorCode _fake_read_byte(void *device, u32 addr, u8 *byte) {
+	(void)device;
+	*byte = addr & 0xff;
+	return RBT_ERR_SUCCESS;
+}
+
+static RBT_ErrorCode _fake_write_byte(void *device, u32 addr, u8 byte) {
+	RBT_FakeDevice *fake = device;
+	fake->last_offset = addr;
+	fake->last_byte = byte;
+	return RBT_ERR_SUCCESS;
+}
+
+static RBT_IODevice _fake_iodevice(RBT_FakeDevice *fake, u32 addr, u32 size) {
+	return (RBT_IODevice) {
+		.addr = addr,
+		.size = size,
+		.device = fake,
+		.read_byte = _fake_read_byte,
+		.write_byte = _fake_write_byte,
+	};
+}
+
+static void test_ext_card_device(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	RBT_FakeDevice fake = { 0 };
+	RBT_IODevice dev = _fake_iodevice(&fake, _BUS_EXT1_ADDR, _BUS_EXT_SIZE);
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_EXT1, &dev);
+
+	u16 word;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_read_word(bus, _BUS_EXT1_ADDR + 0x1232, &word)
+	);
+	TEST_ASSERT_EQUAL_HEX16(0x3233, word);
+
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_byte(bus, _BUS_EXT1_ADDR + 0xabcd, 0x5a)
+	);
+	TEST_ASSERT_EQUAL_HEX32(0xabcd, fake.last_offset);
+	TEST_ASSERT_EQUAL_UINT8(0x5a, fake.last_byte);
+
+	rbt_destroy_bus(bus);
+}
+
+static void test_block_ram_round_trip(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	u8 data[6000];
+	for (u32 i = 0; i < sizeof(data); i += 1) {
+		data[i] = (u8)(i * 7);
+	}
+
+	// Crosses a page boundary, read back through the slot 1 mirror
+	usize transferred = 0;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_bus_write_block(bus, 0x0ff1, data, sizeof(data), &transferred)
+	);
+	TEST_ASSERT_EQUAL_UINT64(sizeof(data), transferred);
+
+	u8 out[sizeof(data)];
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_bus_read_block(bus, 0x10'0ff1, out, sizeof(out), &transferred)
+	);
+	TEST_ASSERT_EQUAL_UINT64(sizeof(out), transferred);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(data, out, sizeof(data));
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_fill(bus, 0x2001, 0x5a, 3, nullptr));
+	u32 long_;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus, 0x2000, &long_));
+	TEST_ASSERT_EQUAL_HEX32(0x005a'5a5a, long_ & 0x00ff'ffff);
+
+	rbt_destroy_bus(bus);
+}
+
+static void test_block_write_rom_readonly(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	u8 rom[] = { 0x11, 0x22, 0x33, 0x44 };
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_init(bus, sizeof(rom), rom));
+
+	u8 out[4];
+	usize transferred = 0;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_bus_read_block(bus, _BUS_ROM_MIRROR_ADDR, out, sizeof(out), &transferred)
+	);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(rom, out, sizeof(rom));
+
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_READONLY,
+		rbt_bus_fill(bus, _BUS_ROM_ADDR, 0xff, sizeof(rom), &transferred)
+	);
+	TEST_ASSERT_EQUAL_UINT64(0, transferred);
+
+	rbt_destroy_bus(bus);
+}
+
+// The transfer runs off the end of RAM into the /BERR region
+static void test_block_stops_at_bus_error(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	u8 data[32] = { 0 };
+	usize transferred = 0;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_BUS_ERROR,
+		rbt_bus_write_block(
+			bus, _BUS_RESERVED_BERR_ADDR - 12, data, sizeof(data), &transferred
+		)
+	);
+	TEST_ASSERT_EQUAL_UINT64(12, transferred);
+	TEST_ASSERT_EQUAL_HEX32(_BUS_RESERVED_BERR_ADDR, bus->fault.addr);
+	TEST_ASSERT_FALSE(bus->fault.is_read);
+
+	rbt_destroy_bus(bus);
+}
+
+static void test_block_dtack_region(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	u8 out[3] = { 0xff, 0xff, 0xff };
+	usize transferred = 0;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_bus_read_block(bus, _BUS_RESERVED_DTACK_ADDR, out, sizeof(out), &transferred)
+	);
+	TEST_ASSERT_EQUAL_UINT64(sizeof(out), transferred);
+	TEST_ASSERT_EQUAL_UINT8(0, out[0]);
+	TEST_ASSERT_EQUAL_UINT8(0, out[2]);
+
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_bus_fill(bus, _BUS_RESERVED_DTACK_ADDR, 0xaa, 16, &transferred)
+	);
+	TEST_ASSERT_EQUAL_UINT64(16, transferred);
+
+	rbt_destroy_bus(bus);
+}
+
+static void test_block_device(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	RBT_FakeDevice fake = { 0 };
+	RBT_IODevice dev = _fake_iodevice(&fake, _BUS_EXT1_ADDR, _BUS_EXT_SIZE);
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_EXT1, &dev);
+
+	u8 out[5];
+	usize transferred = 0;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_bus_read_block(bus, _BUS_EXT1_ADDR + 0x11, out, sizeof(out), &transferred)
+	);
+	TEST_ASSERT_EQUAL_UINT64(sizeof(out), transferred);
+	u8 expected[] = { 0x11, 0x12, 0x13, 0x14, 0x15 };
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, sizeof(expected));
+
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_bus_write_block(bus, _BUS_EXT1_ADDR + 0x20, expected, 4, &transferred)
+	);
+	TEST_ASSERT_EQUAL_HEX32(0x23, fake.last_offset);
+	TEST_ASSERT_EQUAL_UINT8(0x14, fake.last_byte);
+
+	rbt_destroy_bus(bus);
+}
+
+// MMIO devices are smaller than a page and share one
+static void test_mmio_devices_share_page(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	RBT_FakeDevice vdp = { 0 };
+	RBT_FakeDevice io = { 0 };
+	RBT_IODevice vdp_dev = _fake_iodevice(&vdp, _BUS_MMIO_VDP_ADDR, _BUS_MMIO_SIZE);
+	RBT_IODevice io_dev = _fake_iodevice(&io, _BUS_MMIO_IO_ADDR, _BUS_MMIO_SIZE);
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_VDP, &vdp_dev);
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_IO, &io_dev);
+
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_byte(bus, _BUS_MMIO_VDP_ADDR + 4, 1)
+	);
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_byte(bus, _BUS_MMIO_IO_ADDR + 8, 2)
+	);
+	TEST_ASSERT_EQUAL_HEX32(4, vdp.last_offset);
+	TEST_ASSERT_EQUAL_HEX32(8, io.last_offset);
+
+	u8 out;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_UNMAPPED, rbt_bus_read_byte(bus, _BUS_MMIO_SD_ADDR, &out)
+	);
+
+	rbt_destroy_bus(bus);
+}
+
+// Detaching a card puts its pages back to /BERR
+static void test_detach_ext_card_berr(void) {
+	RBT_MemoryBus *bus = _make_bus(
+		RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE
+	);
+
+	RBT_FakeDevice fake = { 0 };
+	RBT_IODevice dev = _fake_iodevice(&fake, _BUS_EXT2_ADDR, _BUS_EXT_SIZE);
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_EXT2, &dev);
+
+	RBT_IODevice empty = { 0 };
+	rbt_bus_attach_iodevice(bus, RBT_BUSDEV_EXT2, &empty);
+
+	u8 out;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_MEM_BUS_ERROR, rbt_bus_read_byte(bus, _BUS_EXT2_ADDR + 0x100, &out)
+	);
+
+	rbt_destroy_bus(bus);
+}
+
 int main(void) {
 	UNITY_BEGIN();
 
@@ -322,17 +821,39 @@ int main(void) {
 	RUN_TEST(test_ram_slot0_wraps_512kb_module);
 
 	RUN_TEST(test_ram_unpopulated_slot_mirrors_slot0);
+	RUN_TEST(test_ram_mixed_slots_mirror_own_module);
 	RUN_TEST(test_ram_populated_slot_does_not_mirror);
 
+	RUN_TEST(test_ram_starts_zeroed);
+	RUN_TEST(test_reset_clears_written_pages);
+	RUN_TEST(test_reset_clears_many_pages);
+
 	RUN_TEST(test_rom_init_and_read);
 	RUN_TEST(test_rom_mirror);
 	RUN_TEST(test_rom_write_readonly);
 	RUN_TEST(test_rom_init_from_file);
+	RUN_TEST(test_rom_map_file_shared);
+	RUN_TEST(test_rom_init_after_map_file);
+	RUN_TEST(test_rom_map_missing_file);
 
+	RUN_TEST(test_fetch_window);
 	RUN_TEST(test_unaligned_word_access);
 	RUN_TEST(test_berr_region);
+	RUN_TEST(test_bus_error_formatted_on_query);
+	RUN_TEST(test_bus_error_ring_keeps_newest);
+	RUN_TEST(test_bus_results_ignore_err_severity);
 	RUN_TEST(test_dtack_region);
 	RUN_TEST(test_disabled_ext_card_berr);
 
+	RUN_TEST(test_ext_card_device);
+	RUN_TEST(test_mmio_devices_share_page);
+	RUN_TEST(test_detach_ext_card_berr);
+
+	RUN_TEST(test_block_ram_round_trip);
+	RUN_TEST(test_block_write_rom_readonly);
+	RUN_TEST(test_block_stops_at_bus_error);
+	RUN_TEST(test_block_dtack_region);
+	RUN_TEST(test_block_device);
+
 	return UNITY_END();
 }
@@ -0,0 +1,731 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "cpu/bus_internal.h"
+#include "cpu/cpu_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+#include "unity_internals.h"
+
+#include <string.h>
+#include <unity.h>
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+enum {
+	_CODE_ADDR = 0x1000, // Programs are placed in RAM
+};
+
+static RBT_MemoryBus *bus;
+static RBT_Cpu *cpu;
+
+// Writes `count` opcode words at _CODE_ADDR and points the PC at them.
+static void _load(const u16 *words, usize count) {
+	for (usize i = 0; i < count; i += 1) {
+		TEST_ASSERT_EQUAL(
+			RBT_ERR_SUCCESS, rbt_bus_write_word(bus, _CODE_ADDR + (i * 2), words[i])
+		);
+	}
+
+	cpu->state.pc = _CODE_ADDR;
+}
+
+void setUp(void) {
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	bus = rbt_create_bus(&cfg);
+	TEST_ASSERT_NOT_NULL(bus);
+
+	cpu = rbt_create_cpu(nullptr);
+	TEST_ASSERT_NOT_NULL(cpu);
+	rbt_cpu_attach_bus(cpu, bus);
+
+	cpu->state.sr = RBT_SR_SUPERVISOR;
+	cpu->state.ssp = 0x8000;
+	cpu->state.gpr.sp = cpu->state.ssp;
+}
+
+void tearDown(void) {
+	rbt_destroy_cpu(cpu);
+	rbt_destroy_bus(bus);
+	rbt_err_flush();
+}
+
+// ----------------------------------------------------------------------------
+// Decode cache
+// ----------------------------------------------------------------------------
+
+// MOVEQ #1, D0 executed twice from the same PC
+void test_icache_hit_on_same_pc(void) {
+	_load((u16[]) { 0x7001 }, 1);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+	cpu->state.pc = _CODE_ADDR;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	RBT_CpuCacheStats stats;
+	rbt_cpu_query_cache_stats(cpu, &stats);
+	TEST_ASSERT_EQUAL(1, stats.misses);
+	TEST_ASSERT_EQUAL(1, stats.hits);
+	TEST_ASSERT_EQUAL_UINT32(1, cpu->state.gpr.data[0]);
+}
+
+// MOVEQ #1, D0 patched into MOVEQ #2, D0 after being cached
+void test_icache_invalidated_by_write(void) {
+	_load((u16[]) { 0x7001 }, 1);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, _CODE_ADDR, 0x7002));
+	cpu->state.pc = _CODE_ADDR;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	RBT_CpuCacheStats stats;
+	rbt_cpu_query_cache_stats(cpu, &stats);
+	TEST_ASSERT_EQUAL(2, stats.misses);
+	TEST_ASSERT_EQUAL(0, stats.hits);
+	TEST_ASSERT_EQUAL_UINT32(2, cpu->state.gpr.data[0]);
+}
+
+// Writes through a RAM mirror must invalidate the aliased code page too
+void test_icache_invalidated_by_mirror_write(void) {
+	_load((u16[]) { 0x7001 }, 1);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	// Slot 1 is unpopulated and mirrors slot 0
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_word(bus, 0x10'0000 + _CODE_ADDR, 0x7003)
+	);
+	cpu->state.pc = _CODE_ADDR;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	TEST_ASSERT_EQUAL_UINT32(3, cpu->state.gpr.data[0]);
+}
+
+// Data writes to other pages keep cached code alive
+void test_icache_survives_unrelated_write(void) {
+	_load((u16[]) { 0x7001 }, 1);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_long(bus, 0x4000, 0xdeadbeef));
+	cpu->state.pc = _CODE_ADDR;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	RBT_CpuCacheStats stats;
+	rbt_cpu_query_cache_stats(cpu, &stats);
+	TEST_ASSERT_EQUAL(1, stats.hits);
+}
+
+void test_icache_flush(void) {
+	_load((u16[]) { 0x7001 }, 1);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	rbt_cpu_flush_cache(cpu);
+	cpu->state.pc = _CODE_ADDR;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+
+	RBT_CpuCacheStats stats;
+	rbt_cpu_query_cache_stats(cpu, &stats);
+	TEST_ASSERT_EQUAL(2, stats.misses);
+}
+
+// ----------------------------------------------------------------------------
+// Batch execution
+// ----------------------------------------------------------------------------
+
+static const u16 _MOVEQ_PROGRAM[] = {
+	0x7001, // MOVEQ #1, D0
+	0x7202, // MOVEQ #2, D1
+	0x7403, // MOVEQ #3, D2
+	0x7604, // MOVEQ #4, D3
+};
+
+static u32 _hook_calls;
+
+static RBT_ErrorCode _hook_count(void *userdata, const RBT_Instruction *instr) {
+	(void)userdata;
+	(void)instr;
+	_hook_calls += 1;
+	return RBT_ERR_SUCCESS;
+}
+
+static RBT_ErrorCode _hook_break_third(void *userdata, const RBT_Instruction *instr) {
+	(void)userdata;
+	if (instr->start_pc == _CODE_ADDR + 4)
+		return RBT_ERR_GENERIC;
+	return RBT_ERR_SUCCESS;
+}
+
+static RBT_ErrorCode _hook_raise_irq(void *userdata, const RBT_Instruction *instr) {
+	(void)instr;
+	rbt_cpu_set_irq_line(userdata, 1, true);
+	return RBT_ERR_SUCCESS;
+}
+
+void test_run_stops_at_budget(void) {
+	_load(_MOVEQ_PROGRAM, 4);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 8, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(8, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 4, cpu->state.pc);
+	TEST_ASSERT_EQUAL_UINT32(2, cpu->state.gpr.data[1]);
+	TEST_ASSERT_EQUAL_UINT32(0, cpu->state.gpr.data[2]);
+}
+
+void test_run_zero_budget(void) {
+	_load(_MOVEQ_PROGRAM, 4);
+
+	u32 cycles = 1;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 0, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(0, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR, cpu->state.pc);
+}
+
+void test_run_stops_when_halted(void) {
+	_load(_MOVEQ_PROGRAM, 4);
+	cpu->is_halted = true;
+
+	u32 cycles = 1;
+	TEST_ASSERT_EQUAL(RBT_ERR_CPU_HALTED, rbt_cpu_run(cpu, 100, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(0, cycles);
+}
+
+void test_run_calls_hook_per_instruction(void) {
+	cpu->cfg.hook = _hook_count;
+	_hook_calls = 0;
+	_load(_MOVEQ_PROGRAM, 4);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 16, nullptr));
+	TEST_ASSERT_EQUAL_UINT32(4, _hook_calls);
+}
+
+// The hook rejects the third instruction, which must not execute
+void test_run_stops_on_hook(void) {
+	cpu->cfg.hook = _hook_break_third;
+	_load(_MOVEQ_PROGRAM, 4);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_GENERIC, rbt_cpu_run(cpu, 100, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(8, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 4, cpu->state.pc);
+	TEST_ASSERT_EQUAL_UINT32(0, cpu->state.gpr.data[2]);
+}
+
+void test_run_stops_on_pending_interrupt(void) {
+	cpu->cfg.hook = _hook_raise_irq;
+	cpu->cfg.userdata = cpu;
+	_load(_MOVEQ_PROGRAM, 4);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(4, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, cpu->state.pc);
+}
+
+// A masked interrupt must not cut the run short
+void test_run_ignores_masked_interrupt(void) {
+	rbt_cpu_set_irq_line(cpu, 3, true);
+	cpu->state.sr |= RBT_SR_INTERRUPT;
+	_load(_MOVEQ_PROGRAM, 4);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 16, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(16, cycles);
+}
+
+static RBT_ErrorCode _event_raise_irq(void *userdata, u64 cycle) {
+	(void)cycle;
+	rbt_cpu_set_irq_line(userdata, 7, true);
+	return RBT_ERR_SUCCESS;
+}
+
+// The event at cycle 6 is reached by the second MOVEQ and fires right after it
+void test_run_until_event(void) {
+	RBT_Scheduler *sched = rbt_create_scheduler();
+	TEST_ASSERT_NOT_NULL(sched);
+	rbt_sched_at(sched, 6, _event_raise_irq, cpu);
+	_load(_MOVEQ_PROGRAM, 4);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run_until_event(cpu, sched, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(8, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 4, cpu->state.pc);
+	TEST_ASSERT_EQUAL_UINT64(8, rbt_sched_now(sched));
+	TEST_ASSERT_EQUAL_UINT8(7, _cpu_irq_level(cpu->irq_lines));
+
+	rbt_destroy_scheduler(sched);
+}
+
+// An event that is already due fires without running anything
+void test_run_until_due_event(void) {
+	RBT_Scheduler *sched = rbt_create_scheduler();
+	TEST_ASSERT_NOT_NULL(sched);
+	rbt_sched_at(sched, 0, _event_raise_irq, cpu);
+	_load(_MOVEQ_PROGRAM, 4);
+
+	u32 cycles = 1;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run_until_event(cpu, sched, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(0, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR, cpu->state.pc);
+	TEST_ASSERT_EQUAL_UINT8(7, _cpu_irq_level(cpu->irq_lines));
+
+	rbt_destroy_scheduler(sched);
+}
+
+// ----------------------------------------------------------------------------
+// STOP and idle loops
+// ----------------------------------------------------------------------------
+
+// Level 1 autovector handler: MOVEQ #2, D1
+static void _load_irq_handler(void) {
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_long(bus, _VEC_AUTOVEC_L1 * 4, _CODE_ADDR + 0x100)
+	);
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_word(bus, _CODE_ADDR + 0x100, 0x7202)
+	);
+}
+
+// STOP #$2000; MOVEQ #1, D0
+void test_stop_waits_for_interrupt(void) {
+	_load_irq_handler();
+	_load((u16[]) { 0x4e72, 0x2000, 0x7001 }, 3);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(1000, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 4, cpu->state.pc);
+	TEST_ASSERT_EQUAL(RBT_ERR_CPU_STOPPED, rbt_cpu_step(cpu, nullptr));
+
+	rbt_cpu_set_irq_line(cpu, 1, true);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+	TEST_ASSERT_FALSE(cpu->is_stopped);
+	TEST_ASSERT_EQUAL_UINT32(2, cpu->state.gpr.data[1]);
+	TEST_ASSERT_EQUAL_UINT32(0, cpu->state.gpr.data[0]);
+}
+
+// STOP is privileged, the user mode one traps without stopping
+void test_stop_in_user_mode(void) {
+	cpu->state.sr = 0;
+	cpu->state.usp = 0x7000;
+	cpu->state.gpr.sp = cpu->state.usp;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_long(bus, _VEC_PRIVILEGE * 4, _CODE_ADDR + 0x100)
+	);
+	_load((u16[]) { 0x4e72, 0x2000 }, 2);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+	TEST_ASSERT_FALSE(cpu->is_stopped);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 0x100, cpu->state.pc);
+}
+
+// A stopped CPU goes straight to the event that wakes it up
+void test_stop_run_until_event(void) {
+	RBT_Scheduler *sched = rbt_create_scheduler();
+	TEST_ASSERT_NOT_NULL(sched);
+	rbt_sched_at(sched, 5000, _event_raise_irq, cpu);
+	_load((u16[]) { 0x4e72, 0x2000 }, 2);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run_until_event(cpu, sched, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(5000, cycles);
+	TEST_ASSERT_EQUAL_UINT64(5000, rbt_sched_now(sched));
+	TEST_ASSERT_TRUE(cpu->is_stopped);
+	TEST_ASSERT_EQUAL_UINT8(7, _cpu_irq_level(cpu->irq_lines));
+
+	rbt_destroy_scheduler(sched);
+}
+
+static const u16 _POLL_PROGRAM[] = {
+	0x4a78, 0x2000, // TST.W ($2000).w
+	0x67fa,			// BEQ.s *-4
+	0x7403,			// MOVEQ #3, D2
+	0x60fe,			// BRA.s *
+};
+
+void test_idle_loop_skipped(void) {
+	cpu->cfg.skip_idle_loops = true;
+	_load(_POLL_PROGRAM, 5);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(1000, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR, cpu->state.pc);
+
+	RBT_CpuCacheStats stats;
+	rbt_cpu_query_cache_stats(cpu, &stats);
+	TEST_ASSERT_EQUAL(2, stats.misses);
+	TEST_ASSERT_EQUAL(0, stats.hits);
+
+	// The device flag ends the loop on the next run
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, 0x2000, 1));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(1000, cycles);
+	TEST_ASSERT_EQUAL_UINT32(3, cpu->state.gpr.data[2]);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 8, cpu->state.pc);
+}
+
+void test_idle_loop_runs_by_default(void) {
+	_load(_POLL_PROGRAM, 5);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_TRUE(cycles >= 1000);
+
+	RBT_CpuCacheStats stats;
+	rbt_cpu_query_cache_stats(cpu, &stats);
+	TEST_ASSERT_GREATER_THAN(40, stats.hits);
+}
+
+// ADDQ.L #1, D0; BRA.s *-2 changes D0 on every pass
+void test_busy_loop_not_skipped(void) {
+	cpu->cfg.skip_idle_loops = true;
+	_load((u16[]) { 0x5280, 0x60fc }, 2);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, nullptr));
+	TEST_ASSERT_GREATER_THAN(40, cpu->state.gpr.data[0]);
+}
+
+// BTST #0, ($2000).w; BEQ.s *-4 polls a single status bit
+void test_idle_loop_btst_poll(void) {
+	cpu->cfg.skip_idle_loops = true;
+	_load((u16[]) { 0x0838, 0x0000, 0x2000, 0x67f8, 0x7403, 0x60fe }, 6);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(1000, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR, cpu->state.pc);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_byte(bus, 0x2000, 0x01));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(3, cpu->state.gpr.data[2]);
+}
+
+// CMP.w ($2000).w, D0; BNE.s *-4 waits for the word to match D0
+void test_idle_loop_cmp_poll(void) {
+	cpu->cfg.skip_idle_loops = true;
+	cpu->state.gpr.data[0] = 0x1234;
+	_load((u16[]) { 0xb078, 0x2000, 0x66fa, 0x7403, 0x60fe }, 5);
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(1000, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR, cpu->state.pc);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, 0x2000, 0x1234));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(3, cpu->state.gpr.data[2]);
+}
+
+// ----------------------------------------------------------------------------
+// Basic blocks
+// ----------------------------------------------------------------------------
+
+static const u16 _LOOP_PROGRAM[] = {
+	0x72f6, // MOVEQ #-10, D1
+	0x5280, // ADDQ.l #1, D0
+	0xd480, // ADD.l D0, D2
+	0x5281, // ADDQ.l #1, D1
+	0x66f8, // BNE.s *-6
+	0x7607, // MOVEQ #7, D3
+	0x60fe, // BRA.s *
+};
+
+// Blocks must end up in the same state, after the same number of cycles
+void test_blocks_match_single_instructions(void) {
+	_load(_LOOP_PROGRAM, 7);
+	u32 expected = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &expected));
+	RBT_CpuState state = cpu->state;
+
+	memset(&cpu->state.gpr, 0, sizeof(cpu->state.gpr));
+	cpu->state.gpr.sp = cpu->state.ssp;
+	cpu->state.pc = _CODE_ADDR;
+	cpu->cfg.translate_blocks = true;
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(expected, cycles);
+	TEST_ASSERT_EQUAL_UINT32(10, cpu->state.gpr.data[0]);
+	TEST_ASSERT_EQUAL_UINT32(55, cpu->state.gpr.data[2]);
+	TEST_ASSERT_EQUAL_UINT32(7, cpu->state.gpr.data[3]);
+	TEST_ASSERT_EQUAL_HEX32(state.pc, cpu->state.pc);
+	TEST_ASSERT_EQUAL_HEX16(state.sr, cpu->state.sr);
+}
+
+// The loop body links back to itself the first time BNE is taken
+void test_block_links_its_successor(void) {
+	cpu->cfg.translate_blocks = true;
+	_load(_LOOP_PROGRAM, 7);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, nullptr));
+
+	const RBT_CpuBlock *body = nullptr;
+	for (u32 i = 0; i < _CPU_BLOCK_SLOTS; i += 1) {
+		if (cpu->blocks[i].start_pc == _CODE_ADDR + 2)
+			body = &cpu->blocks[i];
+	}
+	TEST_ASSERT_NOT_NULL(body);
+	TEST_ASSERT_EQUAL_UINT32(4, body->count);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 10, body->end_pc);
+	TEST_ASSERT_TRUE(body->exits[1] == body);
+	TEST_ASSERT_NOT_NULL(body->exits[0]);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 10, body->exits[0]->start_pc);
+}
+
+// MOVE.w #$7005, (A0) patches the MOVEQ #1, D0 that follows it
+void test_block_sees_its_own_writes(void) {
+	cpu->cfg.translate_blocks = true;
+	_load((u16[]) { 0x41f8, 0x1008, 0x30bc, 0x7005, 0x7001, 0x60fe }, 6);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, nullptr));
+	TEST_ASSERT_EQUAL_UINT32(5, cpu->state.gpr.data[0]);
+
+	// Patching the immediate from outside drops the block recorded meanwhile
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, _CODE_ADDR + 6, 0x7009));
+	cpu->state.pc = _CODE_ADDR;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, nullptr));
+	TEST_ASSERT_EQUAL_UINT32(9, cpu->state.gpr.data[0]);
+}
+
+// Blocks decoded ahead run like recorded ones, odd entry points are ignored
+void test_preloaded_blocks(void) {
+	cpu->cfg.translate_blocks = true;
+	_load(_LOOP_PROGRAM, 7);
+
+	const u32 starts[] = { _CODE_ADDR, _CODE_ADDR + 1, _CODE_ADDR + 2, _CODE_ADDR + 10 };
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_preload_blocks(cpu, starts, 4));
+
+	const RBT_CpuBlock *body = nullptr;
+	for (u32 i = 0; i < _CPU_BLOCK_SLOTS; i += 1) {
+		TEST_ASSERT_TRUE(cpu->blocks[i].start_pc != _CODE_ADDR + 1);
+		if (cpu->blocks[i].start_pc == _CODE_ADDR + 2)
+			body = &cpu->blocks[i];
+	}
+	TEST_ASSERT_NOT_NULL(body);
+	TEST_ASSERT_EQUAL_UINT32(4, body->count);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 10, body->end_pc);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, nullptr));
+	TEST_ASSERT_EQUAL_UINT32(10, cpu->state.gpr.data[0]);
+	TEST_ASSERT_EQUAL_UINT32(55, cpu->state.gpr.data[2]);
+	TEST_ASSERT_EQUAL_UINT32(7, cpu->state.gpr.data[3]);
+	TEST_ASSERT_TRUE(body->exits[1] == body);
+}
+
+// ----------------------------------------------------------------------------
+// Condition codes
+// ----------------------------------------------------------------------------
+
+// MOVEQ #127, D0; MOVEQ #1, D1; ADD.b D1, D0
+void test_ccr_add_overflow(void) {
+	_load((u16[]) { 0x707f, 0x7201, 0xd001 }, 3);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 12, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(
+		RBT_SR_NEGATIVE | RBT_SR_OVERFLOW, cpu->state.sr & RBT_SR_CCR
+	);
+}
+
+void test_ccr_neg_borrow(void) {
+	_load((u16[]) { 0x7001, 0x4480 }, 2); // MOVEQ #1, D0; NEG.l D0
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 8, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(
+		RBT_SR_NEGATIVE | RBT_SR_CARRY | RBT_SR_EXTEND, cpu->state.sr & RBT_SR_CCR
+	);
+}
+
+// MOVEQ #-1, D0; ADDQ.l #1, D0; MOVEQ #5, D1
+// MOVEQ leaves X alone, so the carry out of ADDQ must survive it
+void test_ccr_extend_survives_logic_op(void) {
+	_load((u16[]) { 0x70ff, 0x5280, 0x7205 }, 3);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 16, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(RBT_SR_EXTEND, cpu->state.sr & RBT_SR_CCR);
+}
+
+// MOVEQ #-1, D0; ADDQ.l #1, D0; MOVEQ #1, D0; MOVEQ #2, D1; CMP.l D1, D0
+// CMP borrows without touching the X left by ADDQ
+void test_ccr_cmp_borrow_keeps_extend(void) {
+	_load((u16[]) { 0x70ff, 0x5280, 0x7001, 0x7202, 0xb081, 0x60fe }, 6);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(
+		RBT_SR_EXTEND | RBT_SR_NEGATIVE | RBT_SR_CARRY, cpu->state.sr & RBT_SR_CCR
+	);
+}
+
+// CMPA.w #$ffff, A0 compares the sign-extended source against all of A0
+void test_ccr_cmpa_sign_extends(void) {
+	cpu->state.gpr.addr[0] = 0xffff'ffff;
+	_load((u16[]) { 0xb0fc, 0xffff, 0x60fe }, 3);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(RBT_SR_ZERO, cpu->state.sr & RBT_SR_CCR);
+}
+
+// MOVEQ #-128, D0; CMPI.b #1, D0
+void test_ccr_cmpi_overflow(void) {
+	_load((u16[]) { 0x7080, 0x0c00, 0x0001, 0x60fe }, 4);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(RBT_SR_OVERFLOW, cpu->state.sr & RBT_SR_CCR);
+}
+
+// MOVEQ #-8, D0; BTST #1, D0 sets Z and keeps the pending N of MOVEQ
+void test_ccr_btst_register(void) {
+	_load((u16[]) { 0x70f8, 0x0800, 0x0001, 0x60fe }, 4);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(RBT_SR_NEGATIVE | RBT_SR_ZERO, cpu->state.sr & RBT_SR_CCR);
+}
+
+// MOVEQ #0, D0; BTST D1, (A0) with D1 = 9 tests bit 1 of the byte
+void test_ccr_btst_memory_wraps_bit(void) {
+	cpu->state.gpr.addr[0] = 0x2000;
+	cpu->state.gpr.data[1] = 9;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_byte(bus, 0x2000, 0x02));
+	_load((u16[]) { 0x7000, 0x0310, 0x60fe }, 3);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(0, cpu->state.sr & RBT_SR_CCR);
+}
+
+void test_ccr_move_from_sr_sees_pending_flags(void) {
+	_load((u16[]) { 0x7000, 0x40c1 }, 2); // MOVEQ #0, D0; MOVE SR, D1
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 8, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX32(0x04, cpu->state.gpr.data[1] & 0x1f); // Z
+}
+
+void test_ccr_move_to_ccr_replaces_pending_flags(void) {
+	cpu->state.gpr.data[1] = 0x01;
+	_load((u16[]) { 0x7000, 0x44c1 }, 2); // MOVEQ #0, D0; MOVE D1, CCR
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 8, nullptr));
+
+	TEST_ASSERT_EQUAL_HEX16(RBT_SR_CARRY, cpu->state.sr & RBT_SR_CCR);
+}
+
+void test_sr_view_round_trip(void) {
+	u16 sr = RBT_SR_TRACE1 | RBT_SR_SUPERVISOR | (5 << RBT_SR_INTERRUPT_SHIFT)
+		   | RBT_SR_EXTEND | RBT_SR_ZERO | RBT_SR_CARRY;
+
+	RBT_StatusRegister view = rbt_sr_view(sr);
+	TEST_ASSERT_TRUE(view.trace1);
+	TEST_ASSERT_TRUE(view.supervisor);
+	TEST_ASSERT_EQUAL_UINT8(5, view.interrupt_priority);
+	TEST_ASSERT_TRUE(view.extend);
+	TEST_ASSERT_FALSE(view.negative);
+	TEST_ASSERT_TRUE(view.zero);
+	TEST_ASSERT_FALSE(view.overflow);
+	TEST_ASSERT_TRUE(view.carry);
+
+	TEST_ASSERT_EQUAL_HEX16(sr, rbt_sr_pack(&view));
+}
+
+// ----------------------------------------------------------------------------
+// Error context
+// ----------------------------------------------------------------------------
+
+// MOVE.w ($400000).l, D0 hits the reserved bus error range while `cpu` runs, the
+// entry carries its PC rather than the one of the CPU created last
+void test_errors_carry_running_pc(void) {
+	RBT_Cpu *other = rbt_create_cpu(nullptr);
+	TEST_ASSERT_NOT_NULL(other);
+	rbt_cpu_attach_bus(other, bus);
+	other->state.pc = 0x2000;
+
+	_load((u16[]) { 0x3039, 0x0040, 0x0000 }, 3);
+	(void)rbt_cpu_step(cpu, nullptr);
+
+	const RBT_ErrorEntry *last = rbt_query_last_error();
+	TEST_ASSERT_NOT_NULL(last);
+	TEST_ASSERT_EQUAL(RBT_ERR_MEM_BUS_ERROR, last->code);
+	TEST_ASSERT_NOT_NULL(strstr(last->msg, " (pc 0x001006)"));
+
+	// Outside of a run there's no PC to report, even with both CPUs still alive
+	u16 word;
+	(void)rbt_bus_read_word(bus, 0x40'0000, &word);
+	TEST_ASSERT_NULL(strstr(rbt_query_last_error()->msg, " (pc"));
+
+	// Nor once the CPU that ran last is gone
+	rbt_destroy_cpu(other);
+	(void)rbt_bus_read_word(bus, 0x40'0000, &word);
+	TEST_ASSERT_NULL(strstr(rbt_query_last_error()->msg, " (pc"));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Decode cache
+	RUN_TEST(test_icache_hit_on_same_pc);
+	RUN_TEST(test_icache_invalidated_by_write);
+	RUN_TEST(test_icache_invalidated_by_mirror_write);
+	RUN_TEST(test_icache_survives_unrelated_write);
+	RUN_TEST(test_icache_flush);
+
+	// Batch execution
+	RUN_TEST(test_run_stops_at_budget);
+	RUN_TEST(test_run_zero_budget);
+	RUN_TEST(test_run_stops_when_halted);
+	RUN_TEST(test_run_calls_hook_per_instruction);
+	RUN_TEST(test_run_stops_on_hook);
+	RUN_TEST(test_run_stops_on_pending_interrupt);
+	RUN_TEST(test_run_ignores_masked_interrupt);
+	RUN_TEST(test_run_until_event);
+	RUN_TEST(test_run_until_due_event);
+
+	// STOP and idle loops
+	RUN_TEST(test_stop_waits_for_interrupt);
+	RUN_TEST(test_stop_in_user_mode);
+	RUN_TEST(test_stop_run_until_event);
+	RUN_TEST(test_idle_loop_skipped);
+	RUN_TEST(test_idle_loop_runs_by_default);
+	RUN_TEST(test_busy_loop_not_skipped);
+	RUN_TEST(test_idle_loop_btst_poll);
+	RUN_TEST(test_idle_loop_cmp_poll);
+
+	// Basic blocks
+	RUN_TEST(test_blocks_match_single_instructions);
+	RUN_TEST(test_block_links_its_successor);
+	RUN_TEST(test_block_sees_its_own_writes);
+	RUN_TEST(test_preloaded_blocks);
+
+	// Condition codes
+	RUN_TEST(test_ccr_add_overflow);
+	RUN_TEST(test_ccr_neg_borrow);
+	RUN_TEST(test_ccr_extend_survives_logic_op);
+	RUN_TEST(test_ccr_cmp_borrow_keeps_extend);
+	RUN_TEST(test_ccr_cmpa_sign_extends);
+	RUN_TEST(test_ccr_cmpi_overflow);
+	RUN_TEST(test_ccr_btst_register);
+	RUN_TEST(test_ccr_btst_memory_wraps_bit);
+	RUN_TEST(test_ccr_move_from_sr_sees_pending_flags);
+	RUN_TEST(test_ccr_move_to_ccr_replaces_pending_flags);
+	RUN_TEST(test_sr_view_round_trip);
+
+	// Error context
+	RUN_TEST(test_errors_carry_running_pc);
+
+	return UNITY_END();
+}
@@ -22,6 +22,7 @@
 #include "rbt/cpu/types.h"
 #include "rbt/error_codes.h"
 
+#include <string.h>
 #include <unity.h>
 
 // ----------------------------------------------------------------------------
@@ -521,6 +522,44 @@ void test_decode_ror_w_memory(void) {
 	TEST_ASSERT_EQUAL(1, i.word_count);
 }
 
+// ----------------------------------------------------------------------------
+// Opcode table
+// ----------------------------------------------------------------------------
+
+// Every opcode word must decode exactly like the reference decoder
+void test_decode_table_matches_reference(void) {
+	static const u16 ext[] = { 0x0000, 0x1234, 0x8001, 0x00fe, 0x7ffc, 0xffff };
+	const u32 addr = 0x1000; // RAM, so each opcode can be patched in place
+
+	for (u32 i = 0; i < sizeof(ext) / sizeof(ext[0]); i += 1) {
+		TEST_ASSERT_EQUAL(
+			RBT_ERR_SUCCESS, rbt_bus_write_word(bus, addr + 2 + (i * 2), ext[i])
+		);
+	}
+
+	// Illegal encodings are expected, keep the error stack quiet
+	rbt_set_err_min_severity(RBT_SEVERITY_FATAL);
+
+	for (u32 opcode = 0; opcode <= 0xffff; opcode += 1) {
+		TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, addr, opcode));
+
+		// The decoders only write the fields an opcode uses, the fill shows up
+		// wherever one of them reads a field the other didn't write
+		RBT_Instruction expected, actual;
+		memset(&expected, 0xa5, sizeof(RBT_Instruction));
+		memset(&actual, 0xa5, sizeof(RBT_Instruction));
+		RBT_ErrorCode ref = _decode_instruction_reference(bus, addr, &expected);
+		RBT_ErrorCode err = _decode_instruction(bus, addr, &actual);
+
+		TEST_ASSERT_EQUAL_MESSAGE(ref, err, "status mismatch");
+		if (ref == RBT_ERR_SUCCESS) {
+			TEST_ASSERT_TRUE(_decode_instruction_equal(&expected, &actual));
+		}
+	}
+
+	rbt_set_err_min_severity(RBT_SEVERITY_INFO);
+}
+
 // ----------------------------------------------------------------------------
 // Main
 // ----------------------------------------------------------------------------
@@ -567,5 +606,8 @@ int main(void) {
 	RUN_TEST(test_decode_asl_w_imm);
 	RUN_TEST(test_decode_ror_w_memory);
 
+	// Opcode table
+	RUN_TEST(test_decode_table_matches_reference);
+
 	return UNITY_END();
 }
@@ -0,0 +1,391 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "cpu/bus_internal.h"
+#include "cpu/cpu_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+#include "unity_internals.h"
+
+#include <unity.h>
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+enum {
+	_CODE_ADDR = 0x1000,	// Programs are placed in RAM
+	_HANDLER_ADDR = 0x2000,	// Every vector points at a NOP here
+	_SSP = 0x8000,
+	_USP = 0x4000,
+
+	_OP_NOP = 0x4e71,
+	_OP_RTE = 0x4e73,
+	_OP_ILLEGAL = 0x4afc,
+	_OP_TRAP_3 = 0x4e43,
+	_OP_TRAPV = 0x4e76,
+	_OP_CHK_D1_D0 = 0x4181,
+	_OP_MOVE_D0_IND_A0 = 0x3080, // MOVE.W D0, (A0)
+	_OP_MOVE_IND_A0_D0 = 0x3010, // MOVE.W (A0), D0
+};
+
+static RBT_MemoryBus *bus;
+static RBT_Cpu *cpu;
+
+static void _write_word(u32 addr, u16 word) {
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, addr, word));
+}
+
+static u16 _read_word(u32 addr) {
+	u16 word;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_word(bus, addr, &word));
+	return word;
+}
+
+static u32 _read_long(u32 addr) {
+	u32 long_;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_read_long(bus, addr, &long_));
+	return long_;
+}
+
+static void _set_vector(u32 vbr, u32 vec, u32 handler) {
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_long(bus, vbr + (vec * 4), handler));
+}
+
+// Writes `count` opcode words at _CODE_ADDR and points the PC at them.
+static void _load(const u16 *words, usize count) {
+	for (usize i = 0; i < count; i += 1) {
+		_write_word(_CODE_ADDR + (i * 2), words[i]);
+	}
+
+	cpu->state.pc = _CODE_ADDR;
+}
+
+static u16 _step(void) {
+	u16 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, &cycles));
+	return cycles;
+}
+
+static void _create_cpu(RBT_CpuModel model) {
+	if (cpu)
+		rbt_destroy_cpu(cpu);
+
+	cpu = rbt_create_cpu(&(RBT_CpuConfig) { .model = model });
+	TEST_ASSERT_NOT_NULL(cpu);
+	rbt_cpu_attach_bus(cpu, bus);
+
+	cpu->state.sr = RBT_SR_SUPERVISOR;
+	cpu->state.ssp = _SSP;
+	cpu->state.usp = _USP;
+	cpu->state.gpr.sp = cpu->state.ssp;
+}
+
+void setUp(void) {
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	bus = rbt_create_bus(&cfg);
+	TEST_ASSERT_NOT_NULL(bus);
+
+	for (u32 vec = _VEC_BUS_ERROR; vec <= _VEC_USER_LAST; vec += 1) {
+		_set_vector(0, vec, _HANDLER_ADDR);
+	}
+	_write_word(_HANDLER_ADDR, _OP_NOP);
+
+	cpu = nullptr;
+	_create_cpu(RBT_CPU_M68000);
+}
+
+void tearDown(void) {
+	rbt_destroy_cpu(cpu);
+	rbt_destroy_bus(bus);
+	rbt_err_flush();
+}
+
+// ----------------------------------------------------------------------------
+// Group 1/2 frames
+// ----------------------------------------------------------------------------
+
+void test_trap_frame_m68000(void) {
+	cpu->state.sr |= RBT_SR_CARRY;
+	_load((u16[]) { _OP_TRAP_3 }, 1);
+
+	TEST_ASSERT_EQUAL(34, _step());
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR, cpu->state.pc);
+	TEST_ASSERT_EQUAL_HEX32(_SSP - _CPU_FRAME_SHORT, cpu->state.gpr.sp);
+	TEST_ASSERT_EQUAL_HEX32(cpu->state.gpr.sp, cpu->state.ssp);
+
+	u32 sp = cpu->state.gpr.sp;
+	TEST_ASSERT_EQUAL_HEX16(RBT_SR_SUPERVISOR | RBT_SR_CARRY, _read_word(sp));
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, _read_long(sp + 2));
+}
+
+void test_trap_frame_m68010(void) {
+	_create_cpu(RBT_CPU_M68010);
+	_load((u16[]) { _OP_TRAP_3 }, 1);
+
+	TEST_ASSERT_EQUAL(38, _step());
+	TEST_ASSERT_EQUAL_HEX32(_SSP - _CPU_FRAME_FMT0, cpu->state.gpr.sp);
+
+	u32 sp = cpu->state.gpr.sp;
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, _read_long(sp + 2));
+	TEST_ASSERT_EQUAL_HEX16(0x0000 | ((_VEC_TRAP_0 + 3) * 4), _read_word(sp + 6));
+}
+
+// Rejected instructions stack their own address
+void test_illegal_stacks_instruction_address(void) {
+	_load((u16[]) { _OP_ILLEGAL }, 1);
+
+	TEST_ASSERT_EQUAL(34, _step());
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR, _read_long(cpu->state.gpr.sp + 2));
+}
+
+void test_trapv_only_on_overflow(void) {
+	_load((u16[]) { _OP_TRAPV, _OP_TRAPV }, 2);
+
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, cpu->state.pc);
+
+	cpu->state.sr |= RBT_SR_OVERFLOW;
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR, cpu->state.pc);
+}
+
+void test_chk_out_of_bounds(void) {
+	cpu->state.gpr.data[1] = 10;
+	cpu->state.gpr.data[0] = 10;
+	_load((u16[]) { _OP_CHK_D1_D0, _OP_CHK_D1_D0, _OP_CHK_D1_D0 }, 3);
+
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, cpu->state.pc);
+
+	cpu->state.gpr.data[0] = 0xffff;
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR, cpu->state.pc);
+	TEST_ASSERT_TRUE(cpu->state.sr & RBT_SR_NEGATIVE);
+
+	cpu->state.pc = _CODE_ADDR + 4;
+	cpu->state.gpr.data[0] = 11;
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR, cpu->state.pc);
+	TEST_ASSERT_FALSE(cpu->state.sr & RBT_SR_NEGATIVE);
+}
+
+// ----------------------------------------------------------------------------
+// Supervisor mode and RTE
+// ----------------------------------------------------------------------------
+
+void test_trap_from_user_mode_switches_stack(void) {
+	_write_word(_HANDLER_ADDR, _OP_RTE);
+	cpu->state.sr = 0; // User mode
+	cpu->state.gpr.sp = _USP;
+	_load((u16[]) { _OP_TRAP_3, _OP_NOP }, 2);
+
+	_step();
+	TEST_ASSERT_TRUE(cpu->state.sr & RBT_SR_SUPERVISOR);
+	TEST_ASSERT_EQUAL_HEX32(_SSP - _CPU_FRAME_SHORT, cpu->state.gpr.sp);
+	TEST_ASSERT_EQUAL_HEX32(_USP, cpu->state.usp);
+
+	_step(); // RTE
+	TEST_ASSERT_FALSE(cpu->state.sr & RBT_SR_SUPERVISOR);
+	TEST_ASSERT_EQUAL_HEX32(_USP, cpu->state.gpr.sp);
+	TEST_ASSERT_EQUAL_HEX32(_SSP, cpu->state.ssp);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, cpu->state.pc);
+}
+
+void test_rte_round_trip_m68010(void) {
+	_create_cpu(RBT_CPU_M68010);
+	_write_word(_HANDLER_ADDR, _OP_RTE);
+	_load((u16[]) { _OP_TRAP_3 }, 1);
+
+	_step();
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_SSP, cpu->state.gpr.sp);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, cpu->state.pc);
+}
+
+void test_rte_in_user_mode_is_privileged(void) {
+	cpu->state.sr = 0;
+	cpu->state.gpr.sp = _USP;
+	_load((u16[]) { _OP_RTE }, 1);
+
+	TEST_ASSERT_EQUAL(34, _step());
+	TEST_ASSERT_TRUE(cpu->state.sr & RBT_SR_SUPERVISOR);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR, _read_long(cpu->state.gpr.sp + 2));
+}
+
+// Unknown formats are left on the stack
+void test_rte_format_error_m68010(void) {
+	_create_cpu(RBT_CPU_M68010);
+	u32 sp = _SSP - _CPU_FRAME_FMT0;
+	_write_word(sp + 6, 0x3000);
+	cpu->state.gpr.sp = sp;
+	_load((u16[]) { _OP_RTE }, 1);
+
+	TEST_ASSERT_EQUAL(50, _step());
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR, cpu->state.pc);
+	TEST_ASSERT_EQUAL_HEX32(sp - _CPU_FRAME_FMT0, cpu->state.gpr.sp);
+	TEST_ASSERT_EQUAL_HEX16(_VEC_FMT_ERROR * 4, _read_word(cpu->state.gpr.sp + 6));
+}
+
+// Trace is taken after the instruction that started with T1 set
+void test_trace_after_instruction(void) {
+	cpu->state.sr |= RBT_SR_TRACE1;
+	_load((u16[]) { _OP_NOP, _OP_NOP }, 2);
+
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, cpu->state.pc);
+
+	TEST_ASSERT_EQUAL(34 + 4, _step()); // Trace, then the handler's NOP
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR + 2, cpu->state.pc);
+	TEST_ASSERT_FALSE(cpu->state.sr & RBT_SR_TRACE1);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, _read_long(cpu->state.gpr.sp + 2));
+}
+
+// ----------------------------------------------------------------------------
+// Vector table
+// ----------------------------------------------------------------------------
+
+void test_vector_table_is_cached(void) {
+	TEST_ASSERT_NOT_NULL(cpu->vectors);
+
+	_load((u16[]) { _OP_TRAP_3 }, 1);
+	_set_vector(0, _VEC_TRAP_0 + 3, _HANDLER_ADDR + 0x100);
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR + 0x100, cpu->state.pc);
+}
+
+void test_vector_table_follows_vbr(void) {
+	_create_cpu(RBT_CPU_M68010);
+	_set_vector(0x3000, _VEC_TRAP_0 + 3, _HANDLER_ADDR + 0x200);
+	cpu->state.vbr = 0x3000;
+	_load((u16[]) { _OP_TRAP_3 }, 1);
+
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR + 0x200, cpu->state.pc);
+	TEST_ASSERT_EQUAL_HEX32(0x3000, cpu->vectors_vbr);
+	TEST_ASSERT_NOT_NULL(cpu->vectors);
+}
+
+// The table wraps into the RAM mirror, so it isn't contiguous in host memory
+void test_vector_table_read_through_bus(void) {
+	_create_cpu(RBT_CPU_M68010);
+	u32 vbr = 0x3'fe00;
+	_set_vector(vbr, _VEC_TRAP_0 + 3, _HANDLER_ADDR + 0x300);
+	cpu->state.vbr = vbr;
+	_load((u16[]) { _OP_TRAP_3 }, 1);
+
+	_step();
+	TEST_ASSERT_NULL(cpu->vectors);
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR + 0x300, cpu->state.pc);
+}
+
+// ----------------------------------------------------------------------------
+// Group 0
+// ----------------------------------------------------------------------------
+
+void test_bus_error_frame_m68010(void) {
+	_create_cpu(RBT_CPU_M68010);
+	cpu->state.gpr.addr[0] = _BUS_RESERVED_BERR_ADDR;
+	_load((u16[]) { _OP_MOVE_D0_IND_A0 }, 1);
+
+	_step();
+	TEST_ASSERT_TRUE(cpu->pending.bus_error);
+
+	TEST_ASSERT_EQUAL(126 + 4, _step()); // Bus error, then the handler's NOP
+	TEST_ASSERT_EQUAL_HEX32(_SSP - _CPU_FRAME_FMT8, cpu->state.gpr.sp);
+
+	u32 sp = cpu->state.gpr.sp;
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, _read_long(sp + 2));
+	TEST_ASSERT_EQUAL_HEX16(0x8000 | (_VEC_BUS_ERROR * 4), _read_word(sp + 6));
+	TEST_ASSERT_EQUAL_HEX16((1u << 12) | 5, _read_word(sp + 8)); // DF, write, FC 5
+	TEST_ASSERT_EQUAL_HEX32(_BUS_RESERVED_BERR_ADDR, _read_long(sp + 10));
+	TEST_ASSERT_EQUAL_HEX16(_OP_MOVE_D0_IND_A0, _read_word(sp + 24));
+}
+
+void test_address_error_frame_m68000(void) {
+	cpu->state.gpr.addr[0] = _CODE_ADDR + 0x101;
+	_load((u16[]) { _OP_MOVE_IND_A0_D0 }, 1);
+
+	_step();
+	TEST_ASSERT_TRUE(cpu->pending.address_error);
+
+	TEST_ASSERT_EQUAL(50 + 4, _step());
+	TEST_ASSERT_EQUAL_HEX32(_SSP - _CPU_FRAME_GROUP0, cpu->state.gpr.sp);
+
+	u32 sp = cpu->state.gpr.sp;
+	TEST_ASSERT_EQUAL_HEX16((1u << 4) | 5, _read_word(sp)); // Read, FC 5
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 0x101, _read_long(sp + 2));
+	TEST_ASSERT_EQUAL_HEX16(_OP_MOVE_IND_A0_D0, _read_word(sp + 6));
+	TEST_ASSERT_EQUAL_HEX16(RBT_SR_SUPERVISOR, _read_word(sp + 8));
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, _read_long(sp + 10));
+}
+
+// Fetch faults are taken before anything runs at the bad PC
+void test_fetch_from_odd_pc(void) {
+	cpu->state.pc = _CODE_ADDR + 1;
+
+	_step();
+	TEST_ASSERT_EQUAL_HEX32(_HANDLER_ADDR + 2, cpu->state.pc);
+	TEST_ASSERT_TRUE(cpu->fault.is_fetch);
+	TEST_ASSERT_EQUAL_HEX16((1u << 4) | 6, _read_word(cpu->state.gpr.sp)); // FC 6
+}
+
+void test_double_fault_halts(void) {
+	cpu->state.gpr.addr[0] = _BUS_RESERVED_BERR_ADDR;
+	cpu->state.gpr.sp = _BUS_RESERVED_BERR_ADDR + 0x100;
+	_load((u16[]) { _OP_MOVE_D0_IND_A0 }, 1);
+
+	_step();
+	TEST_ASSERT_EQUAL(RBT_ERR_CPU_HALTED, rbt_cpu_step(cpu, nullptr));
+	TEST_ASSERT_TRUE(cpu->is_halted);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Group 1/2 frames
+	RUN_TEST(test_trap_frame_m68000);
+	RUN_TEST(test_trap_frame_m68010);
+	RUN_TEST(test_illegal_stacks_instruction_address);
+	RUN_TEST(test_trapv_only_on_overflow);
+	RUN_TEST(test_chk_out_of_bounds);
+
+	// Supervisor mode and RTE
+	RUN_TEST(test_trap_from_user_mode_switches_stack);
+	RUN_TEST(test_rte_round_trip_m68010);
+	RUN_TEST(test_rte_in_user_mode_is_privileged);
+	RUN_TEST(test_rte_format_error_m68010);
+	RUN_TEST(test_trace_after_instruction);
+
+	// Vector table
+	RUN_TEST(test_vector_table_is_cached);
+	RUN_TEST(test_vector_table_follows_vbr);
+	RUN_TEST(test_vector_table_read_through_bus);
+
+	// Group 0
+	RUN_TEST(test_bus_error_frame_m68010);
+	RUN_TEST(test_address_error_frame_m68000);
+	RUN_TEST(test_fetch_from_odd_pc);
+	RUN_TEST(test_double_fault_halts);
+
+	return UNITY_END();
+}
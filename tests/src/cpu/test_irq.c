@@ -0,0 +1,322 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "cpu/cpu_internal.h"
+#include "cpu/irq_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/irq.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+#include "unity_internals.h"
+
+#include <stdint.h>
+#include <unity.h>
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+enum {
+	_CODE_ADDR = 0x1000,
+	_ACKED_MAX = 8,
+};
+
+static RBT_MemoryBus *bus;
+static RBT_Cpu *cpu;
+static RBT_IrqController *irq;
+
+static u32 acked_count;
+static RBT_IrqSource acked[_ACKED_MAX];
+
+static u16 _ack_record(void *userdata, RBT_IrqSource source) {
+	TEST_ASSERT_TRUE(acked_count < _ACKED_MAX);
+	acked[acked_count] = source;
+	acked_count += 1;
+	return (u16)(uintptr_t)userdata;
+}
+
+// Host lines only, the controller's byte masked out
+static u32 _host_lines(void) {
+	return cpu->irq_lines & (_CPU_IRQ_LEVEL_MASK << _CPU_IRQ_HOST_SHIFT);
+}
+
+static u32 _ctrl_lines(void) {
+	return (cpu->irq_lines >> _CPU_IRQ_CTRL_SHIFT) & _CPU_IRQ_LEVEL_MASK;
+}
+
+// Runs a single NOP, taking whatever interrupt is pending first
+static void _step(void) {
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_word(bus, _CODE_ADDR, 0x4e71));
+	cpu->state.pc = _CODE_ADDR;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+}
+
+void setUp(void) {
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	bus = rbt_create_bus(&cfg);
+	TEST_ASSERT_NOT_NULL(bus);
+
+	cpu = rbt_create_cpu(nullptr);
+	TEST_ASSERT_NOT_NULL(cpu);
+	rbt_cpu_attach_bus(cpu, bus);
+
+	irq = rbt_create_irq_controller();
+	TEST_ASSERT_NOT_NULL(irq);
+	rbt_cpu_attach_irq_controller(cpu, irq);
+
+	cpu->state.sr = RBT_SR_SUPERVISOR;
+	cpu->state.ssp = 0x8000;
+	cpu->state.gpr.sp = cpu->state.ssp;
+
+	// Every handler is the NOP run by _step()
+	for (u32 vec = _VEC_BUS_ERROR; vec <= _VEC_USER_LAST; vec += 1) {
+		TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_write_long(bus, vec * 4, _CODE_ADDR));
+	}
+
+	acked_count = 0;
+}
+
+void tearDown(void) {
+	rbt_destroy_irq_controller(irq);
+	rbt_destroy_cpu(cpu);
+	rbt_destroy_bus(bus);
+	rbt_err_flush();
+}
+
+// ----------------------------------------------------------------------------
+// Controller
+// ----------------------------------------------------------------------------
+
+void test_irq_default_levels(void) {
+	TEST_ASSERT_EQUAL_UINT8(6, rbt_irq_level(irq, RBT_IRQ_VDP_HBLANK));
+	TEST_ASSERT_EQUAL_UINT8(5, rbt_irq_level(irq, RBT_IRQ_VDP_VBLANK));
+	TEST_ASSERT_EQUAL_UINT8(4, rbt_irq_level(irq, RBT_IRQ_VDP_BLITTER));
+	TEST_ASSERT_EQUAL_UINT8(3, rbt_irq_level(irq, RBT_IRQ_IO_PS2));
+	TEST_ASSERT_EQUAL_UINT8(2, rbt_irq_level(irq, RBT_IRQ_EXT3));
+}
+
+void test_irq_raise_and_lower_drive_lines(void) {
+	rbt_irq_raise(irq, RBT_IRQ_VDP_VBLANK);
+	rbt_irq_raise(irq, RBT_IRQ_EXT1);
+	TEST_ASSERT_TRUE(rbt_irq_is_raised(irq, RBT_IRQ_VDP_VBLANK));
+	TEST_ASSERT_EQUAL_HEX32((1u << 5) | (1u << 2), _ctrl_lines());
+
+	rbt_irq_lower(irq, RBT_IRQ_VDP_VBLANK);
+	TEST_ASSERT_FALSE(rbt_irq_is_raised(irq, RBT_IRQ_VDP_VBLANK));
+	TEST_ASSERT_EQUAL_HEX32(1u << 2, _ctrl_lines());
+
+	rbt_irq_lower(irq, RBT_IRQ_EXT1);
+	TEST_ASSERT_EQUAL_HEX32(0, cpu->irq_lines);
+}
+
+// A line stays up while any source on its level is raised
+void test_irq_shared_level(void) {
+	rbt_irq_raise(irq, RBT_IRQ_IO_SNES);
+	rbt_irq_raise(irq, RBT_IRQ_IO_PS2);
+	rbt_irq_lower(irq, RBT_IRQ_IO_SNES);
+	TEST_ASSERT_EQUAL_HEX32(1u << 3, _ctrl_lines());
+}
+
+void test_irq_set_level_moves_raised_source(void) {
+	rbt_irq_raise(irq, RBT_IRQ_EXT0);
+	rbt_irq_set_level(irq, RBT_IRQ_EXT0, 4);
+	TEST_ASSERT_EQUAL_HEX32(1u << 4, _ctrl_lines());
+
+	rbt_irq_set_level(irq, RBT_IRQ_EXT0, RBT_IRQ_LEVEL_NONE);
+	TEST_ASSERT_EQUAL_HEX32(0, _ctrl_lines());
+	TEST_ASSERT_TRUE(rbt_irq_is_raised(irq, RBT_IRQ_EXT0));
+}
+
+// Sources raised before attaching are driven as soon as the CPU is attached
+void test_irq_attach_drives_raised_sources(void) {
+	rbt_cpu_attach_irq_controller(cpu, nullptr);
+	rbt_irq_raise(irq, RBT_IRQ_VDP_BLITTER);
+	TEST_ASSERT_EQUAL_HEX32(0, cpu->irq_lines);
+
+	rbt_cpu_attach_irq_controller(cpu, irq);
+	TEST_ASSERT_EQUAL_HEX32(1u << 4, _ctrl_lines());
+}
+
+void test_irq_destroy_detaches(void) {
+	rbt_irq_raise(irq, RBT_IRQ_VDP_HBLANK);
+	rbt_destroy_irq_controller(irq);
+	irq = nullptr;
+
+	TEST_ASSERT_NULL(cpu->irq);
+	TEST_ASSERT_EQUAL_HEX32(0, cpu->irq_lines);
+}
+
+// ----------------------------------------------------------------------------
+// Acknowledge
+// ----------------------------------------------------------------------------
+
+void test_irq_ack_autovector_without_callback(void) {
+	rbt_irq_raise(irq, RBT_IRQ_VDP_VBLANK);
+	TEST_ASSERT_EQUAL_UINT8(_VEC_AUTOVEC_L5, _irq_acknowledge(irq, 5));
+}
+
+void test_irq_ack_vectored(void) {
+	rbt_irq_set_ack_callback(irq, RBT_IRQ_EXT2, _ack_record, (void *)(uintptr_t)0x80);
+	rbt_irq_raise(irq, RBT_IRQ_EXT2);
+
+	TEST_ASSERT_EQUAL_UINT8(0x80, _irq_acknowledge(irq, 2));
+	TEST_ASSERT_EQUAL_UINT32(1, acked_count);
+	TEST_ASSERT_EQUAL(RBT_IRQ_EXT2, acked[0]);
+}
+
+void test_irq_ack_callback_may_autovector(void) {
+	rbt_irq_set_ack_callback(
+		irq, RBT_IRQ_EXT0, _ack_record, (void *)(uintptr_t)RBT_IRQ_AUTOVECTOR
+	);
+	rbt_irq_raise(irq, RBT_IRQ_EXT0);
+	TEST_ASSERT_EQUAL_UINT8(_VEC_AUTOVEC_L2, _irq_acknowledge(irq, 2));
+}
+
+// H-Blank comes before the line compare on the same level
+void test_irq_ack_priority_within_level(void) {
+	rbt_irq_set_ack_callback(irq, RBT_IRQ_VDP_HBLANK, _ack_record, (void *)(uintptr_t)64);
+	rbt_irq_set_ack_callback(irq, RBT_IRQ_VDP_LINE, _ack_record, (void *)(uintptr_t)65);
+	rbt_irq_raise(irq, RBT_IRQ_VDP_LINE);
+	rbt_irq_raise(irq, RBT_IRQ_VDP_HBLANK);
+
+	TEST_ASSERT_EQUAL_UINT8(64, _irq_acknowledge(irq, 6));
+	rbt_irq_lower(irq, RBT_IRQ_VDP_HBLANK);
+	TEST_ASSERT_EQUAL_UINT8(65, _irq_acknowledge(irq, 6));
+}
+
+void test_irq_ack_spurious(void) {
+	TEST_ASSERT_EQUAL_UINT8(_VEC_SPURIOUS, _irq_acknowledge(irq, 3));
+}
+
+// ----------------------------------------------------------------------------
+// CPU
+// ----------------------------------------------------------------------------
+
+// The highest level wins and becomes the new interrupt mask
+void test_cpu_takes_highest_level(void) {
+	rbt_irq_set_ack_callback(irq, RBT_IRQ_VDP_VBLANK, _ack_record, (void *)(uintptr_t)70);
+	rbt_irq_set_ack_callback(irq, RBT_IRQ_EXT0, _ack_record, (void *)(uintptr_t)71);
+	rbt_irq_raise(irq, RBT_IRQ_EXT0);
+	rbt_irq_raise(irq, RBT_IRQ_VDP_VBLANK);
+
+	_step();
+	TEST_ASSERT_EQUAL_UINT32(1, acked_count);
+	TEST_ASSERT_EQUAL(RBT_IRQ_VDP_VBLANK, acked[0]);
+	TEST_ASSERT_EQUAL_UINT8(5, _sr_interrupt_priority(cpu->state.sr));
+
+	// Level 2 stays masked
+	_step();
+	TEST_ASSERT_EQUAL_UINT32(1, acked_count);
+}
+
+// Host lines are never acknowledged through the controller
+void test_cpu_host_line_is_autovectored(void) {
+	rbt_irq_set_ack_callback(irq, RBT_IRQ_IO_PS2, _ack_record, (void *)(uintptr_t)72);
+	rbt_cpu_set_irq_line(cpu, 3, true);
+
+	_step();
+	TEST_ASSERT_EQUAL_UINT32(0, acked_count);
+	TEST_ASSERT_EQUAL_UINT8(3, _sr_interrupt_priority(cpu->state.sr));
+}
+
+// Host and controller lines are ORed, neither can release the other's
+void test_cpu_host_and_controller_lines_are_ored(void) {
+	rbt_cpu_set_irq_line(cpu, 3, true);
+	rbt_irq_raise(irq, RBT_IRQ_IO_SNES);
+	rbt_irq_lower(irq, RBT_IRQ_IO_SNES);
+	TEST_ASSERT_EQUAL_HEX32(1u << 3, _host_lines());
+	TEST_ASSERT_EQUAL_UINT8(3, _cpu_irq_level(cpu->irq_lines));
+
+	rbt_irq_raise(irq, RBT_IRQ_IO_SNES);
+	rbt_cpu_set_irq_line(cpu, 3, false);
+	TEST_ASSERT_EQUAL_UINT8(3, _cpu_irq_level(cpu->irq_lines));
+}
+
+// Level 7 is taken with a mask of 7, but only once per rising edge
+void test_cpu_nmi_edge(void) {
+	cpu->state.sr |= RBT_SR_INTERRUPT;
+	rbt_cpu_set_irq_line(cpu, 7, true);
+	TEST_ASSERT_TRUE(cpu->irq_lines & _CPU_IRQ_NMI_EDGE);
+
+	_step();
+	TEST_ASSERT_FALSE(cpu->irq_lines & _CPU_IRQ_NMI_EDGE);
+
+	// Still asserted, no new edge
+	rbt_irq_set_level(irq, RBT_IRQ_EXT0, RBT_IRQ_LEVEL_NMI);
+	rbt_irq_raise(irq, RBT_IRQ_EXT0);
+	TEST_ASSERT_FALSE(cpu->irq_lines & _CPU_IRQ_NMI_EDGE);
+
+	rbt_cpu_set_irq_line(cpu, 7, false);
+	rbt_irq_lower(irq, RBT_IRQ_EXT0);
+	rbt_cpu_set_irq_line(cpu, 7, true);
+	TEST_ASSERT_TRUE(cpu->irq_lines & _CPU_IRQ_NMI_EDGE);
+}
+
+static RBT_ErrorCode _hook_raise_hblank(void *userdata, const RBT_Instruction *instr) {
+	(void)instr;
+	rbt_irq_raise(userdata, RBT_IRQ_VDP_HBLANK);
+	return RBT_ERR_SUCCESS;
+}
+
+// Raised while the first NOP runs, the run gives control back right after it
+void test_cpu_run_stops_on_controller_irq(void) {
+	cpu->cfg.hook = _hook_raise_hblank;
+	cpu->cfg.userdata = irq;
+	for (u32 i = 0; i < 4; i += 1) {
+		TEST_ASSERT_EQUAL(
+			RBT_ERR_SUCCESS, rbt_bus_write_word(bus, _CODE_ADDR + (i * 2), 0x4e71)
+		);
+	}
+	cpu->state.pc = _CODE_ADDR;
+
+	u32 cycles = 0;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 100, &cycles));
+	TEST_ASSERT_EQUAL_UINT32(4, cycles);
+	TEST_ASSERT_EQUAL_HEX32(_CODE_ADDR + 2, cpu->state.pc);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Controller
+	RUN_TEST(test_irq_default_levels);
+	RUN_TEST(test_irq_raise_and_lower_drive_lines);
+	RUN_TEST(test_irq_shared_level);
+	RUN_TEST(test_irq_set_level_moves_raised_source);
+	RUN_TEST(test_irq_attach_drives_raised_sources);
+	RUN_TEST(test_irq_destroy_detaches);
+
+	// Acknowledge
+	RUN_TEST(test_irq_ack_autovector_without_callback);
+	RUN_TEST(test_irq_ack_vectored);
+	RUN_TEST(test_irq_ack_callback_may_autovector);
+	RUN_TEST(test_irq_ack_priority_within_level);
+	RUN_TEST(test_irq_ack_spurious);
+
+	// CPU
+	RUN_TEST(test_cpu_takes_highest_level);
+	RUN_TEST(test_cpu_host_line_is_autovectored);
+	RUN_TEST(test_cpu_host_and_controller_lines_are_ored);
+	RUN_TEST(test_cpu_nmi_edge);
+	RUN_TEST(test_cpu_run_stops_on_controller_irq);
+
+	return UNITY_END();
+}
@@ -0,0 +1,198 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "cpu/cpu_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/irq.h"
+#include "rbt/cpu/machine.h"
+#include "rbt/cpu/scheduler.h"
+#include "rbt/error_codes.h"
+#include "unity_internals.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unity.h>
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+typedef struct RBT_TestAllocator {
+	u32 allocs;
+	u32 frees;
+	usize size;
+	usize alignment;
+	usize freed_size;
+	bool fail;
+} RBT_TestAllocator;
+
+static RBT_TestAllocator counts;
+
+static void *_test_alloc(void *userdata, usize size, usize alignment) {
+	RBT_TestAllocator *allocator = userdata;
+	allocator->allocs += 1;
+	allocator->size = size;
+	allocator->alignment = alignment;
+	return allocator->fail ? nullptr : aligned_alloc(alignment, size);
+}
+
+static void _test_free(void *userdata, void *block, usize size) {
+	RBT_TestAllocator *allocator = userdata;
+	allocator->frees += 1;
+	allocator->freed_size = size;
+	free(block);
+}
+
+static const RBT_Allocator _allocator = {
+	.alloc = _test_alloc,
+	.free = _test_free,
+	.userdata = &counts,
+};
+
+static const RBT_MachineConfig _config = {
+	.cpu = { .model = RBT_CPU_M68000 },
+	.bus = { .ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE } },
+	.allocator = &_allocator,
+};
+
+static bool _is_inside(const RBT_Machine *machine, const void *part) {
+	const u8 *start = (const u8 *)machine;
+	const u8 *at = part;
+	return at > start && at < start + counts.size;
+}
+
+void setUp(void) {
+	counts = (RBT_TestAllocator) {};
+}
+
+void tearDown(void) {
+	rbt_err_flush();
+}
+
+// ----------------------------------------------------------------------------
+// Layout
+// ----------------------------------------------------------------------------
+
+void test_machine_single_block(void) {
+	RBT_Machine *machine = rbt_create_machine(&_config);
+	TEST_ASSERT_NOT_NULL(machine);
+	TEST_ASSERT_EQUAL_UINT32(1, counts.allocs);
+
+	void *parts[] = {
+		rbt_machine_cpu(machine),
+		rbt_machine_bus(machine),
+		rbt_machine_irq(machine),
+		rbt_machine_scheduler(machine),
+	};
+	for (usize i = 0; i < sizeof(parts) / sizeof(parts[0]); i += 1) {
+		TEST_ASSERT_TRUE(_is_inside(machine, parts[i]));
+		TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)parts[i] % 64);
+	}
+
+	rbt_destroy_machine(machine);
+	TEST_ASSERT_EQUAL_UINT32(1, counts.frees);
+	TEST_ASSERT_EQUAL_UINT64(counts.size, counts.freed_size);
+}
+
+void test_machine_huge_pages_alignment(void) {
+	RBT_MachineConfig config = _config;
+	config.huge_pages = true;
+
+	RBT_Machine *machine = rbt_create_machine(&config);
+	TEST_ASSERT_NOT_NULL(machine);
+	TEST_ASSERT_EQUAL_UINT64(2 * 1024 * 1024, counts.alignment);
+	TEST_ASSERT_EQUAL_UINT64(0, counts.size % counts.alignment);
+
+	rbt_destroy_machine(machine);
+}
+
+void test_machine_default_allocator(void) {
+	RBT_MachineConfig config = _config;
+	config.allocator = nullptr;
+
+	for (u32 i = 0; i < 256; i += 1) {
+		RBT_Machine *machine = rbt_create_machine(&config);
+		TEST_ASSERT_NOT_NULL(machine);
+		rbt_destroy_machine(machine);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, counts.allocs);
+}
+
+// ----------------------------------------------------------------------------
+// Wiring and errors
+// ----------------------------------------------------------------------------
+
+// MOVEQ #5, D0 runs from the machine's RAM
+void test_machine_runs_code(void) {
+	RBT_Machine *machine = rbt_create_machine(&_config);
+	TEST_ASSERT_NOT_NULL(machine);
+	RBT_Cpu *cpu = rbt_machine_cpu(machine);
+
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_write_word(rbt_machine_bus(machine), 0x1000, 0x7005)
+	);
+	cpu->state.pc = 0x1000;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_step(cpu, nullptr));
+	TEST_ASSERT_EQUAL_UINT32(5, cpu->state.gpr.data[0]);
+
+	rbt_destroy_machine(machine);
+}
+
+void test_machine_irq_wired_to_cpu(void) {
+	RBT_Machine *machine = rbt_create_machine(&_config);
+	TEST_ASSERT_NOT_NULL(machine);
+
+	rbt_irq_raise(rbt_machine_irq(machine), RBT_IRQ_EXT0);
+	TEST_ASSERT_EQUAL_UINT8(2, _cpu_irq_level(rbt_machine_cpu(machine)->irq_lines));
+
+	rbt_destroy_machine(machine);
+}
+
+void test_machine_invalid_bus_config(void) {
+	RBT_MachineConfig config = _config;
+	config.bus.ram_slots[0] = RBT_RAM_NONE;
+
+	TEST_ASSERT_NULL(rbt_create_machine(&config));
+	TEST_ASSERT_EQUAL_UINT32(0, counts.allocs);
+}
+
+void test_machine_out_of_memory(void) {
+	counts.fail = true;
+
+	TEST_ASSERT_NULL(rbt_create_machine(&_config));
+	TEST_ASSERT_EQUAL_UINT32(1, counts.allocs);
+	TEST_ASSERT_EQUAL_UINT32(0, counts.frees);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Layout
+	RUN_TEST(test_machine_single_block);
+	RUN_TEST(test_machine_huge_pages_alignment);
+	RUN_TEST(test_machine_default_allocator);
+
+	// Wiring and errors
+	RUN_TEST(test_machine_runs_code);
+	RUN_TEST(test_machine_irq_wired_to_cpu);
+	RUN_TEST(test_machine_invalid_bus_config);
+	RUN_TEST(test_machine_out_of_memory);
+
+	return UNITY_END();
+}
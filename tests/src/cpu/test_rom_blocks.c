@@ -0,0 +1,151 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "cpu/bus_internal.h"
+#include "cpu/cpu_internal.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/cpu.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+#include "unity_internals.h"
+
+#include <unity.h>
+
+// Listed by rbt-rom-blocks at build time from RBT_ROM_FIXTURE_FILE, which
+// tests/scripts/rom_fixture.py writes
+extern const u32 rom_fixture_blocks[];
+extern const usize rom_fixture_blocks_count;
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+static RBT_MemoryBus *bus;
+static RBT_Cpu *cpu;
+
+// Finds the block starting at `pc` among the ones the CPU holds
+static const RBT_CpuBlock *_find_block(u32 pc) {
+	for (u32 i = 0; i < _CPU_BLOCK_SLOTS; i += 1) {
+		if (cpu->blocks[i].start_pc == pc)
+			return &cpu->blocks[i];
+	}
+	return nullptr;
+}
+
+void setUp(void) {
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	bus = rbt_create_bus(&cfg);
+	TEST_ASSERT_NOT_NULL(bus);
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_bus_init_from_file(bus, RBT_ROM_FIXTURE_FILE));
+
+	cpu = rbt_create_cpu(nullptr);
+	TEST_ASSERT_NOT_NULL(cpu);
+	rbt_cpu_attach_bus(cpu, bus);
+	cpu->cfg.translate_blocks = true;
+
+	cpu->state.sr = RBT_SR_SUPERVISOR;
+	cpu->state.ssp = 0x8000;
+	cpu->state.gpr.sp = cpu->state.ssp;
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS, rbt_bus_read_long(bus, _BUS_ROM_ADDR + 4, &cpu->state.pc)
+	);
+}
+
+void tearDown(void) {
+	rbt_destroy_cpu(cpu);
+	rbt_destroy_bus(bus);
+	rbt_err_flush();
+}
+
+// ----------------------------------------------------------------------------
+// Generated table
+// ----------------------------------------------------------------------------
+
+// Both ways of every branch, the targets of JSR and BRA and the extra entry points
+// are listed. The data after JMP (A0) isn't, nor is the MOVE.l at $f00ffe that
+// crosses into the next code page, even though it's an entry point; the CPU steps
+// it and goes on at $f01004.
+void test_table_lists_reachable_blocks(void) {
+	const u32 expected[] = {
+		0xf0'0100, 0xf0'0104, 0xf0'010a, 0xf0'010e, 0xf0'0114,
+		0xf0'0200, 0xf0'0300, 0xf0'0ffc, 0xf0'1004,
+	};
+
+	usize count = sizeof(expected) / sizeof(expected[0]);
+	TEST_ASSERT_EQUAL_size_t(count, rom_fixture_blocks_count);
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(expected, rom_fixture_blocks, count);
+}
+
+// ----------------------------------------------------------------------------
+// Preloading
+// ----------------------------------------------------------------------------
+
+// The blocks of the table are in place before anything runs, and end where the
+// CPU would have ended them
+void test_preload_rom_blocks(void) {
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_cpu_preload_blocks(cpu, rom_fixture_blocks, rom_fixture_blocks_count)
+	);
+
+	const RBT_CpuBlock *loop = _find_block(0xf0'0104);
+	TEST_ASSERT_NOT_NULL(loop);
+	TEST_ASSERT_EQUAL_UINT32(3, loop->count);
+	TEST_ASSERT_EQUAL_HEX32(0xf0'010a, loop->end_pc);
+
+	const RBT_CpuBlock *before_page = _find_block(0xf0'0ffc);
+	TEST_ASSERT_NOT_NULL(before_page);
+	TEST_ASSERT_EQUAL_UINT32(1, before_page->count);
+	TEST_ASSERT_EQUAL_HEX32(0xf0'0ffe, before_page->end_pc);
+
+	TEST_ASSERT_NULL(_find_block(0xf0'0ffe));
+}
+
+// MOVEQ #0, D0; MOVEQ #5, D1; loop: ADDQ.l #1, D0; CMP.l D1, D0; BNE loop; STOP
+void test_preloaded_rom_blocks_run(void) {
+	TEST_ASSERT_EQUAL(
+		RBT_ERR_SUCCESS,
+		rbt_cpu_preload_blocks(cpu, rom_fixture_blocks, rom_fixture_blocks_count)
+	);
+	const RBT_CpuBlock *loop = _find_block(0xf0'0104);
+	TEST_ASSERT_NOT_NULL(loop);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_cpu_run(cpu, 1000, nullptr));
+	TEST_ASSERT_TRUE(cpu->is_stopped);
+	TEST_ASSERT_EQUAL_UINT32(5, cpu->state.gpr.data[0]);
+	TEST_ASSERT_EQUAL_HEX32(0xf0'010e, cpu->state.pc);
+
+	// The loop ran from the preloaded block rather than a recorded one
+	TEST_ASSERT_TRUE(_find_block(0xf0'0104) == loop);
+	TEST_ASSERT_TRUE(loop->exits[1] == loop);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Generated table
+	RUN_TEST(test_table_lists_reachable_blocks);
+
+	// Preloading
+	RUN_TEST(test_preload_rom_blocks);
+	RUN_TEST(test_preloaded_rom_blocks_run);
+
+	return UNITY_END();
+}
@@ -0,0 +1,203 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+#include "rbt/basic_types.h"
+#include "rbt/cpu/scheduler.h"
+#include "rbt/error_codes.h"
+#include "unity_internals.h"
+
+#include <stdint.h>
+#include <unity.h>
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+enum {
+	_FIRED_MAX = 16,
+};
+
+typedef struct RBT_FiredEvents {
+	usize count;
+	u32 tags[_FIRED_MAX];
+	u64 cycles[_FIRED_MAX];
+	u64 now[_FIRED_MAX];
+} RBT_FiredEvents;
+
+typedef struct RBT_TestEvent {
+	u32 tag;
+	u64 period; // Reschedules itself when non-zero
+	RBT_ErrorCode result;
+} RBT_TestEvent;
+
+static RBT_Scheduler *sched;
+static RBT_FiredEvents fired;
+
+static RBT_ErrorCode _record(void *userdata, u64 cycle) {
+	RBT_TestEvent *event = userdata;
+
+	TEST_ASSERT_TRUE(fired.count < _FIRED_MAX);
+	fired.tags[fired.count] = event->tag;
+	fired.cycles[fired.count] = cycle;
+	fired.now[fired.count] = rbt_sched_now(sched);
+	fired.count += 1;
+
+	if (event->period)
+		rbt_sched_at(sched, cycle + event->period, _record, event);
+	return event->result;
+}
+
+void setUp(void) {
+	sched = rbt_create_scheduler();
+	TEST_ASSERT_NOT_NULL(sched);
+	fired = (RBT_FiredEvents) {};
+}
+
+void tearDown(void) {
+	rbt_destroy_scheduler(sched);
+	rbt_err_flush();
+}
+
+// ----------------------------------------------------------------------------
+// Ordering
+// ----------------------------------------------------------------------------
+
+void test_sched_empty(void) {
+	TEST_ASSERT_EQUAL_UINT64(0, rbt_sched_now(sched));
+	TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, rbt_sched_until_next(sched));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 100));
+	TEST_ASSERT_EQUAL_UINT64(100, rbt_sched_now(sched));
+}
+
+void test_sched_fires_in_cycle_order(void) {
+	RBT_TestEvent a = { .tag = 1 }, b = { .tag = 2 }, c = { .tag = 3 };
+	rbt_sched_at(sched, 300, _record, &c);
+	rbt_sched_at(sched, 100, _record, &a);
+	rbt_sched_at(sched, 200, _record, &b);
+
+	TEST_ASSERT_EQUAL_UINT64(100, rbt_sched_until_next(sched));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 250));
+
+	TEST_ASSERT_EQUAL(2, fired.count);
+	TEST_ASSERT_EQUAL_UINT32(1, fired.tags[0]);
+	TEST_ASSERT_EQUAL_UINT32(2, fired.tags[1]);
+	TEST_ASSERT_EQUAL_UINT64(100, fired.cycles[0]);
+	TEST_ASSERT_EQUAL_UINT64(250, fired.now[0]);
+	TEST_ASSERT_EQUAL_UINT64(50, rbt_sched_until_next(sched));
+}
+
+void test_sched_same_cycle_is_fifo(void) {
+	RBT_TestEvent events[8];
+	for (u32 i = 0; i < 8; i += 1) {
+		events[i] = (RBT_TestEvent) { .tag = i };
+		rbt_sched_at(sched, 42, _record, &events[i]);
+	}
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 42));
+	TEST_ASSERT_EQUAL(8, fired.count);
+	for (u32 i = 0; i < 8; i += 1) {
+		TEST_ASSERT_EQUAL_UINT32(i, fired.tags[i]);
+	}
+}
+
+void test_sched_in_is_relative(void) {
+	RBT_TestEvent a = { .tag = 1 };
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 1000));
+	rbt_sched_in(sched, 10, _record, &a);
+
+	TEST_ASSERT_EQUAL_UINT64(10, rbt_sched_until_next(sched));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 10));
+	TEST_ASSERT_EQUAL_UINT64(1010, fired.cycles[0]);
+}
+
+// A periodic event reschedules from its own cycle, so lateness doesn't drift
+void test_sched_periodic_event(void) {
+	RBT_TestEvent vblank = { .tag = 1, .period = 100 };
+	rbt_sched_at(sched, 100, _record, &vblank);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 130));
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 190));
+
+	TEST_ASSERT_EQUAL(3, fired.count);
+	TEST_ASSERT_EQUAL_UINT64(100, fired.cycles[0]);
+	TEST_ASSERT_EQUAL_UINT64(200, fired.cycles[1]);
+	TEST_ASSERT_EQUAL_UINT64(300, fired.cycles[2]);
+	TEST_ASSERT_EQUAL_UINT64(80, rbt_sched_until_next(sched));
+}
+
+// ----------------------------------------------------------------------------
+// Cancellation and errors
+// ----------------------------------------------------------------------------
+
+void test_sched_cancel(void) {
+	RBT_TestEvent a = { .tag = 1 }, b = { .tag = 2 }, c = { .tag = 3 };
+	rbt_sched_at(sched, 10, _record, &a);
+	RBT_EventId id = rbt_sched_at(sched, 20, _record, &b);
+	rbt_sched_at(sched, 30, _record, &c);
+	TEST_ASSERT_TRUE(id != RBT_EVENT_NONE);
+
+	TEST_ASSERT_TRUE(rbt_sched_cancel(sched, id));
+	TEST_ASSERT_FALSE(rbt_sched_cancel(sched, id));
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 100));
+	TEST_ASSERT_EQUAL(2, fired.count);
+	TEST_ASSERT_EQUAL_UINT32(1, fired.tags[0]);
+	TEST_ASSERT_EQUAL_UINT32(3, fired.tags[1]);
+}
+
+// A failing callback stops the advance, later events stay scheduled
+void test_sched_stops_on_callback_error(void) {
+	RBT_TestEvent a = { .tag = 1, .result = RBT_ERR_GENERIC }, b = { .tag = 2 };
+	rbt_sched_at(sched, 10, _record, &a);
+	rbt_sched_at(sched, 20, _record, &b);
+
+	TEST_ASSERT_EQUAL(RBT_ERR_GENERIC, rbt_sched_advance(sched, 50));
+	TEST_ASSERT_EQUAL(1, fired.count);
+	TEST_ASSERT_EQUAL_UINT64(0, rbt_sched_until_next(sched));
+
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, rbt_sched_advance(sched, 0));
+	TEST_ASSERT_EQUAL(2, fired.count);
+}
+
+void test_sched_full(void) {
+	RBT_TestEvent a = { .tag = 1 };
+	RBT_EventId id = RBT_EVENT_NONE;
+	for (u32 i = 0; i < 1024; i += 1) {
+		id = rbt_sched_at(sched, i, _record, &a);
+		if (id == RBT_EVENT_NONE)
+			break;
+	}
+
+	TEST_ASSERT_EQUAL(RBT_EVENT_NONE, id);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Ordering
+	RUN_TEST(test_sched_empty);
+	RUN_TEST(test_sched_fires_in_cycle_order);
+	RUN_TEST(test_sched_same_cycle_is_fifo);
+	RUN_TEST(test_sched_in_is_relative);
+	RUN_TEST(test_sched_periodic_event);
+
+	// Cancellation and errors
+	RUN_TEST(test_sched_cancel);
+	RUN_TEST(test_sched_stops_on_callback_error);
+	RUN_TEST(test_sched_full);
+
+	return UNITY_END();
+}
@@ -0,0 +1,262 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "cpu/decode.h"
+#include "cpu/timing.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+
+#include <stdio.h>
+#include <unity.h>
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+enum {
+	_CODE_ADDR = 0x1000,
+};
+
+static RBT_MemoryBus *bus;
+
+static RBT_Instruction _decode(const u16 *words, usize count) {
+	for (usize i = 0; i < count; i += 1) {
+		TEST_ASSERT_EQUAL(
+			RBT_ERR_SUCCESS, rbt_bus_write_word(bus, _CODE_ADDR + (i * 2), words[i])
+		);
+	}
+
+	RBT_Instruction instr;
+	TEST_ASSERT_EQUAL(RBT_ERR_SUCCESS, _decode_instruction(bus, _CODE_ADDR, &instr));
+	return instr;
+}
+
+// Cycles of the instruction in `words` without any run time context
+static u16 _cycles(const u16 *words, usize count, RBT_CpuModel model) {
+	RBT_Instruction instr = _decode(words, count);
+	return _calculate_timing(&instr, &(RBT_TimingCtx) {}, model);
+}
+
+void setUp(void) {
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	bus = rbt_create_bus(&cfg);
+	TEST_ASSERT_NOT_NULL(bus);
+}
+
+void tearDown(void) {
+	rbt_destroy_bus(bus);
+	rbt_err_flush();
+}
+
+// ----------------------------------------------------------------------------
+// Lookup
+// ----------------------------------------------------------------------------
+
+// ADD.w D1, D0; ADD.l D1, D0
+void test_timing_register_add(void) {
+	TEST_ASSERT_EQUAL(4, _cycles((u16[]) { 0xd041 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(4, _cycles((u16[]) { 0xd041 }, 1, RBT_CPU_M68000));
+
+	TEST_ASSERT_EQUAL(6, _cycles((u16[]) { 0xd081 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(8, _cycles((u16[]) { 0xd081 }, 1, RBT_CPU_M68000));
+}
+
+// ADD.w (A1), D0 reads memory; ADD.w D0, (A1) also writes it back
+void test_timing_add_direction(void) {
+	TEST_ASSERT_EQUAL(8, _cycles((u16[]) { 0xd051 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(12, _cycles((u16[]) { 0xd151 }, 1, RBT_CPU_M68010));
+}
+
+// MOVE.l (A1), D0; MOVE.w D0, (A1); MOVE.l D0, -(A1); MOVEA.w D0, A1
+void test_timing_move_grid(void) {
+	TEST_ASSERT_EQUAL(12, _cycles((u16[]) { 0x2011 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(8, _cycles((u16[]) { 0x3280 }, 1, RBT_CPU_M68010));
+
+	TEST_ASSERT_EQUAL(14, _cycles((u16[]) { 0x2300 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(12, _cycles((u16[]) { 0x2300 }, 1, RBT_CPU_M68000));
+
+	TEST_ASSERT_EQUAL(4, _cycles((u16[]) { 0x3240 }, 1, RBT_CPU_M68010));
+}
+
+// MOVE SR, D0; MOVE D0, SR; MOVE USP, A0
+void test_timing_move_special_registers(void) {
+	TEST_ASSERT_EQUAL(4, _cycles((u16[]) { 0x40c0 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(6, _cycles((u16[]) { 0x40c0 }, 1, RBT_CPU_M68000));
+
+	TEST_ASSERT_EQUAL(12, _cycles((u16[]) { 0x46c0 }, 1, RBT_CPU_M68010));
+
+	TEST_ASSERT_EQUAL(6, _cycles((u16[]) { 0x4e68 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(4, _cycles((u16[]) { 0x4e68 }, 1, RBT_CPU_M68000));
+}
+
+// CLR.w (A1) only writes on the MC68010
+void test_timing_clr_models(void) {
+	TEST_ASSERT_EQUAL(8, _cycles((u16[]) { 0x4251 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(12, _cycles((u16[]) { 0x4251 }, 1, RBT_CPU_M68000));
+}
+
+// ADDI.w #4, (A1); ANDI #4, CCR; CMPI.w #4, (d16, PC)
+void test_timing_immediate(void) {
+	TEST_ASSERT_EQUAL(16, _cycles((u16[]) { 0x0651, 0x0004 }, 2, RBT_CPU_M68010));
+
+	TEST_ASSERT_EQUAL(16, _cycles((u16[]) { 0x023c, 0x0004 }, 2, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(20, _cycles((u16[]) { 0x023c, 0x0004 }, 2, RBT_CPU_M68000));
+
+	TEST_ASSERT_EQUAL(
+		16, _cycles((u16[]) { 0x0c7a, 0x0004, 0x0004 }, 3, RBT_CPU_M68010)
+	);
+}
+
+// BTST D0, (A1); BTST #4, (A1); BTST D0, D1
+void test_timing_bit_forms(void) {
+	TEST_ASSERT_EQUAL(8, _cycles((u16[]) { 0x0111 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(12, _cycles((u16[]) { 0x0811, 0x0004 }, 2, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(6, _cycles((u16[]) { 0x0101 }, 1, RBT_CPU_M68010));
+}
+
+// DIVU.w D1, D0 uses the worst case
+void test_timing_divide_worst_case(void) {
+	TEST_ASSERT_EQUAL(108, _cycles((u16[]) { 0x80c1 }, 1, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(140, _cycles((u16[]) { 0x80c1 }, 1, RBT_CPU_M68000));
+}
+
+// ----------------------------------------------------------------------------
+// Run time context
+// ----------------------------------------------------------------------------
+
+// ASL.w D2, D1 by 5; ASL.w (A1)
+void test_timing_shift_count(void) {
+	RBT_Instruction instr = _decode((u16[]) { 0xe561 }, 1);
+	RBT_TimingCtx ctx = { .shift_n = 5 };
+	TEST_ASSERT_EQUAL(16, _calculate_timing(&instr, &ctx, RBT_CPU_M68010));
+
+	TEST_ASSERT_EQUAL(12, _cycles((u16[]) { 0xe1d1 }, 1, RBT_CPU_M68010));
+}
+
+// MOVEM.l (A1), D0-D2; MOVEM.w D0-D1, (A1)
+void test_timing_movem_count(void) {
+	RBT_Instruction instr = _decode((u16[]) { 0x4cd1, 0x0007 }, 2);
+	RBT_TimingCtx ctx = { .movem_n = 3 };
+	TEST_ASSERT_EQUAL(36, _calculate_timing(&instr, &ctx, RBT_CPU_M68010));
+
+	instr = _decode((u16[]) { 0x4891, 0x0003 }, 2);
+	ctx = (RBT_TimingCtx) { .movem_n = 2 };
+	TEST_ASSERT_EQUAL(16, _calculate_timing(&instr, &ctx, RBT_CPU_M68010));
+}
+
+// BNE.s *+4; BNE.w *+2
+void test_timing_bcc_outcomes(void) {
+	RBT_Instruction instr = _decode((u16[]) { 0x6602 }, 1);
+	RBT_TimingCtx taken = { .branch_taken = true };
+	RBT_TimingCtx not_taken = {};
+
+	TEST_ASSERT_EQUAL(10, _calculate_timing(&instr, &taken, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(6, _calculate_timing(&instr, &not_taken, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(8, _calculate_timing(&instr, &not_taken, RBT_CPU_M68000));
+
+	instr = _decode((u16[]) { 0x6600, 0x0000 }, 2);
+	TEST_ASSERT_EQUAL(10, _calculate_timing(&instr, &not_taken, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(12, _calculate_timing(&instr, &not_taken, RBT_CPU_M68000));
+}
+
+// DBRA D0, *
+void test_timing_dbcc_outcomes(void) {
+	RBT_Instruction instr = _decode((u16[]) { 0x51c8, 0xfffe }, 2);
+	RBT_TimingCtx taken = { .branch_taken = true };
+	RBT_TimingCtx expired = { .counter_expired = true };
+
+	TEST_ASSERT_EQUAL(10, _calculate_timing(&instr, &taken, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(16, _calculate_timing(&instr, &expired, RBT_CPU_M68010));
+	TEST_ASSERT_EQUAL(14, _calculate_timing(&instr, &expired, RBT_CPU_M68000));
+}
+
+// ----------------------------------------------------------------------------
+// Coverage
+// ----------------------------------------------------------------------------
+
+// The decoder also accepts a few encodings no MC68000 or MC68010 has
+static bool _is_undocumented(const RBT_Instruction *instr) {
+	switch (instr->mnemonic) {
+	case RBT_OP_BCHG:
+	case RBT_OP_BCLR:
+	case RBT_OP_BSET:
+		return instr->dst.mode == RBT_EA_IMMEDIATE;
+	case RBT_OP_PEA:
+		return instr->src.mode == RBT_EA_IMMEDIATE;
+	case RBT_OP_TST:
+		return (instr->dst.mode & RBT_EA_GROUP_PCR) != 0;
+	default:
+		return false;
+	}
+}
+
+// Every legal encoding must land on a cell the tables fill
+void test_timing_every_opcode_has_cycles(void) {
+	static const RBT_CpuModel models[] = { RBT_CPU_M68000, RBT_CPU_M68010 };
+
+	// Illegal encodings would otherwise fill the error stack
+	rbt_set_err_min_severity(RBT_SEVERITY_FATAL);
+
+	u32 missing = 0;
+	for (u32 opcode = 0; opcode < 0x1'0000; opcode += 1) {
+		u16 words[] = { opcode, 0x0004, 0x0004, 0x0004, 0x0004 };
+		for (usize i = 0; i < sizeof(words) / sizeof(words[0]); i += 1) {
+			(void)rbt_bus_write_word(bus, _CODE_ADDR + (i * 2), words[i]);
+		}
+
+		RBT_Instruction instr;
+		if (_decode_instruction(bus, _CODE_ADDR, &instr) || _is_undocumented(&instr))
+			continue;
+
+		for (usize m = 0; m < sizeof(models) / sizeof(models[0]); m += 1) {
+			if (_calculate_timing(&instr, &(RBT_TimingCtx) {}, models[m]) == 0) {
+				if (missing < 8)
+					printf("  no cycles for opcode 0x%04x\n", opcode);
+				missing += 1;
+			}
+		}
+	}
+
+	rbt_set_err_min_severity(RBT_SEVERITY_INFO);
+	TEST_ASSERT_EQUAL(0, missing);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_timing_register_add);
+	RUN_TEST(test_timing_add_direction);
+	RUN_TEST(test_timing_move_grid);
+	RUN_TEST(test_timing_move_special_registers);
+	RUN_TEST(test_timing_clr_models);
+	RUN_TEST(test_timing_immediate);
+	RUN_TEST(test_timing_bit_forms);
+	RUN_TEST(test_timing_divide_worst_case);
+
+	RUN_TEST(test_timing_shift_count);
+	RUN_TEST(test_timing_movem_count);
+	RUN_TEST(test_timing_bcc_outcomes);
+	RUN_TEST(test_timing_dbcc_outcomes);
+
+	RUN_TEST(test_timing_every_opcode_has_cycles);
+
+	return UNITY_END();
+}
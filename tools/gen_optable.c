@@ -0,0 +1,351 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+// Builds the 64K-entry opcode table used by _decode_instruction().
+//
+// Every opcode word is decoded by the reference decoder against a set of
+// extension word patterns. Opcodes rejected for every pattern are marked as
+// illegal. Otherwise an operand description is derived from the decoded
+// instruction and kept only if the generic decoder reproduces the reference
+// output for every pattern; anything else falls back to its family decoder.
+//
+// Usage: rbt-gen-optable <output.inc>
+
+#include "cpu/decode.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+enum {
+	_CODE_ADDR = 0x1000,
+	_EXT_WORDS = RBT_MAX_INSTR_WORDS - 1,
+	_PATTERN_COUNT = 12,
+	_OPCODE_COUNT = 0x1'0000,
+
+	// Opcodes the generic decoder is known to handle. Fewer means operands stopped
+	// comparing equal, more means the table changed; either way check the diff.
+	_GENERIC_EXPECTED = 54'267,
+};
+
+static RBT_MemoryBus *_bus;
+static u16 _patterns[_PATTERN_COUNT][_EXT_WORDS];
+
+static void _init_patterns(void) {
+	static const u16 fills[] = { 0x0000, 0xffff, 0x8000, 0x7fff, 0x00ff, 0xff00 };
+	const usize fill_count = sizeof(fills) / sizeof(fills[0]);
+
+	for (usize p = 0; p < fill_count; p += 1) {
+		for (usize i = 0; i < _EXT_WORDS; i += 1) {
+			_patterns[p][i] = fills[p];
+		}
+	}
+
+	// Fixed seed, the output must be reproducible
+	u32 state = 0x1234'5678;
+	for (usize p = fill_count; p < _PATTERN_COUNT; p += 1) {
+		for (usize i = 0; i < _EXT_WORDS; i += 1) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			_patterns[p][i] = state & 0xffff;
+		}
+	}
+}
+
+static void _load(u16 opcode, usize pattern) {
+	(void)rbt_bus_write_word(_bus, _CODE_ADDR, opcode);
+	for (usize i = 0; i < _EXT_WORDS; i += 1) {
+		(void)rbt_bus_write_word(_bus, _CODE_ADDR + 2 + (i * 2), _patterns[pattern][i]);
+	}
+}
+
+[[nodiscard]] static bool _is_decode_error(RBT_ErrorCode code) {
+	return code == RBT_ERR_DECODE_ILLEGAL || code == RBT_ERR_DECODE_INVALID_EA
+		|| code == RBT_ERR_DECODE_ILLEGAL_EA;
+}
+
+[[nodiscard]] static u8 _mode_bit(RBT_AddressMode mode) {
+	u8 bit = 0;
+	while (!((mode >> bit) & 1)) {
+		bit += 1;
+	}
+	return bit;
+}
+
+// Fills `out` with every operand description that may reproduce `ea`
+[[nodiscard]] static usize _operand_candidates(
+	const RBT_EffectiveAddress *ea, RBT_OperandSpec out[2]
+) {
+	memset(out, 0, sizeof(RBT_OperandSpec) * 2);
+	if (ea->mode == RBT_EA_NONE)
+		return 1;
+
+	u8 bit = _mode_bit(ea->mode);
+	usize count = 0;
+
+	switch (ea->mode) {
+	case RBT_EA_DIRECT_DATA:
+	case RBT_EA_DIRECT_ADDR:
+	case RBT_EA_INDIRECT:
+	case RBT_EA_INDIRECT_POSTINC:
+	case RBT_EA_INDIRECT_PREDEC:
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_EA, .field = (bit << 3) | ea->reg, .size = ea->size
+		};
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_CONST, .field = bit, .size = ea->size, .value = ea->reg
+		};
+		break;
+	case RBT_EA_INDIRECT_DISPLACEMENT:
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_EA, .field = (bit << 3) | ea->ind_disp.areg, .size = ea->size
+		};
+		break;
+	case RBT_EA_INDIRECT_INDEXED:
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_EA, .field = (bit << 3) | ea->ind_idx.areg, .size = ea->size
+		};
+		break;
+	case RBT_EA_ABSOLUTE_SHORT:
+	case RBT_EA_ABSOLUTE_LONG:
+	case RBT_EA_PC_DISPLACEMENT:
+	case RBT_EA_PC_INDEXED:
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_EA, .field = (0b111 << 3) | (bit - 7), .size = ea->size
+		};
+		break;
+	case RBT_EA_IMMEDIATE:
+		if (ea->size == RBT_SIZE_NONE) {
+			if (ea->imm > UINT16_MAX)
+				break;
+			out[count++] = (RBT_OperandSpec) {
+				.kind = _OPERAND_CONST, .field = bit, .value = (i16)ea->imm
+			};
+			break;
+		}
+
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_EXT, .field = bit, .size = ea->size
+		};
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_EA, .field = (0b111 << 3) | 0b100, .size = ea->size
+		};
+		break;
+	case RBT_EA_DISPLACEMENT:
+		if (ea->size == RBT_SIZE_NONE) {
+			if (ea->disp < INT16_MIN || ea->disp > INT16_MAX)
+				break;
+			out[count++] = (RBT_OperandSpec) {
+				.kind = _OPERAND_CONST, .field = bit, .value = (i16)ea->disp
+			};
+			break;
+		}
+
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_EXT, .field = bit, .size = ea->size
+		};
+		break;
+	default:
+		// Special registers carry no value
+		out[count++] = (RBT_OperandSpec) {
+			.kind = _OPERAND_CONST, .field = bit, .size = ea->size
+		};
+		break;
+	}
+
+	return count;
+}
+
+typedef struct RBT_Reference {
+	RBT_ErrorCode status[_PATTERN_COUNT];
+	RBT_Instruction instr[_PATTERN_COUNT];
+} RBT_Reference;
+
+[[nodiscard]] static bool _matches(
+	u16 opcode, const RBT_OpcodeInfo *info, const RBT_Reference *ref
+) {
+	for (usize p = 0; p < _PATTERN_COUNT; p += 1) {
+		_load(opcode, p);
+
+		RBT_Instruction instr;
+		RBT_ErrorCode status = _decode_instruction_with(_bus, _CODE_ADDR, info, &instr);
+		if (status != ref->status[p])
+			return false;
+
+		if (status == RBT_ERR_SUCCESS
+			&& !_decode_instruction_equal(&instr, &ref->instr[p])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static RBT_OpcodeInfo _build_entry(u16 opcode) {
+	static RBT_Reference ref;
+
+	usize decoded = _PATTERN_COUNT;
+	usize rejected = 0;
+
+	for (usize p = 0; p < _PATTERN_COUNT; p += 1) {
+		_load(opcode, p);
+		ref.status[p] = _decode_instruction_reference(_bus, _CODE_ADDR, &ref.instr[p]);
+
+		if (ref.status[p] == RBT_ERR_SUCCESS && decoded == _PATTERN_COUNT)
+			decoded = p;
+		if (_is_decode_error(ref.status[p]) && ref.status[p] == ref.status[0])
+			rejected += 1;
+	}
+
+	if (rejected == _PATTERN_COUNT) {
+		return (RBT_OpcodeInfo) {
+			.decoder = _OPDECODER_ILLEGAL,
+			.status = ref.status[0],
+		};
+	}
+
+	RBT_OpcodeInfo fallback = { .decoder = _decode_select(opcode) };
+	if (decoded == _PATTERN_COUNT)
+		return fallback;
+
+	const RBT_Instruction *sample = &ref.instr[decoded];
+
+	RBT_OperandSpec aux[2], src[2], dst[2];
+	usize aux_count = _operand_candidates(&sample->aux, aux);
+	usize src_count = _operand_candidates(&sample->src, src);
+	usize dst_count = _operand_candidates(&sample->dst, dst);
+
+	RBT_OpcodeInfo info = {
+		.decoder = _OPDECODER_GENERIC,
+		.mnemonic = sample->mnemonic,
+		.size = sample->size,
+	};
+
+	for (usize a = 0; a < aux_count; a += 1) {
+		for (usize s = 0; s < src_count; s += 1) {
+			for (usize d = 0; d < dst_count; d += 1) {
+				info.aux = aux[a];
+				info.src = src[s];
+				info.dst = dst[d];
+
+				info.flags = 0;
+				if (_matches(opcode, &info, &ref))
+					return info;
+
+				info.flags = _OPINFO_DST_FIRST;
+				if (_matches(opcode, &info, &ref))
+					return info;
+			}
+		}
+	}
+
+	return fallback;
+}
+
+static void _write_operand(FILE *out, const RBT_OperandSpec *spec) {
+	fprintf(out, "{%u,%u,%u,%d}", spec->kind, spec->field, spec->size, spec->value);
+}
+
+int main(int argc, char **argv) {
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <output.inc>\n", argv[0]);
+		return 1;
+	}
+
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	_bus = rbt_create_bus(&cfg);
+	if (!_bus) {
+		rbt_err_flush();
+		return 1;
+	}
+
+	// Rejected encodings are expected here, don't report them
+	rbt_set_err_min_severity(RBT_SEVERITY_FATAL);
+	_init_patterns();
+
+	FILE *out = fopen(argv[1], "w");
+	if (!out) {
+		fprintf(stderr, "failed to open %s\n", argv[1]);
+		rbt_destroy_bus(_bus);
+		return 1;
+	}
+
+	fprintf(out, "// Generated by tools/gen_optable.c - DO NOT EDIT.\n");
+	fprintf(out, "// { decoder, mnemonic, size, flags, status, aux, src, dst }\n");
+	fprintf(out, "// clang-format off\n");
+	fprintf(out, "static const RBT_OpcodeInfo _op_table[0x1'0000] = {\n");
+
+	usize counts[3] = {};
+	for (u32 opcode = 0; opcode < _OPCODE_COUNT; opcode += 1) {
+		RBT_OpcodeInfo info = _build_entry(opcode);
+
+		if (info.decoder == _OPDECODER_ILLEGAL)
+			counts[0] += 1;
+		else if (info.decoder == _OPDECODER_GENERIC)
+			counts[1] += 1;
+		else
+			counts[2] += 1;
+
+		if ((opcode & 0xff) == 0)
+			fprintf(out, "\t// 0x%04x\n", opcode);
+
+		fprintf(
+			out, "\t{%u,%u,%u,%u,%u,", info.decoder, info.mnemonic, info.size, info.flags,
+			info.status
+		);
+		_write_operand(out, &info.aux);
+		fputc(',', out);
+		_write_operand(out, &info.src);
+		fputc(',', out);
+		_write_operand(out, &info.dst);
+		fprintf(out, "},\n");
+	}
+
+	fprintf(out, "};\n");
+	fprintf(out, "// clang-format on\n");
+
+	bool failed = ferror(out) != 0;
+	failed |= fclose(out) != 0;
+	rbt_destroy_bus(_bus);
+
+	if (failed) {
+		fprintf(stderr, "failed to write %s\n", argv[1]);
+		return 1;
+	}
+
+	if (counts[1] != _GENERIC_EXPECTED) {
+		fprintf(
+			stderr, "%zu opcodes use the generic decoder, expected %d\n", counts[1],
+			_GENERIC_EXPECTED
+		);
+		remove(argv[1]);
+		return 1;
+	}
+
+	printf(
+		"opcode table: %zu illegal, %zu generic, %zu family decoders\n", counts[0],
+		counts[1], counts[2]
+	);
+	return 0;
+}
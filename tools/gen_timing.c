@@ -0,0 +1,846 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+// Builds the instruction timing tables used by _calculate_timing().
+//
+// The cycle counts come from the tables in docs/m68010_cycles.txt. Both CPU
+// models start from the MC68010 tables, then the "mc68000 differences"
+// section replaces cells of the MC68000 model only. Grids are recognized by
+// their header row; rows of the miscellaneous and exception grids are
+// matched by their text. Rows of the exception grid that aren't matched
+// belong to exception processing and are skipped.
+//
+// Usage: rbt-gen-timing <m68010_cycles.txt> <output.inc>
+
+#include "cpu/timing.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/types.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	_LINE_MAX = 256,
+	_CELL_MAX = 16,
+	_EA_COUNT = 12, // Columns with an entry in table 9-1
+};
+
+// Row index of each model in the generated tables
+enum {
+	_MODEL_M68000 = 1 << 0,
+	_MODEL_M68010 = 1 << 1,
+	_MODEL_ALL = _MODEL_M68000 | _MODEL_M68010,
+};
+
+// Size masks, bit N is row N of a mnemonic
+enum {
+	_SIZE_B = 1 << 0,
+	_SIZE_W = 1 << 1,
+	_SIZE_L = 1 << 2,
+	_SIZE_BW = _SIZE_B | _SIZE_W,
+	_SIZE_ALL = _SIZE_B | _SIZE_W | _SIZE_L,
+};
+
+enum {
+	_FORM_SRC = 1 << _TIMING_FORM_SRC,
+	_FORM_DST = 1 << _TIMING_FORM_DST,
+	_FORM_BOTH = _FORM_SRC | _FORM_DST,
+};
+
+#define _COL(col) (1u << (col))
+
+enum {
+	_COLS_EA = (1u << _EA_COUNT) - 1,
+	_COLS_DATA = _COLS_EA & ~_COL(_TIMING_COL_AN),
+	_COLS_ALTERABLE = _COL(_TIMING_COL_IND) | _COL(_TIMING_COL_POSTINC)
+					| _COL(_TIMING_COL_PREDEC) | _COL(_TIMING_COL_DISP)
+					| _COL(_TIMING_COL_INDEX) | _COL(_TIMING_COL_ABS_W)
+					| _COL(_TIMING_COL_ABS_L),
+	_COLS_ALL = (1u << _TIMING_COL_COUNT) - 1,
+};
+
+typedef enum RBT_GridKind {
+	_GRID_NONE,
+	_GRID_EA,		 // addressing mode | bw fetch | bw nofetch | l fetch | l nofetch
+	_GRID_MOVE,		 // src / dst | destination columns
+	_GRID_OPS,		 // mnemonic | syntax | EA columns
+	_GRID_SHIFT,	 // instruction | bw (reg) | l (reg)
+	_GRID_BRANCH,	 // mnemonic | size | taken | not taken
+	_GRID_MULTI,	 // mnemonic | size | dn,dn | m,m
+	_GRID_MISC,		 // instruction | cycles
+	_GRID_EXCEPTION, // exception | cycles
+} RBT_GridKind;
+
+typedef enum RBT_EaCost {
+	_EA_COST_NONE,
+	_EA_COST_FETCH,
+	_EA_COST_NOFETCH,
+} RBT_EaCost;
+
+// One parsed cell, e.g. "12", "8+4n", "12 + ea", "8*" or "16(exp)"
+typedef struct RBT_Cell {
+	const char *text;
+	bool present; // "--" and empty cells are skipped
+	u32 base;
+	u32 per_n;
+	RBT_EaCost ea;
+} RBT_Cell;
+
+// Miscellaneous and exception rows, matched by their text
+typedef struct RBT_NamedRow {
+	const char *text;
+	RBT_OpMnemonic op;
+	u8 sizes;
+	u8 forms;
+	u32 cols;
+} RBT_NamedRow;
+
+typedef struct RBT_BranchRow {
+	const char *name;
+	RBT_OpMnemonic op;
+	u8 taken;	  // Outcomes written by the "taken" cell
+	u8 not_taken; // Outcomes written by the "not taken" cell
+} RBT_BranchRow;
+
+// clang-format off
+static const char *const _names[_TIMING_OP_COUNT] = {
+	[RBT_OP_ABCD] = "abcd",   [RBT_OP_ADD] = "add",     [RBT_OP_ADDA] = "adda",
+	[RBT_OP_ADDI] = "addi",   [RBT_OP_ADDQ] = "addq",   [RBT_OP_ADDX] = "addx",
+	[RBT_OP_AND] = "and",     [RBT_OP_ANDI] = "andi",   [RBT_OP_ASL] = "asl",
+	[RBT_OP_ASR] = "asr",     [RBT_OP_Bcc] = "bcc",     [RBT_OP_BCHG] = "bchg",
+	[RBT_OP_BCLR] = "bclr",   [RBT_OP_BRA] = "bra",     [RBT_OP_BSET] = "bset",
+	[RBT_OP_BSR] = "bsr",     [RBT_OP_BTST] = "btst",   [RBT_OP_CHK] = "chk",
+	[RBT_OP_CLR] = "clr",     [RBT_OP_CMP] = "cmp",     [RBT_OP_CMPA] = "cmpa",
+	[RBT_OP_CMPI] = "cmpi",   [RBT_OP_CMPM] = "cmpm",   [RBT_OP_DBcc] = "dbcc",
+	[RBT_OP_DIVS] = "divs",   [RBT_OP_DIVU] = "divu",   [RBT_OP_EOR] = "eor",
+	[RBT_OP_EORI] = "eori",   [RBT_OP_EXG] = "exg",     [RBT_OP_EXT] = "ext",
+	[RBT_OP_ILLEGAL] = "illegal", [RBT_OP_JMP] = "jmp", [RBT_OP_JSR] = "jsr",
+	[RBT_OP_LEA] = "lea",     [RBT_OP_LINK] = "link",   [RBT_OP_LSL] = "lsl",
+	[RBT_OP_LSR] = "lsr",     [RBT_OP_MOVE] = "move",   [RBT_OP_MOVEA] = "movea",
+	[RBT_OP_MOVEM] = "movem", [RBT_OP_MOVEP] = "movep", [RBT_OP_MOVEQ] = "moveq",
+	[RBT_OP_MULS] = "muls",   [RBT_OP_MULU] = "mulu",   [RBT_OP_NBCD] = "nbcd",
+	[RBT_OP_NEG] = "neg",     [RBT_OP_NEGX] = "negx",   [RBT_OP_NOP] = "nop",
+	[RBT_OP_NOT] = "not",     [RBT_OP_OR] = "or",       [RBT_OP_ORI] = "ori",
+	[RBT_OP_PEA] = "pea",     [RBT_OP_RESET] = "reset", [RBT_OP_ROL] = "rol",
+	[RBT_OP_ROR] = "ror",     [RBT_OP_ROXL] = "roxl",   [RBT_OP_ROXR] = "roxr",
+	[RBT_OP_RTE] = "rte",     [RBT_OP_RTR] = "rtr",     [RBT_OP_RTS] = "rts",
+	[RBT_OP_SBCD] = "sbcd",   [RBT_OP_Scc] = "scc",     [RBT_OP_STOP] = "stop",
+	[RBT_OP_SUB] = "sub",     [RBT_OP_SUBA] = "suba",   [RBT_OP_SUBI] = "subi",
+	[RBT_OP_SUBQ] = "subq",   [RBT_OP_SUBX] = "subx",   [RBT_OP_SWAP] = "swap",
+	[RBT_OP_TAS] = "tas",     [RBT_OP_TRAP] = "trap",   [RBT_OP_TRAPV] = "trapv",
+	[RBT_OP_TST] = "tst",     [RBT_OP_UNLK] = "unlk",   [RBT_OP_BKPT] = "bkpt",
+	[RBT_OP_MOVEC] = "movec", [RBT_OP_MOVES] = "moves", [RBT_OP_RTD] = "rtd",
+	[RBT_OP_LINEA] = "linea", [RBT_OP_LINEF] = "linef",
+};
+
+// "xsx" in the memory shift grid stands for all of these
+static const RBT_OpMnemonic _shift_ops[] = {
+	RBT_OP_ASL, RBT_OP_ASR, RBT_OP_LSL,  RBT_OP_LSR,
+	RBT_OP_ROL, RBT_OP_ROR, RBT_OP_ROXL, RBT_OP_ROXR,
+};
+
+static const struct {
+	const char *name;
+	u32 cols;
+} _columns[] = {
+	{ "dn", _COL(_TIMING_COL_DN) },
+	{ "an", _COL(_TIMING_COL_AN) },
+	{ "(an)", _COL(_TIMING_COL_IND) },
+	{ "(an)+", _COL(_TIMING_COL_POSTINC) },
+	{ "-(an)", _COL(_TIMING_COL_PREDEC) },
+	{ "(d,an)", _COL(_TIMING_COL_DISP) },
+	{ "(d16,an)", _COL(_TIMING_COL_DISP) },
+	{ "(d,an,xn)", _COL(_TIMING_COL_INDEX) },
+	{ "(d8,an,xn)", _COL(_TIMING_COL_INDEX) },
+	{ "(m).w", _COL(_TIMING_COL_ABS_W) },
+	{ "(xxx).w", _COL(_TIMING_COL_ABS_W) },
+	{ "(m).l", _COL(_TIMING_COL_ABS_L) },
+	{ "(xxx).l", _COL(_TIMING_COL_ABS_L) },
+	{ "(d,pc)", _COL(_TIMING_COL_PC_DISP) },
+	{ "(d16,pc)", _COL(_TIMING_COL_PC_DISP) },
+	{ "(d,pc,xn)", _COL(_TIMING_COL_PC_INDEX) },
+	{ "(d8,pc,xn)", _COL(_TIMING_COL_PC_INDEX) },
+	{ "#d", _COL(_TIMING_COL_IMM) },
+	{ "#<data>", _COL(_TIMING_COL_IMM) },
+	{ "ccr/sr", _COL(_TIMING_COL_CCR) | _COL(_TIMING_COL_SR) },
+	{ "base", 0 }, // Already part of every other cell
+};
+
+#define _OUT(outcome) (1u << _TIMING_BRANCH_##outcome)
+
+static const RBT_BranchRow _branch_rows[] = {
+	{ "bcc", RBT_OP_Bcc, _OUT(TAKEN), _OUT(NOT_TAKEN) },
+	{ "bra", RBT_OP_BRA, _OUT(TAKEN) | _OUT(NOT_TAKEN), 0 },
+	{ "bsr", RBT_OP_BSR, _OUT(TAKEN) | _OUT(NOT_TAKEN), 0 },
+	{ "dbcc (cc false)", RBT_OP_DBcc, _OUT(TAKEN), _OUT(EXPIRED) },
+	{ "dbcc (cc true)", RBT_OP_DBcc, 0, _OUT(NOT_TAKEN) },
+};
+
+static const RBT_NamedRow _misc_rows[] = {
+	{ "andi to ccr",         RBT_OP_ANDI,  _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_CCR) },
+	{ "andi to sr",          RBT_OP_ANDI,  _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_SR) },
+	{ "chk (no trap)",       RBT_OP_CHK,   _SIZE_ALL, _FORM_SRC,  _COLS_EA },
+	{ "eori to ccr",         RBT_OP_EORI,  _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_CCR) },
+	{ "eori to sr",          RBT_OP_EORI,  _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_SR) },
+	{ "exg",                 RBT_OP_EXG,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "ext.w / ext.l",       RBT_OP_EXT,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "link",                RBT_OP_LINK,  _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "move from ccr (dn)",  RBT_OP_MOVE,  _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_DN) },
+	{ "move from ccr (<m>)", RBT_OP_MOVE,  _SIZE_ALL, _FORM_DST,  _COLS_ALTERABLE },
+	{ "move to ccr",         RBT_OP_MOVE,  _SIZE_ALL, _FORM_SRC,  _COLS_DATA },
+	{ "move from sr (dn)",   RBT_OP_MOVE,  _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_DN) },
+	{ "move from sr (<m>)",  RBT_OP_MOVE,  _SIZE_ALL, _FORM_DST,  _COLS_ALTERABLE },
+	{ "move to sr",          RBT_OP_MOVE,  _SIZE_ALL, _FORM_SRC,  _COLS_DATA },
+	{ "move usp,an",         RBT_OP_MOVE,  _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_AN) },
+	{ "move an,usp",         RBT_OP_MOVE,  _SIZE_ALL, _FORM_SRC,  _COL(_TIMING_COL_AN) },
+	{ "movec cr,rn",         RBT_OP_MOVEC, _SIZE_ALL, _FORM_SRC,  _COLS_ALL },
+	{ "movec rn,cr",         RBT_OP_MOVEC, _SIZE_ALL, _FORM_DST,  _COLS_ALL },
+	{ "movep.w (both dir)",  RBT_OP_MOVEP, _SIZE_BW,  _FORM_BOTH, _COLS_ALL },
+	{ "movep.l (both dir)",  RBT_OP_MOVEP, _SIZE_L,   _FORM_BOTH, _COLS_ALL },
+	{ "nop",                 RBT_OP_NOP,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "ori to ccr",          RBT_OP_ORI,   _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_CCR) },
+	{ "ori to sr",           RBT_OP_ORI,   _SIZE_ALL, _FORM_DST,  _COL(_TIMING_COL_SR) },
+	{ "reset",               RBT_OP_RESET, _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "rtd",                 RBT_OP_RTD,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "rte",                 RBT_OP_RTE,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "rte (short frame)",   RBT_OP_RTE,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "rtr",                 RBT_OP_RTR,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "rts",                 RBT_OP_RTS,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "stop",                RBT_OP_STOP,  _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "swap",                RBT_OP_SWAP,  _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "trapv (not taken)",   RBT_OP_TRAPV, _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "unlk",                RBT_OP_UNLK,  _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+};
+
+// Instructions that always trap take the exception processing time
+static const RBT_NamedRow _exception_rows[] = {
+	{ "breakpoint (bkpt)",   RBT_OP_BKPT,    _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "illegal instruction", RBT_OP_ILLEGAL, _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "illegal instruction", RBT_OP_LINEA,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "illegal instruction", RBT_OP_LINEF,   _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+	{ "trap instruction",    RBT_OP_TRAP,    _SIZE_ALL, _FORM_BOTH, _COLS_ALL },
+};
+
+// Exception processing times, charged when the exception is taken
+static const char *const _exception_names[_TIMING_EXC_COUNT] = {
+	[_TIMING_EXC_ADDR_ERROR] = "address error",
+	[_TIMING_EXC_BUS_ERROR] = "bus error",
+	[_TIMING_EXC_CHK] = "chk instruction",
+	[_TIMING_EXC_ZERO_DIV] = "divide by zero",
+	[_TIMING_EXC_ILLEGAL] = "illegal instruction",
+	[_TIMING_EXC_INTERRUPT] = "interrupt",
+	[_TIMING_EXC_PRIVILEGE] = "privilege violation",
+	[_TIMING_EXC_FMT_ERROR] = "rte illegal format",
+	[_TIMING_EXC_TRACE] = "trace",
+	[_TIMING_EXC_TRAP] = "trap instruction",
+	[_TIMING_EXC_TRAPV] = "trapv instruction",
+};
+// clang-format on
+
+static RBT_TimingRow _rows[_TIMING_MODEL_COUNT][_TIMING_OP_COUNT][_TIMING_SIZE_COUNT];
+static u8 _move[_TIMING_MODEL_COUNT][_TIMING_SIZE_COUNT][_TIMING_MOVE_SRC_COUNT]
+			   [_TIMING_MOVE_DST_COUNT];
+
+static u8 _exceptions[_TIMING_MODEL_COUNT][_TIMING_EXC_COUNT];
+
+// Table 9-1, [long][nofetch][column]
+static u8 _ea_time[2][2][_EA_COUNT];
+
+// State of the parser
+static const char *_path;
+static u32 _line_no;
+static u32 _models = _MODEL_ALL;
+
+[[noreturn]] static void _fail(const char *what, const char *text) {
+	fprintf(stderr, "%s:%u: %s '%s'\n", _path, _line_no, what, text);
+	exit(1);
+}
+
+static char *_trim(char *text) {
+	while (isspace((unsigned char)*text)) {
+		text += 1;
+	}
+
+	usize len = strlen(text);
+	while (len > 0 && isspace((unsigned char)text[len - 1])) {
+		len -= 1;
+	}
+	text[len] = '\0';
+	return text;
+}
+
+// Splits "| a | b |" into trimmed cells, the line is modified in place
+static usize _split(char *line, char *cells[_CELL_MAX]) {
+	usize count = 0;
+	char *cursor = line + 1;
+
+	for (char *bar = strchr(cursor, '|'); bar; bar = strchr(cursor, '|')) {
+		if (count == _CELL_MAX)
+			_fail("too many cells in", line);
+
+		*bar = '\0';
+		cells[count++] = _trim(cursor);
+		cursor = bar + 1;
+	}
+
+	return count;
+}
+
+static RBT_Cell _parse_cell(const char *text) {
+	RBT_Cell cell = { .text = text };
+	if (*text == '\0' || strncmp(text, "--", 2) == 0)
+		return cell;
+
+	char *end;
+	cell.present = true;
+	cell.base = (u32)strtoul(text, &end, 10);
+	if (end == text)
+		_fail("bad cycle count", text);
+
+	while (isspace((unsigned char)*end)) {
+		end += 1;
+	}
+	if (*end != '+')
+		return cell; // "*" and "(...)" remarks don't change the count
+
+	end += 1;
+	while (isspace((unsigned char)*end)) {
+		end += 1;
+	}
+
+	if (isdigit((unsigned char)*end)) {
+		cell.per_n = (u32)strtoul(end, &end, 10);
+		if (*end != 'n')
+			_fail("bad per-register term", text);
+	} else if (strncmp(end, "nfea", 4) == 0) {
+		cell.ea = _EA_COST_NOFETCH;
+	} else if (strncmp(end, "ea", 2) == 0) {
+		cell.ea = _EA_COST_FETCH;
+	} else {
+		_fail("bad cycle formula", text);
+	}
+
+	return cell;
+}
+
+static u32 _parse_column(const char *name) {
+	for (usize i = 0; i < sizeof(_columns) / sizeof(_columns[0]); i += 1) {
+		if (strcmp(_columns[i].name, name) == 0)
+			return _columns[i].cols;
+	}
+	_fail("unknown column", name);
+}
+
+// Lowest column of `cols`, _TIMING_COL_COUNT when empty
+[[nodiscard]] static u32 _first_col(u32 cols) {
+	u32 col = 0;
+	while (col < _TIMING_COL_COUNT && !((cols >> col) & 1)) {
+		col += 1;
+	}
+	return col;
+}
+
+static u32 _parse_sizes(const char *suffix) {
+	if (*suffix == '\0' || strcmp(suffix, "--") == 0)
+		return _SIZE_ALL;
+	if (strcmp(suffix, "bw") == 0)
+		return _SIZE_BW;
+	if (strcmp(suffix, "b") == 0 || strcmp(suffix, "byte") == 0)
+		return _SIZE_B;
+	if (strcmp(suffix, "w") == 0 || strcmp(suffix, "word") == 0)
+		return _SIZE_W;
+	if (strcmp(suffix, "l") == 0)
+		return _SIZE_L;
+	_fail("unknown size", suffix);
+}
+
+static RBT_OpMnemonic _parse_op(const char *name) {
+	for (u32 op = 0; op < _TIMING_OP_COUNT; op += 1) {
+		if (_names[op] && strcmp(_names[op], name) == 0)
+			return op;
+	}
+	_fail("unknown mnemonic", name);
+}
+
+// Total cycles of `cell` for an operand in column `col`
+static u8 _cell_cycles(const RBT_Cell *cell, u32 size, u32 col) {
+	u32 cycles = cell->base;
+	if (cell->ea != _EA_COST_NONE && col < _EA_COUNT) {
+		bool is_long = size == 2;
+		cycles += _ea_time[is_long][cell->ea == _EA_COST_NOFETCH][col];
+	}
+
+	if (cycles > UINT8_MAX)
+		_fail("cycle count out of range", cell->text);
+	return (u8)cycles;
+}
+
+static void _set_cells(
+	RBT_OpMnemonic op, u32 sizes, u32 forms, u32 cols, const RBT_Cell *cell
+) {
+	if (!cell->present)
+		return;
+
+	for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+		if (!((_models >> model) & 1))
+			continue;
+
+		for (u32 size = 0; size < _TIMING_SIZE_COUNT; size += 1) {
+			if (!((sizes >> size) & 1))
+				continue;
+
+			RBT_TimingRow *row = &_rows[model][op][size];
+			if (cell->per_n)
+				row->per_n = (u8)cell->per_n;
+
+			for (u32 form = 0; form < _TIMING_FORM_COUNT; form += 1) {
+				for (u32 col = 0; col < _TIMING_COL_COUNT; col += 1) {
+					if (((forms >> form) & 1) && ((cols >> col) & 1))
+						row->ea[form][col] = _cell_cycles(cell, size, col);
+				}
+			}
+		}
+	}
+}
+
+static void _set_branch(
+	RBT_OpMnemonic op, u32 sizes, u32 outcomes, const RBT_Cell *cell
+) {
+	if (!cell->present)
+		return;
+
+	for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+		for (u32 size = 0; size < _TIMING_SIZE_COUNT; size += 1) {
+			if (!((_models >> model) & 1) || !((sizes >> size) & 1))
+				continue;
+
+			for (u32 outcome = 0; outcome < _TIMING_BRANCH_COUNT; outcome += 1) {
+				if ((outcomes >> outcome) & 1)
+					_rows[model][op][size].branch[outcome] = (u8)cell->base;
+			}
+		}
+	}
+}
+
+static RBT_GridKind _classify(char *const *cells, usize count, const char *heading) {
+	if (count < 2)
+		_fail("bad grid header", cells[0]);
+
+	if (strcmp(cells[0], "addressing mode") == 0)
+		return _GRID_EA;
+	if (strcmp(cells[0], "src / dst") == 0)
+		return _GRID_MOVE;
+	if (strcmp(cells[0], "exception") == 0)
+		return _GRID_EXCEPTION;
+
+	if (strcmp(cells[0], "instruction") == 0)
+		return strcmp(cells[1], "cycles") == 0 ? _GRID_MISC : _GRID_SHIFT;
+
+	if (strcmp(cells[0], "mnemonic") == 0 && strcmp(cells[1], "syntax") == 0)
+		return _GRID_OPS;
+	if (strcmp(cells[0], "mnemonic") == 0 && strcmp(cells[1], "size") == 0 && count > 2)
+		return strcmp(cells[2], "taken") == 0 ? _GRID_BRANCH : _GRID_MULTI;
+
+	_fail("unknown grid in", heading);
+}
+
+static void _parse_ea_row(char *const *cells, usize count) {
+	u32 cols = _parse_column(cells[0]);
+	if (count != 5 || !cols || cols > _COLS_EA)
+		_fail("bad effective address row", cells[0]);
+
+	u32 col = _first_col(cols);
+	for (usize i = 0; i < 4; i += 1) {
+		RBT_Cell cell = _parse_cell(cells[1 + i]);
+		_ea_time[i / 2][i % 2][col] = (u8)cell.base;
+	}
+}
+
+static void _parse_move_row(
+	char *const *cells, usize count, char *const *header, const char *heading
+) {
+	u32 sizes = strstr(heading, "long") ? _SIZE_L : _SIZE_BW;
+	u32 src = _first_col(_parse_column(cells[0]));
+	if (src >= _TIMING_MOVE_SRC_COUNT)
+		_fail("bad move source", cells[0]);
+
+	for (usize i = 1; i < count; i += 1) {
+		u32 dst = _first_col(_parse_column(header[i]));
+		if (dst >= _TIMING_MOVE_DST_COUNT)
+			_fail("bad move destination", header[i]);
+
+		RBT_Cell cell = _parse_cell(cells[i]);
+		for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+			for (u32 size = 0; size < _TIMING_SIZE_COUNT; size += 1) {
+				if (cell.present && ((_models >> model) & 1) && ((sizes >> size) & 1))
+					_move[model][size][src][dst] = (u8)cell.base;
+			}
+		}
+	}
+}
+
+static void _parse_ops_row(
+	char *const *cells, usize count, char *const *header, const char *heading
+) {
+	static char name[_LINE_MAX];
+	static u32 sizes;
+
+	// An empty mnemonic continues the previous row
+	if (*cells[0] != '\0') {
+		snprintf(name, sizeof(name), "%s", cells[0]);
+		char *dot = strchr(name, '.');
+		sizes = _parse_sizes(dot ? dot + 1 : "");
+		if (dot)
+			*dot = '\0';
+	}
+
+	// Static bit operations are kept under the source form, see timing.h
+	const char *syntax = cells[1];
+	u32 forms;
+	if (strstr(heading, "bit manipulation"))
+		forms = syntax[0] == '#' ? _FORM_SRC : _FORM_DST;
+	else if (strncmp(syntax, "<ea>,", 5) == 0)
+		forms = _FORM_SRC;
+	else if (strcmp(syntax, "<ea>") == 0)
+		forms = _FORM_BOTH; // Single operand, either operand slot may hold it
+	else
+		forms = _FORM_DST;
+
+	bool is_shift = strcmp(name, "xsx") == 0;
+	usize op_count = is_shift ? sizeof(_shift_ops) / sizeof(_shift_ops[0]) : 1;
+
+	for (usize i = 0; i < op_count; i += 1) {
+		RBT_OpMnemonic op = is_shift ? _shift_ops[i] : _parse_op(name);
+		for (usize c = 2; c < count; c += 1) {
+			RBT_Cell cell = _parse_cell(cells[c]);
+			_set_cells(op, sizes, forms, _parse_column(header[c]), &cell);
+		}
+	}
+}
+
+static void _parse_shift_row(char *const *cells, usize count, char *const *header) {
+	char names[_LINE_MAX];
+	snprintf(names, sizeof(names), "%s", cells[0]);
+
+	for (char *name = strtok(names, "/"); name; name = strtok(nullptr, "/")) {
+		RBT_OpMnemonic op = _parse_op(_trim(name));
+
+		for (usize c = 1; c < count; c += 1) {
+			char size[_LINE_MAX];
+			snprintf(size, sizeof(size), "%s", header[c]);
+			size[strcspn(size, " ")] = '\0';
+
+			RBT_Cell cell = _parse_cell(cells[c]);
+			_set_cells(op, _parse_sizes(size), _FORM_DST, _COL(_TIMING_COL_DN), &cell);
+		}
+	}
+}
+
+static void _parse_branch_row(char *const *cells, usize count) {
+	static const RBT_BranchRow *branch;
+
+	if (count != 4)
+		_fail("bad branch row", cells[0]);
+
+	if (*cells[0] != '\0') {
+		branch = nullptr;
+		for (usize i = 0; i < sizeof(_branch_rows) / sizeof(_branch_rows[0]); i += 1) {
+			if (strcmp(_branch_rows[i].name, cells[0]) == 0)
+				branch = &_branch_rows[i];
+		}
+		if (!branch)
+			_fail("unknown branch", cells[0]);
+	}
+
+	u32 sizes = _parse_sizes(cells[1]);
+	RBT_Cell taken = _parse_cell(cells[2]);
+	RBT_Cell not_taken = _parse_cell(cells[3]);
+	_set_branch(branch->op, sizes, branch->taken, &taken);
+	_set_branch(branch->op, sizes, branch->not_taken, &not_taken);
+}
+
+static void _parse_multi_row(char *const *cells, usize count) {
+	static RBT_OpMnemonic op;
+
+	if (count != 4)
+		_fail("bad multiprecision row", cells[0]);
+
+	if (*cells[0] != '\0')
+		op = _parse_op(cells[0]);
+	u32 sizes = _parse_sizes(cells[1]);
+	u32 memory = op == RBT_OP_CMPM ? _TIMING_COL_POSTINC : _TIMING_COL_PREDEC;
+
+	RBT_Cell reg = _parse_cell(cells[2]);
+	RBT_Cell mem = _parse_cell(cells[3]);
+	_set_cells(op, sizes, _FORM_SRC, _COL(_TIMING_COL_DN), &reg);
+	_set_cells(op, sizes, _FORM_SRC, _COL(memory), &mem);
+}
+
+static void _parse_named_row(
+	char *const *cells, usize count, const RBT_NamedRow *rows, usize row_count,
+	bool required
+) {
+	if (count != 2)
+		_fail("bad row", cells[0]);
+
+	bool found = false;
+	RBT_Cell cell = _parse_cell(cells[1]);
+
+	for (usize i = 0; i < row_count; i += 1) {
+		const RBT_NamedRow *row = &rows[i];
+		if (strcmp(row->text, cells[0]) != 0)
+			continue;
+
+		_set_cells(row->op, row->sizes, row->forms, row->cols, &cell);
+		found = true;
+	}
+
+	if (required && !found)
+		_fail("unknown instruction", cells[0]);
+}
+
+// The EA part of "44 + ea" is left out, it's charged by the instruction
+static void _parse_exception_row(char *const *cells, usize count) {
+	_parse_named_row(
+		cells, count, _exception_rows,
+		sizeof(_exception_rows) / sizeof(_exception_rows[0]), false
+	);
+
+	RBT_Cell cell = _parse_cell(cells[1]);
+	for (u32 kind = 0; kind < _TIMING_EXC_COUNT; kind += 1) {
+		if (!cell.present || strcmp(_exception_names[kind], cells[0]) != 0)
+			continue;
+
+		for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+			if ((_models >> model) & 1)
+				_exceptions[model][kind] = (u8)cell.base;
+		}
+	}
+}
+
+static void _parse(FILE *in) {
+	char line[_LINE_MAX];
+	char header_line[_LINE_MAX];
+	char heading[_LINE_MAX] = "";
+	char *header[_CELL_MAX];
+	usize header_count = 0;
+	RBT_GridKind kind = _GRID_NONE;
+
+	while (fgets(line, sizeof(line), in)) {
+		_line_no += 1;
+		line[strcspn(line, "\r\n")] = '\0';
+
+		if (strncmp(line, "table ", 6) == 0)
+			snprintf(heading, sizeof(heading), "%s", line);
+		if (strcmp(line, "mc68000 differences") == 0)
+			_models = _MODEL_M68000;
+
+		if (line[0] == '+')
+			continue; // Borders don't end a grid
+
+		if (line[0] != '|') {
+			kind = _GRID_NONE;
+			continue;
+		}
+
+		if (kind == _GRID_NONE) {
+			memcpy(header_line, line, sizeof(line));
+			header_count = _split(header_line, header);
+			kind = _classify(header, header_count, heading);
+			continue;
+		}
+
+		char *cells[_CELL_MAX];
+		usize count = _split(line, cells);
+		if (count != header_count)
+			_fail("cell count differs from the header in", heading);
+
+		switch (kind) {
+		case _GRID_EA:
+			_parse_ea_row(cells, count);
+			break;
+		case _GRID_MOVE:
+			_parse_move_row(cells, count, header, heading);
+			break;
+		case _GRID_OPS:
+			_parse_ops_row(cells, count, header, heading);
+			break;
+		case _GRID_SHIFT:
+			_parse_shift_row(cells, count, header);
+			break;
+		case _GRID_BRANCH:
+			_parse_branch_row(cells, count);
+			break;
+		case _GRID_MULTI:
+			_parse_multi_row(cells, count);
+			break;
+		case _GRID_MISC:
+			_parse_named_row(
+				cells, count, _misc_rows, sizeof(_misc_rows) / sizeof(_misc_rows[0]), true
+			);
+			break;
+		case _GRID_EXCEPTION:
+			_parse_exception_row(cells, count);
+			break;
+		case _GRID_NONE:
+			unreachable();
+		}
+	}
+}
+
+// Every mnemonic needs a time on both models. MOVEA is timed by the an
+// column of the move grids.
+[[nodiscard]] static bool _check(void) {
+	bool ok = true;
+
+	for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+		for (u32 op = 0; op < _TIMING_OP_COUNT; op += 1) {
+			if (!_names[op] || op == RBT_OP_MOVEA)
+				continue;
+
+			const u8 *bytes = (const u8 *)_rows[model][op];
+			bool any = false;
+			for (usize i = 0; i < sizeof(_rows[model][op]); i += 1) {
+				any |= bytes[i] != 0;
+			}
+
+			if (!any) {
+				fprintf(stderr, "no timing for %s on model %u\n", _names[op], model);
+				ok = false;
+			}
+		}
+
+		for (u32 kind = 0; kind < _TIMING_EXC_COUNT; kind += 1) {
+			if (!_exceptions[model][kind]) {
+				const char *name = _exception_names[kind];
+				fprintf(stderr, "no timing for %s on model %u\n", name, model);
+				ok = false;
+			}
+		}
+	}
+
+	return ok;
+}
+
+static void _write_row(FILE *out, const RBT_TimingRow *row) {
+	fprintf(out, "{{");
+	for (u32 form = 0; form < _TIMING_FORM_COUNT; form += 1) {
+		fprintf(out, "%s{", form ? "," : "");
+		for (u32 col = 0; col < _TIMING_COL_COUNT; col += 1) {
+			fprintf(out, "%s%u", col ? "," : "", row->ea[form][col]);
+		}
+		fputc('}', out);
+	}
+	fprintf(out, "},%u,{", row->per_n);
+	for (u32 outcome = 0; outcome < _TIMING_BRANCH_COUNT; outcome += 1) {
+		fprintf(out, "%s%u", outcome ? "," : "", row->branch[outcome]);
+	}
+	fprintf(out, "}}");
+}
+
+static void _write(FILE *out) {
+	static const char *const models[_TIMING_MODEL_COUNT] = { "MC68000", "MC68010" };
+
+	fprintf(out, "// Generated by tools/gen_timing.c - DO NOT EDIT.\n");
+	fprintf(out, "// clang-format off\n");
+	fprintf(out, "static const RBT_TimingRow _timing_rows");
+	fprintf(out, "[_TIMING_MODEL_COUNT][_TIMING_OP_COUNT][_TIMING_SIZE_COUNT] = {\n");
+
+	for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+		fprintf(out, "\t{ // %s\n", models[model]);
+		for (u32 op = 0; op < _TIMING_OP_COUNT; op += 1) {
+			fprintf(out, "\t\t{ // %s\n", _names[op] ? _names[op] : "-");
+			for (u32 size = 0; size < _TIMING_SIZE_COUNT; size += 1) {
+				fprintf(out, "\t\t\t");
+				_write_row(out, &_rows[model][op][size]);
+				fprintf(out, ",\n");
+			}
+			fprintf(out, "\t\t},\n");
+		}
+		fprintf(out, "\t},\n");
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "static const u8 _timing_move[_TIMING_MODEL_COUNT][_TIMING_SIZE_COUNT]");
+	fprintf(out, "[_TIMING_MOVE_SRC_COUNT][_TIMING_MOVE_DST_COUNT] = {\n");
+	for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+		fprintf(out, "\t{ // %s\n", models[model]);
+		for (u32 size = 0; size < _TIMING_SIZE_COUNT; size += 1) {
+			fprintf(out, "\t\t{\n");
+			for (u32 src = 0; src < _TIMING_MOVE_SRC_COUNT; src += 1) {
+				fprintf(out, "\t\t\t{");
+				for (u32 dst = 0; dst < _TIMING_MOVE_DST_COUNT; dst += 1) {
+					fprintf(out, "%s%u", dst ? "," : "", _move[model][size][src][dst]);
+				}
+				fprintf(out, "},\n");
+			}
+			fprintf(out, "\t\t},\n");
+		}
+		fprintf(out, "\t},\n");
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "static const u8 _timing_exceptions");
+	fprintf(out, "[_TIMING_MODEL_COUNT][_TIMING_EXC_COUNT] = {\n");
+	for (u32 model = 0; model < _TIMING_MODEL_COUNT; model += 1) {
+		fprintf(out, "\t{");
+		for (u32 kind = 0; kind < _TIMING_EXC_COUNT; kind += 1) {
+			fprintf(out, "%s%u", kind ? "," : "", _exceptions[model][kind]);
+		}
+		fprintf(out, "}, // %s\n", models[model]);
+	}
+	fprintf(out, "};\n");
+	fprintf(out, "// clang-format on\n");
+}
+
+int main(int argc, char **argv) {
+	if (argc != 3) {
+		fprintf(stderr, "usage: %s <m68010_cycles.txt> <output.inc>\n", argv[0]);
+		return 1;
+	}
+
+	_path = argv[1];
+	FILE *in = fopen(_path, "r");
+	if (!in) {
+		fprintf(stderr, "failed to open %s\n", _path);
+		return 1;
+	}
+	_parse(in);
+	fclose(in);
+
+	if (!_check())
+		return 1;
+
+	FILE *out = fopen(argv[2], "w");
+	if (!out) {
+		fprintf(stderr, "failed to open %s\n", argv[2]);
+		return 1;
+	}
+
+	_write(out);
+
+	bool failed = ferror(out) != 0;
+	failed |= fclose(out) != 0;
+	if (failed) {
+		fprintf(stderr, "failed to write %s\n", argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
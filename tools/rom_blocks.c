@@ -0,0 +1,244 @@
+// RBT-16 - Fantasy Retro-Computer Inspired by the Amiga 500 and Atari ST.
+// Copyright (C) 2026  aCube
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, see
+// <https://www.gnu.org/licenses/>.
+
+// Lists the basic blocks of a ROM image for rbt_cpu_preload_blocks().
+//
+// Code is followed from every exception vector of the table at the start of
+// the ROM, and from the extra entry points given, through branches, calls and
+// jumps whose target is known from the instruction alone. Jumps through
+// registers, such as jump tables, can't be followed; their targets are left to
+// the interpreter, which records them the first time they run. The output is
+// a C source defining `<symbol>` and `<symbol>_count`.
+//
+// Usage: rbt-rom-blocks <rom> <output.c> <symbol> [entry...]
+
+#include "cpu/bus_internal.h"
+#include "cpu/cpu_internal.h"
+#include "cpu/decode.h"
+#include "rbt/basic_types.h"
+#include "rbt/cpu/bus.h"
+#include "rbt/cpu/types.h"
+#include "rbt/error_codes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+	_VECTOR_COUNT = 256,
+	_ROM_WORDS = _BUS_ROM_SIZE / 2,
+
+	// Per ROM word
+	_WORD_BLOCK = 1 << 0,   // A block starts here
+	_WORD_BROKEN = 1 << 1,  // Its code doesn't decode, it's left out
+	_WORD_STEPPED = 1 << 2, // It starts on a page-crossing instruction, left out
+};
+
+static u8 _words[_ROM_WORDS];
+static u32 _queue[_ROM_WORDS]; // Blocks to walk, each one queued once
+static usize _queue_len;
+static usize _unresolved; // Jumps whose target depends on registers
+
+static bool _in_rom(u32 addr) {
+	return addr >= _BUS_ROM_ADDR && addr < _BUS_ROM_ADDR + _BUS_ROM_SIZE && !(addr & 1);
+}
+
+// Whether the block starting at this ROM word goes into the table
+static bool _is_listed(u8 word) {
+	return (word & (_WORD_BLOCK | _WORD_BROKEN | _WORD_STEPPED)) == _WORD_BLOCK;
+}
+
+static void _add_block(u32 pc) {
+	pc &= 0xff'ffff;
+	if (!_in_rom(pc))
+		return;
+
+	u8 *word = &_words[(pc - _BUS_ROM_ADDR) / 2];
+	if (*word & _WORD_BLOCK)
+		return;
+	*word |= _WORD_BLOCK;
+	_queue[_queue_len] = pc;
+	_queue_len += 1;
+}
+
+// Target of a JMP/JSR operand, when it doesn't depend on registers
+static bool _jump_target(const RBT_EffectiveAddress *ea, u32 *out) {
+	switch (ea->mode) {
+	case RBT_EA_ABSOLUTE_SHORT:	 *out = ea->absolute_short; return true;
+	case RBT_EA_ABSOLUTE_LONG:	 *out = ea->absolute_long; return true;
+	case RBT_EA_PC_DISPLACEMENT: *out = ea->start_pc + (u32)ea->pc_disp; return true;
+	default:					 return false;
+	}
+}
+
+// Follows the straight line from `start` as far as one block goes, the same way
+// the CPU splits them, and queues the blocks it leads to
+static void _walk_block(RBT_MemoryBus *bus, u32 start) {
+	u32 pc = start;
+	for (u32 count = 0; count < _CPU_BLOCK_MAX_INSTRS; count += 1) {
+		RBT_Instruction instr;
+		if (_decode_instruction(bus, pc, &instr)) {
+			_words[(start - _BUS_ROM_ADDR) / 2] |= _WORD_BROKEN;
+			return;
+		}
+
+		// Instructions crossing a code page end a block before them. Ending up
+		// there, the CPU steps them and starts its next block right after them.
+		u32 next = pc + instr.len;
+		bool crosses = (pc ^ (next - 1)) >> _BUS_CODE_PAGE_SHIFT;
+		if (crosses && pc != start) {
+			_add_block(pc);
+			return;
+		}
+		if (crosses)
+			_words[(start - _BUS_ROM_ADDR) / 2] |= _WORD_STEPPED;
+
+		u32 target = 0;
+		switch (instr.mnemonic) {
+		case RBT_OP_Bcc:
+		case RBT_OP_DBcc:
+		case RBT_OP_BSR:
+			_add_block(pc + 2 + (u32)instr.dst.disp);
+			_add_block(next);
+			return;
+		case RBT_OP_BRA: _add_block(pc + 2 + (u32)instr.dst.disp); return;
+		case RBT_OP_JMP:
+		case RBT_OP_JSR:
+			if (_jump_target(&instr.dst, &target))
+				_add_block(target);
+			else
+				_unresolved += 1;
+			if (instr.mnemonic == RBT_OP_JSR)
+				_add_block(next);
+			return;
+		case RBT_OP_TRAP:
+		case RBT_OP_TRAPV:
+		case RBT_OP_RESET:
+		case RBT_OP_STOP: _add_block(next); return;
+		case RBT_OP_BKPT:
+		case RBT_OP_RTD:
+		case RBT_OP_RTE:
+		case RBT_OP_RTR:
+		case RBT_OP_RTS:
+		case RBT_OP_ILLEGAL:
+		case RBT_OP_LINEA:
+		case RBT_OP_LINEF: return;
+		default:		   break;
+		}
+
+		// Writes to SR end a block, a stepped instruction leads to the one after it
+		if (instr.dst.mode == RBT_EA_REGISTER_SR || crosses) {
+			_add_block(next);
+			return;
+		}
+		pc = next;
+	}
+	_add_block(pc);
+}
+
+static void _write(FILE *out, const char *rom, const char *symbol, usize count) {
+	fprintf(out, "// Generated by rbt-rom-blocks from %s - DO NOT EDIT.\n", rom);
+	fprintf(
+		out, "// %zu basic blocks, %zu jumps left to the interpreter.\n", count,
+		_unresolved
+	);
+	fprintf(out, "\n#include \"rbt/basic_types.h\"\n\n");
+	fprintf(out, "extern const u32 %s[];\n", symbol);
+	fprintf(out, "extern const usize %s_count;\n\n", symbol);
+	fprintf(out, "// clang-format off\n");
+	fprintf(out, "const u32 %s[] = {", symbol);
+
+	usize written = 0;
+	for (u32 i = 0; i < _ROM_WORDS; i += 1) {
+		if (!_is_listed(_words[i]))
+			continue;
+		fprintf(out, (written % 8) ? " " : "\n\t");
+		fprintf(out, "0x%06x,", _BUS_ROM_ADDR + (i * 2));
+		written += 1;
+	}
+
+	fprintf(out, "\n};\n");
+	fprintf(out, "// clang-format on\n");
+	fprintf(
+		out, "const usize %s_count = sizeof(%s) / sizeof(%s[0]);\n", symbol, symbol,
+		symbol
+	);
+}
+
+int main(int argc, char **argv) {
+	if (argc < 4) {
+		fprintf(stderr, "usage: %s <rom> <output.c> <symbol> [entry...]\n", argv[0]);
+		return 1;
+	}
+
+	RBT_BusConfig cfg = {
+		.ram_slots = { RBT_RAM_256KB, RBT_RAM_NONE, RBT_RAM_NONE, RBT_RAM_NONE },
+	};
+	RBT_MemoryBus *bus = rbt_create_bus(&cfg);
+	if (!bus) {
+		rbt_err_flush();
+		return 1;
+	}
+	if (rbt_bus_init_from_file(bus, argv[1])) {
+		rbt_err_flush();
+		rbt_destroy_bus(bus);
+		return 1;
+	}
+
+	// The initial SSP isn't code, every other vector may point into the ROM
+	for (u32 vec = _VEC_INITIAL_PC; vec < _VECTOR_COUNT; vec += 1) {
+		u32 addr = 0;
+		if (!rbt_bus_read_long(bus, _BUS_ROM_ADDR + (vec * 4), &addr))
+			_add_block(addr);
+	}
+	for (int i = 4; i < argc; i += 1) {
+		_add_block((u32)strtoul(argv[i], nullptr, 0));
+	}
+
+	// Data words decoded as code are expected here, don't report them
+	rbt_set_err_min_severity(RBT_SEVERITY_FATAL);
+	for (usize i = 0; i < _queue_len; i += 1) {
+		_walk_block(bus, _queue[i]);
+	}
+	rbt_destroy_bus(bus);
+
+	usize count = 0;
+	for (u32 i = 0; i < _ROM_WORDS; i += 1) {
+		count += _is_listed(_words[i]);
+	}
+	if (count == 0) {
+		fprintf(stderr, "no code found in %s\n", argv[1]);
+		return 1;
+	}
+
+	FILE *out = fopen(argv[2], "w");
+	if (!out) {
+		fprintf(stderr, "failed to open %s\n", argv[2]);
+		return 1;
+	}
+
+	_write(out, argv[1], argv[3], count);
+
+	bool failed = ferror(out) != 0;
+	failed |= fclose(out) != 0;
+	if (failed) {
+		fprintf(stderr, "failed to write %s\n", argv[2]);
+		return 1;
+	}
+
+	printf("rom blocks: %zu blocks, %zu unresolved jumps\n", count, _unresolved);
+	return 0;
+}